@@ -0,0 +1,62 @@
+#include "batchjob.h"
+#include "analysisreport.h"
+#include "resultexport.h"
+#include "spectrogramcache.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+qint64 BatchJob::estimateMemory(const QString &path)
+{
+    return QFileInfo(path).size() * decodeExpansion + fixedOverhead;
+}
+
+bool BatchJob::run(const BatchInput &input, const BatchOptions &options, QString &errorString)
+{
+    AnalysisReport report;
+    if (!report.analyze(input.path, errorString))
+        return false;
+    const QVector<double> &samples = report.samples();
+
+    const QString basePath = QDir(options.outputDir).filePath(input.outputName);
+    if (!QDir().mkpath(QFileInfo(basePath).absolutePath())) {
+        errorString = tr("Не удалось создать каталог для %1").arg(basePath);
+        return false;
+    }
+
+    QJsonObject root = report.toJson();
+
+    if (options.spectrogram) {
+        const QString spectrogramPath = basePath + ".spectrogram." + options.spectrogramSuffix;
+        if (!ResultExport::writeSpectrogram(spectrogramPath, samples, options.spectrogramHop, errorString))
+            return false;
+        root["spectrogram"] = QJsonObject{
+            {"file", QFileInfo(spectrogramPath).fileName()},
+            {"fftSize", SpectrogramCache::fftSize},
+            {"hop", options.spectrogramHop},
+            {"frames", SpectrogramCache::frameCountFor(samples.size(), options.spectrogramHop)},
+            {"bins", SpectrogramCache::binCount},
+        };
+    }
+
+    if (options.featureSeries) {
+        const QString seriesPath = basePath + ".features.csv";
+        if (!ResultExport::writeFeatureSeries(seriesPath, samples, report.sampleRate(), errorString))
+            return false;
+        root["featureSeries"] = QFileInfo(seriesPath).fileName();
+    }
+
+    QSaveFile json(basePath + ".json");
+    if (!json.open(QIODevice::WriteOnly)) {
+        errorString = tr("Не удалось создать %1").arg(json.fileName());
+        return false;
+    }
+    json.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    if (!json.commit()) {
+        errorString = tr("Ошибка записи %1").arg(json.fileName());
+        return false;
+    }
+    return true;
+}
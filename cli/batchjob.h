@@ -0,0 +1,48 @@
+#pragma once
+#ifndef BATCHJOB_H
+#define BATCHJOB_H
+
+#include <QCoreApplication>
+#include <QString>
+
+// Параметры пакетной обработки
+struct BatchOptions
+{
+    QString outputDir;
+    int jobs = 1;
+    qint64 memoryLimit = 0; // Байт на все задания сразу
+    bool spectrogram = true;
+    int spectrogramHop = 256;
+    QString spectrogramSuffix = "npy"; // npy или f32
+    bool featureSeries = false;        // Покадровые признаки в <имя>.features.csv
+};
+
+// Входной файл и имя результата относительно каталога вывода (без расширения)
+struct BatchInput
+{
+    QString path;
+    QString outputName;
+};
+
+// Обработка одного файла: чтение, метаданные, спектр, признаки и
+// спектрограмма. Результат - <outputName>.json и, по параметрам,
+// <outputName>.spectrogram.npy|f32 и <outputName>.features.csv (ResultExport).
+// Выполняется в рабочем потоке, общих данных с другими заданиями нет.
+class BatchJob
+{
+    Q_DECLARE_TR_FUNCTIONS(BatchJob)
+
+public:
+    // Оценка пиковой памяти задания по размеру файла
+    static qint64 estimateMemory(const QString &path);
+
+    static bool run(const BatchInput &input, const BatchOptions &options, QString &errorString);
+
+private:
+    // Декодированные сэмплы double на байт файла в худшем случае
+    // (8 бит стерео: смесь, каналы и исходные данные одновременно)
+    static constexpr int decodeExpansion = 14;
+    static constexpr qint64 fixedOverhead = 4 * 1024 * 1024;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include "batchrunner.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QSet>
+#include <QThreadPool>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+void MemoryBudget::acquire(qint64 bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    while (m_used > 0 && m_used + bytes > m_limit)
+        m_released.wait(&m_mutex);
+    m_used += bytes;
+}
+
+void MemoryBudget::release(qint64 bytes)
+{
+    QMutexLocker lock(&m_mutex);
+    m_used -= bytes;
+    m_released.wakeAll();
+}
+
+BatchRunner::BatchRunner(const BatchOptions &options)
+    : m_options(options)
+    , m_budget(options.memoryLimit)
+{}
+
+QVector<BatchInput> BatchRunner::collectInputs(const QStringList &arguments, QStringList &missing)
+{
+    const QStringList wavFilters = {"*.wav", "*.WAV"};
+    QVector<BatchInput> inputs;
+    QSet<QString> seen;
+    QSet<QString> outputNames; // В нижнем регистре: ФС может не различать регистр
+
+    // Одинаковые имена результатов (take.wav из разных каталогов) получают
+    // суффикс _2, _3, ..., иначе параллельные задания пишут в один файл
+    auto add = [&](const QString &path, const QString &outputName) {
+        const QString canonical = QFileInfo(path).canonicalFilePath();
+        if (canonical.isEmpty() || seen.contains(canonical))
+            return;
+        seen.insert(canonical);
+        QString name = outputName;
+        for (int n = 2; outputNames.contains(name.toLower()); ++n)
+            name = outputName + '_' + QString::number(n);
+        outputNames.insert(name.toLower());
+        inputs.append({path, name});
+    };
+    auto stripSuffix = [](const QString &name) {
+        const int dot = name.lastIndexOf('.');
+        return dot > 0 && name.indexOf('/', dot) < 0 ? name.left(dot) : name;
+    };
+
+    for (const QString &argument : arguments) {
+        const QFileInfo info(argument);
+        if (info.isDir()) {
+            const QDir root(argument);
+            QStringList files;
+            QDirIterator it(argument, wavFilters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                files.append(it.next());
+            files.sort(); // Порядок обработки не зависит от файловой системы
+            for (const QString &file : std::as_const(files))
+                add(file, stripSuffix(root.relativeFilePath(file)));
+        } else if (info.isFile()) {
+            add(argument, info.completeBaseName());
+        } else if (argument.contains(QRegularExpression("[*?\\[]"))) {
+            const QDir dir(info.path());
+            const QStringList files = dir.entryList({info.fileName()}, QDir::Files, QDir::Name);
+            if (files.isEmpty())
+                missing.append(argument);
+            for (const QString &file : files)
+                add(dir.filePath(file), QFileInfo(file).completeBaseName());
+        } else {
+            missing.append(argument);
+        }
+    }
+    return inputs;
+}
+
+int BatchRunner::run(const QVector<BatchInput> &inputs, bool verbose)
+{
+    QThreadPool pool;
+    pool.setMaxThreadCount(m_options.jobs);
+    QSemaphore queueSlots(m_options.jobs * 2);
+
+    std::atomic<int> done{0};
+    std::atomic<int> failed{0};
+    const int total = inputs.size();
+    QElapsedTimer clock;
+    clock.start();
+
+    for (const BatchInput &input : inputs) {
+        const qint64 cost = qMin(BatchJob::estimateMemory(input.path), m_options.memoryLimit);
+        queueSlots.acquire();
+        m_budget.acquire(cost);
+
+        pool.start([this, input, cost, total, verbose, &done, &failed, &queueSlots]() {
+            QElapsedTimer jobClock;
+            jobClock.start();
+            QString error;
+            const bool ok = BatchJob::run(input, m_options, error);
+            m_budget.release(cost);
+            queueSlots.release();
+
+            const int index = ++done;
+            if (!ok)
+                ++failed;
+            if (verbose || !ok) {
+                QMutexLocker lock(&m_reportMutex);
+                const QString line = ok ? tr("[%1/%2] %3: %4 мс")
+                                              .arg(index)
+                                              .arg(total)
+                                              .arg(input.path)
+                                              .arg(jobClock.elapsed())
+                                        : tr("[%1/%2] %3: ошибка: %4")
+                                              .arg(index)
+                                              .arg(total)
+                                              .arg(input.path, error);
+                std::fprintf(stderr, "%s\n", qPrintable(line));
+            }
+        });
+    }
+    pool.waitForDone();
+
+    const double seconds = qMax<qint64>(1, clock.elapsed()) / 1000.0;
+    std::fprintf(stderr,
+                 "%s\n",
+                 qPrintable(tr("Готово: %1 файлов, ошибок %2, %3 с (%4 файлов/с)")
+                                .arg(total)
+                                .arg(failed.load())
+                                .arg(seconds, 0, 'f', 1)
+                                .arg(total / seconds, 0, 'f', 1)));
+    return failed.load();
+}
+
+int BatchRunner::runPipeline(const QVector<BatchInput> &inputs,
+                             const AnalysisPipeline::Config &config,
+                             bool verbose)
+{
+    QVector<AnalysisPipeline::Job> jobs;
+    jobs.reserve(inputs.size());
+    for (const BatchInput &input : inputs)
+        jobs.append({input.path,
+                     QDir(m_options.outputDir).filePath(input.outputName + ".spectrogram.npy")});
+
+    std::atomic<int> done{0};
+    const int total = jobs.size();
+    auto onFile = [&](const AnalysisPipeline::Job &job, bool ok, const QString &error) {
+        const int index = ++done;
+        if (!verbose && ok)
+            return;
+        QMutexLocker lock(&m_reportMutex);
+        const QString line = ok ? tr("[%1/%2] %3").arg(index).arg(total).arg(job.input)
+                                : tr("[%1/%2] %3: ошибка: %4").arg(index).arg(total).arg(job.input, error);
+        std::fprintf(stderr, "%s\n", qPrintable(line));
+    };
+    auto onStats = [&](const AnalysisPipeline::Stats &stats) {
+        if (!verbose)
+            return;
+        QMutexLocker lock(&m_reportMutex);
+        std::fprintf(stderr, "%s\n", qPrintable(AnalysisPipeline::formatStats(stats)));
+    };
+
+    AnalysisPipeline pipeline(config);
+    const AnalysisPipeline::Stats stats = pipeline.run(jobs, onFile, onStats);
+    std::fprintf(stderr, "%s\n", qPrintable(AnalysisPipeline::formatStats(stats)));
+    return stats.filesFailed;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "analysispipeline.h"
+#include "batchjob.h"
+#include <QCoreApplication>
+#include <QMutex>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+
+// Бюджет памяти на все задания: захват блокируется, пока сумма оценок
+// выполняющихся заданий с новой не уложится в предел. Задание больше
+// предела всё равно выполняется, но только в одиночку.
+class MemoryBudget
+{
+public:
+    explicit MemoryBudget(qint64 limit)
+        : m_limit(limit)
+    {}
+
+    void acquire(qint64 bytes);
+    void release(qint64 bytes);
+
+private:
+    const qint64 m_limit;
+    qint64 m_used = 0;
+    QMutex m_mutex;
+    QWaitCondition m_released;
+};
+
+// Пакетная обработка: файлы раздаются пулу из options.jobs потоков.
+// Очередь ограничена (не больше 2 * jobs ожидающих заданий) и бюджетом
+// памяти, так что десятки тысяч файлов не загружаются в память разом.
+class BatchRunner
+{
+    Q_DECLARE_TR_FUNCTIONS(BatchRunner)
+
+public:
+    explicit BatchRunner(const BatchOptions &options);
+
+    // Файлы, каталоги (рекурсивно, *.wav) и шаблоны имён (*.wav, take?.wav).
+    // Имена результатов повторяют структуру каталогов, совпадающие имена
+    // дополняются суффиксом _2, _3, ...; несуществующие аргументы попадают
+    // в missing.
+    static QVector<BatchInput> collectInputs(const QStringList &arguments, QStringList &missing);
+
+    // Возвращает число файлов, обработанных с ошибкой
+    int run(const QVector<BatchInput> &inputs, bool verbose);
+
+    // Только спектрограммы (<имя>.spectrogram.npy) через поэтапный конвейер
+    // с отдельными потоками на чтение, декодирование, анализ и запись;
+    // статистика стадий печатается раз в секунду и в конце
+    int runPipeline(const QVector<BatchInput> &inputs,
+                    const AnalysisPipeline::Config &config,
+                    bool verbose);
+
+private:
+    BatchOptions m_options;
+    MemoryBudget m_budget;
+    QMutex m_reportMutex;
+};
+
+#endif
@@ -0,0 +1,143 @@
+// Пакетный анализ WAV без интерфейса: audioanalyzer_batch [параметры] файлы|каталоги|шаблоны
+#include "batchrunner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QThread>
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("audioanalyzer_batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QCoreApplication::translate("main",
+                                    "Пакетный анализ WAV: метаданные, спектр, признаки и спектрограмма"));
+    parser.addHelpOption();
+    parser.addPositionalArgument("inputs",
+                                 QCoreApplication::translate("main", "Файлы, каталоги или шаблоны имён"),
+                                 "inputs...");
+
+    const QCommandLineOption outputOption({"o", "output"},
+                                          QCoreApplication::translate("main", "Каталог результатов"),
+                                          "dir",
+                                          "analysis");
+    const QCommandLineOption jobsOption({"j", "jobs"},
+                                        QCoreApplication::translate("main", "Число параллельных заданий"),
+                                        "n",
+                                        QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption memoryOption({"m", "memory-mb"},
+                                          QCoreApplication::translate("main",
+                                                                      "Предел памяти на все задания, МБ"),
+                                          "mb",
+                                          "4096");
+    const QCommandLineOption hopOption("hop",
+                                       QCoreApplication::translate("main", "Шаг кадров спектрограммы, сэмплов"),
+                                       "samples",
+                                       "256");
+    const QCommandLineOption formatOption("spectrogram-format",
+                                          QCoreApplication::translate("main",
+                                                                      "Формат спектрограммы: npy или f32"),
+                                          "format",
+                                          "npy");
+    const QCommandLineOption seriesOption("feature-series",
+                                          QCoreApplication::translate("main",
+                                                                      "Сохранять покадровые признаки (CSV)"));
+    const QCommandLineOption pipelineOption(
+        "pipeline",
+        QCoreApplication::translate("main",
+                                    "Только спектрограммы через поэтапный конвейер; потоки стадий "
+                                    "чтение,декодирование,анализ,запись"),
+        "r,d,a,w");
+    const QCommandLineOption queueOption("queue-depth",
+                                         QCoreApplication::translate("main",
+                                                                     "Ёмкость очередей конвейера, блоков"),
+                                         "n",
+                                         "16");
+    const QCommandLineOption noSpectrogramOption("no-spectrogram",
+                                                 QCoreApplication::translate("main",
+                                                                             "Не сохранять спектрограмму"));
+    const QCommandLineOption quietOption({"q", "quiet"},
+                                         QCoreApplication::translate("main",
+                                                                     "Сообщать только об ошибках и итоге"));
+    parser.addOptions({outputOption,
+                       jobsOption,
+                       memoryOption,
+                       hopOption,
+                       formatOption,
+                       seriesOption,
+                       pipelineOption,
+                       queueOption,
+                       noSpectrogramOption,
+                       quietOption});
+    parser.process(app);
+
+    bool jobsOk = false, memoryOk = false, hopOk = false;
+    BatchOptions options;
+    options.outputDir = parser.value(outputOption);
+    options.jobs = parser.value(jobsOption).toInt(&jobsOk);
+    options.memoryLimit = parser.value(memoryOption).toLongLong(&memoryOk) * 1024 * 1024;
+    options.spectrogramHop = parser.value(hopOption).toInt(&hopOk);
+    options.spectrogram = !parser.isSet(noSpectrogramOption);
+    options.spectrogramSuffix = parser.value(formatOption).toLower();
+    options.featureSeries = parser.isSet(seriesOption);
+    if (!jobsOk || options.jobs < 1 || !memoryOk || options.memoryLimit <= 0 || !hopOk
+        || options.spectrogramHop < 1
+        || (options.spectrogramSuffix != "npy" && options.spectrogramSuffix != "f32")) {
+        std::fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Некорректные параметры")));
+        parser.showHelp(2);
+    }
+
+    QStringList missing;
+    const QVector<BatchInput> inputs = BatchRunner::collectInputs(parser.positionalArguments(), missing);
+    for (const QString &path : std::as_const(missing))
+        std::fprintf(stderr,
+                     "%s\n",
+                     qPrintable(QCoreApplication::translate("main", "Не найдено: %1").arg(path)));
+    if (inputs.isEmpty()) {
+        std::fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Нет файлов для анализа")));
+        return 2;
+    }
+
+    // Потоки стадий конвейера задаются явно: узкое место зависит от носителя
+    AnalysisPipeline::Config pipelineConfig;
+    bool pipelineOk = true;
+    if (parser.isSet(pipelineOption)) {
+        const QStringList counts = parser.value(pipelineOption).split(',');
+        int *targets[] = {&pipelineConfig.readThreads,
+                          &pipelineConfig.decodeThreads,
+                          &pipelineConfig.analyzeThreads,
+                          &pipelineConfig.writeThreads};
+        pipelineOk = counts.size() == 4;
+        for (int i = 0; pipelineOk && i < 4; ++i)
+            *targets[i] = counts[i].toInt(&pipelineOk);
+        bool queueOk = false;
+        pipelineConfig.queueCapacity = parser.value(queueOption).toInt(&queueOk);
+        pipelineConfig.hop = options.spectrogramHop;
+        pipelineOk = pipelineOk && queueOk && pipelineConfig.queueCapacity > 0
+                     && pipelineConfig.readThreads > 0
+                     && pipelineConfig.decodeThreads > 0 && pipelineConfig.analyzeThreads > 0
+                     && pipelineConfig.writeThreads > 0;
+    }
+    if (!pipelineOk) {
+        std::fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Некорректные параметры")));
+        parser.showHelp(2);
+    }
+
+    if (!QDir().mkpath(options.outputDir)) {
+        std::fprintf(stderr,
+                     "%s\n",
+                     qPrintable(QCoreApplication::translate("main", "Не удалось создать каталог %1")
+                                    .arg(options.outputDir)));
+        return 2;
+    }
+
+    BatchRunner runner(options);
+    const bool verbose = !parser.isSet(quietOption);
+    const int failed = parser.isSet(pipelineOption) ? runner.runPipeline(inputs, pipelineConfig, verbose)
+                                                    : runner.run(inputs, verbose);
+    return failed > 0 || !missing.isEmpty() ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+#include "analysisserver.h"
+#include "analysisreport.h"
+#include "resultcache.h"
+#include <QJsonDocument>
+#include <QLocalSocket>
+
+AnalysisServer::AnalysisServer(ResultCache *cache, int jobs, QObject *parent)
+    : QObject(parent)
+    , m_cache(cache)
+{
+    m_pool.setMaxThreadCount(jobs);
+    connect(&m_server, &QLocalServer::newConnection, this, &AnalysisServer::onNewConnection);
+}
+
+AnalysisServer::~AnalysisServer()
+{
+    // Задачи пула обращаются к кэшу; отложенные ответы после удаления
+    // сервера не доставляются (контекст вызова - сам сервер)
+    m_pool.waitForDone();
+}
+
+bool AnalysisServer::listen(const QString &name, QString &errorString)
+{
+    // Имя занято работающим экземпляром - не перехватываем его
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(probeTimeoutMs)) {
+        errorString = tr("Сервер %1 уже запущен").arg(name);
+        return false;
+    }
+    // Сокет, оставшийся от аварийно завершённого экземпляра
+    QLocalServer::removeServer(name);
+    m_server.setSocketOptions(QLocalServer::UserAccessOption);
+    if (!m_server.listen(name)) {
+        errorString = m_server.errorString();
+        return false;
+    }
+    return true;
+}
+
+void AnalysisServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &AnalysisServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    }
+}
+
+void AnalysisServer::onReadyRead()
+{
+    auto *socket = qobject_cast<QLocalSocket *>(sender());
+    if (!socket)
+        return;
+
+    while (socket->canReadLine())
+        handleRequest(socket, socket->readLine().trimmed());
+
+    if (socket->bytesAvailable() > maxRequestBytes) {
+        replyError(socket, QJsonValue(), tr("Слишком длинный запрос"));
+        socket->disconnectFromServer();
+    }
+}
+
+void AnalysisServer::handleRequest(QLocalSocket *socket, const QByteArray &line)
+{
+    if (line.isEmpty())
+        return;
+    ++m_requests;
+
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (!document.isObject()) {
+        replyError(socket, QJsonValue(), tr("Некорректный JSON: %1").arg(parseError.errorString()));
+        return;
+    }
+
+    const QJsonObject request = document.object();
+    const QJsonValue id = request.value("id");
+    const QString method = request.value("method").toString();
+
+    if (method == "ping") {
+        send(socket, {{"id", id}, {"ok", true}});
+    } else if (method == "stats") {
+        const ResultCache::Stats stats = m_cache->stats();
+        send(socket,
+             {{"id", id},
+              {"ok", true},
+              {"stats",
+               QJsonObject{
+                   {"requests", m_requests},
+                   {"coalesced", m_coalesced},
+                   {"pending", m_pending.size()},
+                   {"memoryHits", stats.memoryHits},
+                   {"diskHits", stats.diskHits},
+                   {"misses", stats.misses},
+                   {"hashedBytes", stats.hashedBytes},
+                   {"memoryEntries", stats.memoryEntries},
+                   {"memoryBytes", stats.memoryBytes},
+                   {"cacheDir", m_cache->directory()},
+               }}});
+    } else if (method == "analyze") {
+        const QString file = request.value("file").toString();
+        if (file.isEmpty()) {
+            replyError(socket, id, tr("Не указан файл"));
+            return;
+        }
+        analyze({socket, id, file});
+    } else {
+        replyError(socket, id, tr("Неизвестный метод: %1").arg(method));
+    }
+}
+
+// Стадия 1 в пуле: ключ содержимого и поиск в кэше
+void AnalysisServer::analyze(const Waiter &waiter)
+{
+    m_pool.start([this, waiter] {
+        QString errorString;
+        const QString key = m_cache->keyFor(waiter.file, AnalysisReport::version, errorString);
+        const QByteArray cached = key.isEmpty() ? QByteArray() : m_cache->find(key);
+        QMetaObject::invokeMethod(
+            this,
+            [this, waiter, key, cached, errorString] { onKeyed(waiter, key, cached, errorString); },
+            Qt::QueuedConnection);
+    });
+}
+
+// Стадия 2 в потоке сервера: ответ из кэша, ожидание идущего анализа
+// того же содержимого или запуск нового
+void AnalysisServer::onKeyed(const Waiter &waiter,
+                             const QString &key,
+                             const QByteArray &cached,
+                             const QString &errorString)
+{
+    if (key.isEmpty()) {
+        replyError(waiter.socket, waiter.id, errorString);
+        return;
+    }
+    if (!cached.isEmpty()) {
+        replyResult(waiter, key, cached, true);
+        return;
+    }
+
+    auto it = m_pending.find(key);
+    if (it != m_pending.end()) {
+        ++m_coalesced;
+        it->append(waiter);
+        return;
+    }
+    m_pending.insert(key, {waiter});
+
+    const QString file = waiter.file;
+    m_pool.start([this, key, file] {
+        AnalysisReport report;
+        QString errorString;
+        QByteArray result;
+        if (report.analyze(file, errorString)) {
+            report.releaseSamples();
+            result = QJsonDocument(report.toJson()).toJson(QJsonDocument::Compact);
+            m_cache->insert(key, result);
+        }
+        QMetaObject::invokeMethod(
+            this,
+            [this, key, result, errorString] { onAnalyzed(key, result, errorString); },
+            Qt::QueuedConnection);
+    });
+}
+
+void AnalysisServer::onAnalyzed(const QString &key, const QByteArray &result, const QString &errorString)
+{
+    const QVector<Waiter> waiters = m_pending.take(key);
+    for (const Waiter &waiter : waiters) {
+        if (result.isEmpty())
+            replyError(waiter.socket, waiter.id, errorString);
+        else
+            replyResult(waiter, key, result, false);
+    }
+}
+
+void AnalysisServer::replyResult(const Waiter &waiter, const QString &key, const QByteArray &result, bool cached)
+{
+    if (!waiter.socket)
+        return; // Клиент отключился, результат остаётся в кэше
+
+    // Результат общий для копий файла; путь - тот, о котором спросили
+    QJsonObject report = QJsonDocument::fromJson(result).object();
+    report["file"] = waiter.file;
+    send(waiter.socket,
+         {{"id", waiter.id}, {"ok", true}, {"cached", cached}, {"key", key}, {"result", report}});
+}
+
+void AnalysisServer::replyError(QLocalSocket *socket, const QJsonValue &id, const QString &errorString)
+{
+    send(socket, {{"id", id}, {"ok", false}, {"error", errorString}});
+}
+
+void AnalysisServer::send(QLocalSocket *socket, const QJsonObject &reply)
+{
+    if (!socket || socket->state() != QLocalSocket::ConnectedState)
+        return;
+    socket->write(QJsonDocument(reply).toJson(QJsonDocument::Compact) + '\n');
+}
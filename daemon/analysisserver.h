@@ -0,0 +1,70 @@
+#pragma once
+#ifndef ANALYSISSERVER_H
+#define ANALYSISSERVER_H
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocalServer>
+#include <QPointer>
+#include <QThreadPool>
+#include <QVector>
+
+class QLocalSocket;
+class ResultCache;
+
+// Локальный сервер анализа. Протокол - JSON-объекты по одному на строку
+// в обе стороны; ответы на запросы одного соединения могут приходить не
+// по порядку, поэтому к ответу копируется "id" запроса:
+//   {"id": 1, "method": "analyze", "file": "/path/take.wav"}
+//   -> {"id": 1, "ok": true, "cached": false, "key": "<sha256>", "result": {...}}
+//   {"id": 2, "method": "stats"}  -> {"id": 2, "ok": true, "stats": {...}}
+//   {"id": 3, "method": "ping"}   -> {"id": 3, "ok": true}
+//   ошибка -> {"id": ..., "ok": false, "error": "..."}
+// Хеширование и анализ выполняются в общем пуле; одновременные запросы
+// одного содержимого (в том числе из разных соединений) ждут один анализ.
+class AnalysisServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    AnalysisServer(ResultCache *cache, int jobs, QObject *parent = nullptr);
+    ~AnalysisServer() override;
+
+    bool listen(const QString &name, QString &errorString);
+    QString fullServerName() const { return m_server.fullServerName(); }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    static constexpr qint64 maxRequestBytes = 64 * 1024;
+    static constexpr int probeTimeoutMs = 200;
+
+    struct Waiter
+    {
+        QPointer<QLocalSocket> socket;
+        QJsonValue id;
+        QString file;
+    };
+
+    void handleRequest(QLocalSocket *socket, const QByteArray &line);
+    void analyze(const Waiter &waiter);
+    void onKeyed(const Waiter &waiter, const QString &key, const QByteArray &cached, const QString &errorString);
+    void onAnalyzed(const QString &key, const QByteArray &result, const QString &errorString);
+
+    void replyResult(const Waiter &waiter, const QString &key, const QByteArray &result, bool cached);
+    static void replyError(QLocalSocket *socket, const QJsonValue &id, const QString &errorString);
+    static void send(QLocalSocket *socket, const QJsonObject &reply);
+
+    ResultCache *m_cache;
+    QLocalServer m_server;
+    QThreadPool m_pool;
+    QHash<QString, QVector<Waiter>> m_pending; // Ключ -> ожидающие анализа
+    qint64 m_requests = 0;
+    qint64 m_coalesced = 0;
+};
+
+#endif
@@ -0,0 +1,64 @@
+// Демон анализа: audioanalyzer_daemon [--name имя] [--cache-dir каталог]
+// Принимает запросы через локальный сокет (протокол - в analysisserver.h)
+#include "analysisserver.h"
+#include "resultcache.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QStandardPaths>
+#include <QThread>
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("audioanalyzer_daemon");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QCoreApplication::translate("main", "Локальный сервер анализа WAV с общим кэшем результатов"));
+    parser.addHelpOption();
+
+    const QCommandLineOption nameOption("name",
+                                        QCoreApplication::translate("main", "Имя локального сокета"),
+                                        "name",
+                                        "audioanalyzer");
+    const QCommandLineOption cacheOption("cache-dir",
+                                         QCoreApplication::translate("main", "Каталог кэша результатов"),
+                                         "dir",
+                                         QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    const QCommandLineOption jobsOption({"j", "jobs"},
+                                        QCoreApplication::translate("main", "Число потоков анализа"),
+                                        "n",
+                                        QString::number(QThread::idealThreadCount()));
+    const QCommandLineOption memoryOption("memory-cache-mb",
+                                          QCoreApplication::translate("main", "Размер кэша в памяти, МБ"),
+                                          "mb",
+                                          "64");
+    parser.addOptions({nameOption, cacheOption, jobsOption, memoryOption});
+    parser.process(app);
+
+    bool jobsOk = false, memoryOk = false;
+    const int jobs = parser.value(jobsOption).toInt(&jobsOk);
+    const qint64 memoryLimit = parser.value(memoryOption).toLongLong(&memoryOk) * 1024 * 1024;
+    if (!jobsOk || jobs < 1 || !memoryOk || memoryLimit < 0 || parser.value(cacheOption).isEmpty()) {
+        std::fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate("main", "Некорректные параметры")));
+        parser.showHelp(2);
+    }
+
+    ResultCache cache(parser.value(cacheOption), memoryLimit);
+    AnalysisServer server(&cache, jobs);
+    QString errorString;
+    if (!server.listen(parser.value(nameOption), errorString)) {
+        std::fprintf(stderr,
+                     "%s\n",
+                     qPrintable(QCoreApplication::translate("main", "Не удалось открыть сокет: %1")
+                                    .arg(errorString)));
+        return 2;
+    }
+    std::fprintf(stderr,
+                 "%s\n",
+                 qPrintable(QCoreApplication::translate("main", "Ожидание запросов: %1, кэш: %2")
+                                .arg(server.fullServerName(), cache.directory())));
+    return app.exec();
+}
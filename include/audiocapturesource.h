@@ -0,0 +1,40 @@
+#pragma once
+#ifndef AUDIOCAPTURESOURCE_H
+#define AUDIOCAPTURESOURCE_H
+
+#include <QAudioDevice>
+#include <QAudioFormat>
+#include "inputsource.h"
+
+class QAudioSource;
+class CaptureDevice;
+
+// Захват со звукового входа (QAudioSource). Устройство пишет в собственный
+// QIODevice, который сводит каналы в моно float и кладёт их в кольцевой буфер.
+class AudioCaptureSource : public InputSource
+{
+    Q_OBJECT
+
+public:
+    // Пустое устройство - вход по умолчанию
+    explicit AudioCaptureSource(const QAudioDevice &device = QAudioDevice(),
+                                QObject *parent = nullptr);
+    ~AudioCaptureSource() override;
+
+    bool start(QString &err) override;
+    void stop() override;
+    bool isActive() const override;
+    QString name() const override;
+
+private:
+    static constexpr int bufferMs = 10; // Буфер устройства: задержка против устойчивости
+
+    QAudioDevice m_device;
+    QAudioFormat m_format;
+    QAudioSource *m_source = nullptr;
+    CaptureDevice *m_sink = nullptr;
+
+    friend class CaptureDevice;
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * audioanalyzer.h - C API ядра анализа (библиотека audioanalyzer_c).
+ *
+ * Стабильный интерфейс без типов Qt и C++: чтение WAV, спектр, спектрограмма
+ * и потоковое STFT. Результаты пишутся прямо в буферы вызывающего, без
+ * промежуточных копий.
+ *
+ * Версии. В пределах одной старшей версии (AUDIOANALYZER_VERSION_MAJOR,
+ * она же SOVERSION библиотеки) функции и перечисления только добавляются,
+ * а структуры только дополняются полями в конце; у таких структур первое
+ * поле struct_size, которое вызывающий заполняет sizeof(структуры), и
+ * библиотека не пишет за его пределы. aa_version() возвращает версию
+ * загруженной библиотеки.
+ *
+ * Потокобезопасность.
+ *  - Глобального состояния нет (кроме неизменяемых таблиц), Qt-цикл событий
+ *    и QCoreApplication не нужны; функции можно вызывать из любых потоков.
+ *  - aa_audio неизменяем после создания: aa_audio_info, aa_audio_read,
+ *    aa_audio_spectrum и aa_audio_spectrogram можно одновременно вызывать
+ *    для одного объекта из разных потоков. aa_audio_free - только когда
+ *    других вызовов с этим объектом нет.
+ *  - aa_stream хранит состояние потока: один объект - не больше одного
+ *    вызова одновременно (синхронизация на стороне вызывающего); разные
+ *    объекты независимы.
+ *  - aa_last_error() возвращает текст последней ошибки вызывающего потока;
+ *    строка действительна до следующего вызова библиотеки в этом потоке.
+ *
+ * Строки - UTF-8. Функции не бросают исключений и не завершают процесс:
+ * все ошибки возвращаются кодом aa_status.
+ */
+#ifndef AUDIOANALYZER_C_H
+#define AUDIOANALYZER_C_H
+
+#include <stdint.h>
+
+#define AUDIOANALYZER_VERSION_MAJOR 1
+#define AUDIOANALYZER_VERSION_MINOR 0
+#define AUDIOANALYZER_VERSION_PATCH 0
+#define AUDIOANALYZER_VERSION \
+    ((AUDIOANALYZER_VERSION_MAJOR << 16) | (AUDIOANALYZER_VERSION_MINOR << 8) | AUDIOANALYZER_VERSION_PATCH)
+
+#if defined(_WIN32)
+#  if defined(AUDIOANALYZER_C_BUILD)
+#    define AA_API __declspec(dllexport)
+#  else
+#    define AA_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define AA_API __attribute__((visibility("default")))
+#else
+#  define AA_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Параметры спектрограммы и спектра (совпадают с приложением) */
+#define AA_SPECTROGRAM_FFT_SIZE 512
+#define AA_SPECTROGRAM_BINS 256
+#define AA_SPECTRUM_FFT_SIZE 2048
+#define AA_SPECTRUM_BINS 1024
+
+typedef enum aa_status {
+    AA_OK = 0,
+    AA_ERROR_INVALID_ARGUMENT = 1,
+    AA_ERROR_IO = 2,               /* Файл не открывается или не читается */
+    AA_ERROR_UNSUPPORTED_FORMAT = 3,
+    AA_ERROR_BUFFER_TOO_SMALL = 4, /* Нужный размер возвращается через out-параметр */
+    AA_ERROR_OUT_OF_MEMORY = 5,
+    AA_ERROR_INTERNAL = 6
+} aa_status;
+
+typedef enum aa_spectrogram_mode {
+    AA_SPECTROGRAM_STANDARD = 0, /* STFT, окно Ханна */
+    AA_SPECTROGRAM_REASSIGNED = 1 /* С переназначением частоты и времени */
+} aa_spectrogram_mode;
+
+/* Версия библиотеки в формате AUDIOANALYZER_VERSION */
+AA_API uint32_t aa_version(void);
+AA_API const char *aa_status_string(aa_status status);
+AA_API const char *aa_last_error(void);
+
+/* ---- Загруженная запись ---- */
+
+typedef struct aa_audio aa_audio;
+
+typedef struct aa_audio_info {
+    uint32_t struct_size; /* sizeof(aa_audio_info), заполняет вызывающий */
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t bits_per_sample; /* 0 для aa_audio_create */
+    int64_t frames;
+    double duration_seconds;
+} aa_audio_info;
+
+/* WAV PCM 8/16 бит, декодируется целиком */
+AA_API aa_status aa_audio_open_wav(const char *path, aa_audio **out_audio);
+
+/* Из сэмплов float [-1, 1], каналы чередуются; данные копируются */
+AA_API aa_status aa_audio_create(const float *interleaved,
+                                 int64_t frames,
+                                 uint32_t channels,
+                                 uint32_t sample_rate,
+                                 aa_audio **out_audio);
+
+/* NULL допустим */
+AA_API void aa_audio_free(aa_audio *audio);
+
+AA_API aa_status aa_audio_info_get(const aa_audio *audio, aa_audio_info *out_info);
+
+/* Сэмплы [first_frame, first_frame + count) канала channel, -1 - среднее по
+ * каналам. out_read (может быть NULL) - сколько записано (меньше count в
+ * конце записи). */
+AA_API aa_status aa_audio_read(const aa_audio *audio,
+                               int32_t channel,
+                               int64_t first_frame,
+                               int64_t count,
+                               float *out,
+                               int64_t *out_read);
+
+/* Спектр моно-смеси: AA_SPECTRUM_BINS значений в дБ по окну Ханна
+ * AA_SPECTRUM_FFT_SIZE с first_frame; шаг по частоте sample_rate /
+ * AA_SPECTRUM_FFT_SIZE. */
+AA_API aa_status aa_audio_spectrum(const aa_audio *audio, int64_t first_frame, double *out_db);
+
+/* Число кадров спектрограммы с шагом hop */
+AA_API int64_t aa_audio_spectrogram_frames(const aa_audio *audio, int32_t hop);
+
+/* Кадры [first_frame, first_frame + frame_count) спектрограммы моно-смеси:
+ * по AA_SPECTROGRAM_BINS линейных магнитуд |X| на кадр, кадры подряд.
+ * capacity - размер out в float; если мал, в out_required (может быть NULL)
+ * возвращается нужный и код AA_ERROR_BUFFER_TOO_SMALL. Кадры считаются
+ * прямо в out; диапазон можно разбивать на части и считать параллельно. */
+AA_API aa_status aa_audio_spectrogram(const aa_audio *audio,
+                                      aa_spectrogram_mode mode,
+                                      int32_t hop,
+                                      int64_t first_frame,
+                                      int64_t frame_count,
+                                      float *out,
+                                      int64_t capacity,
+                                      int64_t *out_required);
+
+/* ---- Потоковое STFT ---- */
+
+typedef struct aa_stream aa_stream;
+
+/* fft_size - чётный, hop в [1, fft_size]; окно Ханна */
+AA_API aa_status aa_stream_create(int32_t fft_size, int32_t hop, aa_stream **out_stream);
+AA_API void aa_stream_free(aa_stream *stream);
+
+/* fft_size / 2 */
+AA_API int32_t aa_stream_bins(const aa_stream *stream);
+
+/* Приём блока моно-сэмплов любой длины. Готовые кадры (по
+ * aa_stream_bins() линейных магнитуд) пишутся в out, не больше max_frames;
+ * приём останавливается, когда out заполнен, поэтому out_consumed может
+ * быть меньше count - остаток передаётся следующим вызовом.
+ * out_end_samples (может быть NULL, иначе на max_frames элементов) - номер
+ * сэмпла сразу после окна каждого кадра. */
+AA_API aa_status aa_stream_push(aa_stream *stream,
+                                const float *samples,
+                                int64_t count,
+                                float *out,
+                                int32_t max_frames,
+                                int64_t *out_end_samples,
+                                int64_t *out_consumed,
+                                int32_t *out_frames);
+
+/* Разрыв потока: skipped сэмплов пропущено, начатое окно отбрасывается */
+AA_API aa_status aa_stream_skip(aa_stream *stream, int64_t skipped);
+
+/* Сэмплов принято с начала (с учётом пропущенных) */
+AA_API int64_t aa_stream_position(const aa_stream *stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef ANALYSISPIPELINE_H
+#define ANALYSISPIPELINE_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Конвейер пакетного расчёта спектрограмм: чтение -> декодирование ->
+// анализ -> запись. Стадии работают в своих потоках (число задаётся для
+// каждой) и связаны очередями BoundedQueue ограниченной ёмкости, так что
+// память не растёт, какая бы стадия ни оказалась узкой. Единица работы -
+// блок из blockFrames кадров спектрограммы; блоки одного файла
+// независимы (читаются с перекрытием fftSize - hop сэмплов) и пишутся в
+// NPY-файл по своему смещению, поэтому порядок их обработки не важен.
+class AnalysisPipeline
+{
+    Q_DECLARE_TR_FUNCTIONS(AnalysisPipeline)
+
+public:
+    struct Config
+    {
+        int readThreads = 1;
+        int decodeThreads = 1;
+        int analyzeThreads = 1;
+        int writeThreads = 1;
+        int queueCapacity = 16; // Блоков в каждой очереди
+        int blockFrames = 1024; // Кадров спектрограммы в блоке
+        int hop = 256;          // Шаг кадров (окно SpectrogramCache::fftSize)
+    };
+
+    // Вход и путь результата (.npy: кадры x бины, дБ)
+    struct Job
+    {
+        QString input;
+        QString output;
+    };
+
+    struct StageStats
+    {
+        QString name;
+        int threads = 0;
+        qint64 items = 0;          // Блоков обработано
+        qint64 bytes = 0;          // Байт на выходе стадии
+        double busyMs = 0.0;       // Суммарно по потокам, без ожидания очередей
+        double inputWaitMs = 0.0;  // Ждали входной очереди (стадия голодала)
+        double outputWaitMs = 0.0; // Ждали места в выходной (упёрлись в следующую)
+    };
+
+    struct QueueStats
+    {
+        QString name;
+        qsizetype capacity = 0;
+        qsizetype depth = 0;
+        qsizetype maxDepth = 0;
+        double meanDepth = 0.0;
+    };
+
+    struct Stats
+    {
+        double elapsedMs = 0.0;
+        QVector<StageStats> stages;
+        QVector<QueueStats> queues;
+        int filesDone = 0;
+        int filesFailed = 0;
+    };
+
+    // Вызывается из потоков конвейера; обработчик должен быть потокобезопасным
+    using FileHandler = std::function<void(const Job &job, bool ok, const QString &error)>;
+    // Вызывается из потока, вызвавшего run()
+    using StatsHandler = std::function<void(const Stats &stats)>;
+
+    explicit AnalysisPipeline(const Config &config);
+
+    // Блокирует до обработки всех заданий; onStats - раз в statsIntervalMs
+    Stats run(const QVector<Job> &jobs,
+              const FileHandler &onFile = {},
+              const StatsHandler &onStats = {},
+              int statsIntervalMs = 1000);
+
+    // Текстовая сводка по стадиям и очередям
+    static QString formatStats(const Stats &stats);
+
+private:
+    Config m_config;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef ANALYSISREPORT_H
+#define ANALYSISREPORT_H
+
+#include "audiofeatures.h"
+#include "audiomodel.h"
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+// Сводный анализ файла без интерфейса: метаданные, спектр и признаки
+// через AudioModel и AudioFeatures, с выдачей одним JSON-объектом. Общий
+// для пакетной обработки и демона анализа.
+class AnalysisReport
+{
+public:
+    // Меняется вместе с составом или расчётом отчёта (входит в ключ кэша)
+    static constexpr int version = 2;
+
+    // Вызывается в рабочем потоке; сигналы модели доставляются напрямую
+    bool analyze(const QString &filePath, QString &errorString);
+
+    const QString &filePath() const { return m_filePath; }
+    const AudioModel::Meta &meta() const { return m_meta; }
+    const AudioFeatures::Summary &features() const { return m_features; }
+    const QVector<double> &samples() const { return m_samples; }
+    quint32 sampleRate() const { return m_sampleRate; }
+
+    // Моно-сэмплы нужны только для производных результатов (спектрограмма)
+    void releaseSamples() { m_samples = {}; }
+
+    // {"file", "meta", "features", "spectrum"}
+    QJsonObject toJson() const;
+
+private:
+    QString m_filePath;
+    AudioModel::Meta m_meta;
+    AudioFeatures::Summary m_features;
+    QVector<double> m_samples;
+    quint32 m_sampleRate = 0;
+    QVector<double> m_frequencies;
+    QVector<double> m_spectrumDb;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+#ifndef AUDIOFEATURES_H
+#define AUDIOFEATURES_H
+
+#include <QVector>
+#include <functional>
+
+// Признаки записи для пакетной обработки: временные (уровень, пересечения
+// нуля) и спектральные по кадрам STFT (окно Ханна fftSize, шаг hop) -
+// покадровым рядом или сводкой, усреднённой по кадрам. Только QtCore и kissfft.
+namespace AudioFeatures {
+
+constexpr int fftSize = 2048;
+constexpr int hop = fftSize / 2;
+constexpr double rolloffFraction = 0.85;
+
+// Признаки одного кадра
+struct Frame
+{
+    qint64 endSample = 0;            // Номер сэмпла сразу после окна
+    double rmsDb = -240.0;           // Уровень окна (без оконной функции), dBFS
+    double zeroCrossingRate = 0.0;   // Пересечений нуля на сэмпл в окне
+    double spectralCentroidHz = 0.0; // Центр тяжести спектра мощности
+    double spectralSpreadHz = 0.0;   // СКО частоты относительно центроида
+    double spectralRolloffHz = 0.0;  // Ниже лежит rolloffFraction энергии
+    double spectralFlatness = 0.0;   // Геометрическое к арифметическому среднему, 0..1
+    double spectralFlux = 0.0;       // Изменение нормированного спектра от прошлого кадра
+    bool silent = true;              // Нулевая мощность: спектральные признаки не определены
+};
+
+struct Summary
+{
+    qint64 frameCount = 0;           // Кадров STFT
+    double rmsDb = -240.0;           // dBFS
+    double peakDb = -240.0;          // dBFS
+    double crestFactorDb = 0.0;      // Пик к RMS
+    double zeroCrossingRate = 0.0;   // Пересечений нуля на сэмпл
+    double spectralCentroidHz = 0.0; // Средние по незатихшим кадрам
+    double spectralSpreadHz = 0.0;
+    double spectralRolloffHz = 0.0;
+    double spectralFlatness = 0.0;
+    double spectralFlux = 0.0;       // Среднее по всем кадрам
+};
+
+using FrameHandler = std::function<void(const Frame &frame)>;
+
+// Покадровый ряд признаков за один проход; возвращает число кадров
+qint64 forEachFrame(const QVector<double> &samples, quint32 sampleRate, const FrameHandler &onFrame);
+
+Summary compute(const QVector<double> &samples, quint32 sampleRate);
+
+} // namespace AudioFeatures
+
+#endif
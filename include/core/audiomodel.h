@@ -0,0 +1,80 @@
+#pragma once
+#ifndef AUDIOMODEL_H
+#define AUDIOMODEL_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+class SpectrogramCache;
+
+class AudioModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Meta
+    {
+        double durationSeconds = 0.0;
+        quint32 sampleRate = 0;
+        quint32 byteRate = 0;
+        quint16 channels = 0;
+        quint16 bitsPerSample = 0;
+        quint32 bitRate = 0;
+        double peakDb = -240.0; // Пиковый уровень, dBFS
+        double rmsDb = -240.0;  // Средний (RMS) уровень, dBFS
+        // Громкость по EBU R128 (LoudnessMeter)
+        double integratedLufs = -240.0;
+        double loudnessRangeLu = 0.0;
+        double maxMomentaryLufs = -240.0;
+        double maxShortTermLufs = -240.0;
+    };
+
+    // Спектр файла: одно окно Ханна в начале записи
+    static constexpr int spectrumFftSize = 2048;
+    static constexpr int spectrumBinCount = spectrumFftSize / 2;
+
+    explicit AudioModel(QObject *parent = nullptr);
+
+    bool loadWav(const QString &filePath, Meta &outMeta, QString &errorString);
+
+    // Ленивый режим: спектрограмма считается по запросу вида через кэш
+    void setLazySpectrogram(bool enabled);
+    bool lazySpectrogram() const { return m_lazySpectrogram; }
+
+    // Без спектрограммы вовсе (пакетный анализ и демон считают её сами
+    // полосами): ни полного расчёта, ни передачи сэмплов в кэш
+    void setSpectrogramEnabled(bool enabled) { m_spectrogramEnabled = enabled; }
+
+    // Потоки измерения громкости при загрузке. По умолчанию 1: модели в
+    // рабочих потоках пакетного анализа и демона не должны плодить потоки
+    // сверх своего пула; GUI задаёт число ядер.
+    void setLoudnessThreads(int threads) { m_loudnessThreads = qMax(1, threads); }
+    SpectrogramCache *spectrogramCache() const { return m_spectrogramCache; }
+
+signals:
+    void metadataReady(const AudioModel::Meta &m);
+    void waveformReady(const QVector<double> &samples, quint32 rate);
+    // Каналы по отдельности, нормализованные к [-1.0, 1.0]
+    void channelsReady(const QVector<QVector<double>> &channels, quint32 rate);
+    void spectrumReady(const QVector<double> &frequencies,
+                       const QVector<double> &magnitudes);
+    void spectrogramReady(const QVector<QVector<double>> &frames);
+    void errorOccurred(const QString &error);
+
+private:
+    SpectrogramCache *m_spectrogramCache;
+    bool m_lazySpectrogram = true;
+    bool m_spectrogramEnabled = true;
+    int m_loudnessThreads = 1;
+
+    void calculateSpectrogram(const QVector<double> &samples, quint32 sampleRate);
+public:
+    void calculateSpectrum(const QVector<double> &samples, quint32 sampleRate);
+
+    // spectrumBinCount значений в дБ по окну с samples (недостающие - нули);
+    // без сигналов, потокобезопасно
+    static bool computeSpectrum(const double *samples, qsizetype count, double *magnitudesDb);
+};
+
+#endif
@@ -0,0 +1,114 @@
+#pragma once
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <deque>
+#include <utility>
+
+// Очередь ограниченной ёмкости между стадиями конвейера (много писателей,
+// много читателей). push() ждёт, пока есть место - это и есть обратное
+// давление: быстрая стадия не уходит вперёд медленной дальше capacity
+// элементов. После close() писать нельзя, pop() отдаёт остаток и затем false.
+template<typename T>
+class BoundedQueue
+{
+public:
+    struct Stats
+    {
+        qsizetype capacity = 0;
+        qsizetype depth = 0;
+        qsizetype maxDepth = 0;
+        double meanDepth = 0.0; // Средняя глубина в момент записи
+        qint64 pushed = 0;
+        qint64 pushWaitNs = 0; // Писатели ждали места
+        qint64 popWaitNs = 0;  // Читатели ждали данных
+    };
+
+    explicit BoundedQueue(qsizetype capacity)
+        : m_capacity(qMax<qsizetype>(1, capacity))
+    {}
+
+    bool push(T item)
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_closed && qsizetype(m_items.size()) >= m_capacity) {
+            QElapsedTimer wait;
+            wait.start();
+            while (!m_closed && qsizetype(m_items.size()) >= m_capacity)
+                m_notFull.wait(&m_mutex);
+            m_pushWaitNs += wait.nsecsElapsed();
+        }
+        if (m_closed)
+            return false;
+
+        m_items.push_back(std::move(item));
+        const qsizetype depth = qsizetype(m_items.size());
+        m_maxDepth = qMax(m_maxDepth, depth);
+        m_depthSum += depth;
+        ++m_pushed;
+        m_notEmpty.wakeOne();
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_items.empty() && !m_closed) {
+            QElapsedTimer wait;
+            wait.start();
+            while (m_items.empty() && !m_closed)
+                m_notEmpty.wait(&m_mutex);
+            m_popWaitNs += wait.nsecsElapsed();
+        }
+        if (m_items.empty())
+            return false;
+
+        item = std::move(m_items.front());
+        m_items.pop_front();
+        m_notFull.wakeOne();
+        return true;
+    }
+
+    // Писателей больше не будет; ждущие просыпаются
+    void close()
+    {
+        QMutexLocker lock(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        m_notFull.wakeAll();
+    }
+
+    Stats stats() const
+    {
+        QMutexLocker lock(&m_mutex);
+        Stats s;
+        s.capacity = m_capacity;
+        s.depth = qsizetype(m_items.size());
+        s.maxDepth = m_maxDepth;
+        s.meanDepth = m_pushed > 0 ? double(m_depthSum) / m_pushed : 0.0;
+        s.pushed = m_pushed;
+        s.pushWaitNs = m_pushWaitNs;
+        s.popWaitNs = m_popWaitNs;
+        return s;
+    }
+
+private:
+    const qsizetype m_capacity;
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    std::deque<T> m_items;
+    bool m_closed = false;
+
+    qsizetype m_maxDepth = 0;
+    qint64 m_depthSum = 0;
+    qint64 m_pushed = 0;
+    qint64 m_pushWaitNs = 0;
+    qint64 m_popWaitNs = 0;
+};
+
+#endif
@@ -0,0 +1,108 @@
+#pragma once
+#ifndef BUFFEREDWRITER_H
+#define BUFFEREDWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QStringList>
+
+// Буферизованная запись в устройство: данные копятся в блоке bufferSize
+// и уходят в устройство целиком, так что экспорт любого объёма держит в
+// памяти не больше одного блока. Ошибка записи запоминается, дальнейшие
+// вызовы ничего не делают; итог проверяется flush().
+class BufferedWriter
+{
+public:
+    static constexpr qsizetype bufferSize = 1 << 16;
+
+    explicit BufferedWriter(QIODevice *device);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    void write(const char *data, qsizetype size);
+    void write(const QByteArray &data) { write(data.constData(), data.size()); }
+    void write(char c);
+
+    // Числа в записи, не зависящей от локали
+    void writeNumber(double value, int precision = 7);
+    void writeNumber(qint64 value);
+
+    // float32 little-endian
+    void writeFloats(const float *values, qsizetype count);
+
+    // Всё накопленное - в устройство
+    bool flush();
+    bool ok() const { return m_ok; }
+    QIODevice *device() const { return m_device; }
+
+private:
+    QIODevice *m_device;
+    QByteArray m_buffer;
+    bool m_ok = true;
+};
+
+// CSV (RFC 4180): поля через запятую, строки через \n; текст в кавычках,
+// если в нём есть разделитель, кавычки или перевод строки
+class CsvWriter
+{
+public:
+    explicit CsvWriter(QIODevice *device);
+
+    void writeHeader(const QStringList &columns);
+
+    CsvWriter &field(double value, int precision = 7);
+    CsvWriter &field(qint64 value);
+    CsvWriter &field(const QString &value);
+    void endRow();
+
+    bool finish() { return m_out.flush(); }
+
+private:
+    BufferedWriter m_out;
+    bool m_rowStarted = false;
+
+    void separator();
+};
+
+// JSON Lines: один компактный объект на строку
+class JsonLinesWriter
+{
+public:
+    explicit JsonLinesWriter(QIODevice *device);
+
+    void write(const QJsonObject &object);
+    bool finish() { return m_out.flush(); }
+
+private:
+    BufferedWriter m_out;
+};
+
+// Матрица float32 в формате NPY (версия 1.0, little-endian, по строкам).
+// Строки дописываются по мере готовности; число строк в заголовке
+// исправляется в finish(), поэтому устройство должно поддерживать seek.
+class NpyWriter
+{
+public:
+    static constexpr int headerSize = 128; // Кратно 64, с запасом под любые размеры
+
+    // Заголовок матрицы rows x columns; данные начинаются с headerSize
+    static QByteArray header(qint64 rows, int columns);
+
+    explicit NpyWriter(QIODevice *device);
+
+    bool begin(int columns);
+    void appendRows(const float *values, qint64 rows);
+    bool finish();
+
+    qint64 rows() const { return m_rows; }
+
+private:
+    BufferedWriter m_out;
+    int m_columns = 0;
+    qint64 m_rows = 0;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef GENERATORSOURCE_H
+#define GENERATORSOURCE_H
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVector>
+#include "inputsource.h"
+
+// Источник без звукового устройства: в реальном темпе по таймеру отдаёт
+// сэмплы из буфера (по кругу) или синтезирует тон с шумом. Нужен для
+// проверок живого режима и для машин без входа.
+class GeneratorSource : public InputSource
+{
+    Q_OBJECT
+
+public:
+    explicit GeneratorSource(QObject *parent = nullptr);
+
+    // Воспроизведение готовых сэмплов по кругу (например, открытого файла)
+    void setSamples(const QVector<double> &samples, quint32 sampleRate);
+
+    // Синус frequency Гц с амплитудой amplitude и белым шумом noise
+    void setTone(double frequency, quint32 sampleRate, double amplitude = 0.5, double noise = 0.01);
+
+    bool start(QString &err) override;
+    void stop() override;
+    bool isActive() const override { return m_timer.isActive(); }
+    QString name() const override;
+
+private:
+    static constexpr int tickMs = 5;
+
+    QVector<double> m_samples;
+    quint32 m_rate = 0;
+    double m_frequency = 0.0;
+    double m_amplitude = 0.0;
+    double m_noise = 0.0;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_produced = 0;
+    double m_phase = 0.0;
+    QVector<float> m_block;
+
+    void produce();
+};
+
+#endif
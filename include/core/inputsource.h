@@ -0,0 +1,68 @@
+#pragma once
+#ifndef INPUTSOURCE_H
+#define INPUTSOURCE_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include "spscringbuffer.h"
+
+// Потоковый источник для живого анализа: моно-сэмплы складываются в
+// кольцевой буфер одного писателя (поток захвата или таймер генератора)
+// и забираются потоком анализа. Каждый принятый блок помечается временем
+// по монотонным часам, чтобы считать задержку от захвата до экрана.
+class InputSource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputSource(QObject *parent = nullptr);
+    ~InputSource() override = default;
+
+    virtual bool start(QString &err) = 0;
+    virtual void stop() = 0;
+    virtual bool isActive() const = 0;
+    virtual QString name() const = 0;
+
+    quint32 sampleRate() const { return m_sampleRate; }
+
+    // Для потока анализа: чтение и пропуск накопившегося
+    qsizetype read(float *dst, qsizetype count) { return m_ring.read(dst, count); }
+    qsizetype available() const { return m_ring.readAvailable(); }
+    qsizetype skip(qsizetype count);
+
+    // Сэмплов принято с начала захвата и потеряно из-за переполнения буфера
+    qint64 framesCaptured() const { return m_captured; }
+    qint64 framesDropped() const { return m_dropped; }
+
+    // Оценка момента захвата сэмпла с номером sample (нс, см. clockNs)
+    qint64 captureTimeNs(qint64 sample) const;
+
+    // Общие для источника и видов монотонные часы
+    static qint64 clockNs();
+
+signals:
+    void errorOccurred(const QString &error);
+
+protected:
+    static constexpr int ringFrames = 1 << 16;
+
+    // Только в потоке писателя
+    void pushFrames(const float *mono, qsizetype count);
+
+    // До старта захвата: сбрасывает счётчики и буфер
+    void reset(quint32 sampleRate);
+
+private:
+    SpscRingBuffer<float> m_ring{ringFrames};
+    std::atomic<quint32> m_sampleRate{0};
+    std::atomic<qint64> m_captured{0};
+    std::atomic<qint64> m_dropped{0};
+
+    // Последний принятый блок: номер его конца и время приёма. Пара пишется
+    // без блокировки, рассогласование на один блок даёт ошибку в пределах блока
+    std::atomic<qint64> m_stampFrames{0};
+    std::atomic<qint64> m_stampNs{0};
+};
+
+#endif
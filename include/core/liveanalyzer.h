@@ -0,0 +1,101 @@
+#pragma once
+#ifndef LIVEANALYZER_H
+#define LIVEANALYZER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+class InputSource;
+class QThread;
+
+// Живой анализ потокового входа: поток анализа забирает сэмплы источника,
+// пропускает через StreamingStft и копит срезы спектрограммы, которые GUI
+// забирает раз в кадр. Задержка ограничена: если анализ или GUI отстали,
+// старые сэмплы и срезы отбрасываются, а не ставятся в очередь.
+class LiveAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Те же параметры, что у спектрограммы файла (AudioModel)
+    static constexpr int fftSize = 512;
+    static constexpr int binCount = fftSize / 2;
+    static constexpr int hop = fftSize / 2;
+
+    static constexpr int maxBacklogMs = 40;     // Больше - старые сэмплы пропускаются
+    static constexpr int maxPendingSlices = 64; // Больше - старые срезы отбрасываются
+
+    struct Slice
+    {
+        QVector<double> magnitudes; // binCount линейных магнитуд
+        qint64 endSample = 0;       // Номер сэмпла сразу после окна
+    };
+
+    struct Latency
+    {
+        double currentMs = 0.0; // От захвата последнего сэмпла окна до кадра экрана
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+        double boundMs = 0.0;     // Расчётный предел при текущей частоте
+        qint64 skippedFrames = 0; // Сэмплов пропущено из-за отставания
+        qint64 droppedSlices = 0; // Срезов отброшено, потому что GUI не успел
+    };
+
+    explicit LiveAnalyzer(QObject *parent = nullptr);
+    ~LiveAnalyzer() override;
+
+    // Источник меняется только при остановленном анализе
+    void setSource(InputSource *source);
+    InputSource *source() const { return m_source; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // Частоты полос для текущего источника
+    QVector<double> frequencies() const;
+
+    // Для потока GUI: срезы, посчитанные с прошлого вызова
+    QVector<Slice> takeSlices();
+
+    // Срез с концом endSample попал на экран; обновляет статистику задержки
+    void markPresented(qint64 endSample);
+
+    static constexpr int statsIntervalMs = 1000;
+
+signals:
+    // Есть новые срезы; повторно не приходит, пока они не забраны
+    void slicesReady();
+    void latencyUpdated(const LiveAnalyzer::Latency &latency);
+
+private:
+    static constexpr int readChunk = 1024;
+    static constexpr int idleWaitMs = 2;
+
+    InputSource *m_source = nullptr;
+    std::atomic_bool m_running{false};
+    std::atomic_bool m_notifyPending{false};
+    std::atomic<qint64> m_skipped{0};
+
+    QThread *m_thread = nullptr;
+    QMutex m_waitMutex;
+    QWaitCondition m_wake;
+
+    QMutex m_sliceMutex;
+    QVector<Slice> m_pending;
+    qint64 m_droppedSlices = 0;
+
+    // Статистика задержки (поток GUI)
+    Latency m_latency;
+    double m_latencySumMs = 0.0;
+    int m_latencyCount = 0;
+    qint64 m_latencyWindowNs = 0;
+
+    void run();
+    double latencyBoundMs() const;
+};
+
+#endif
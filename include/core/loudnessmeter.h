@@ -0,0 +1,108 @@
+#pragma once
+#ifndef LOUDNESSMETER_H
+#define LOUDNESSMETER_H
+
+#include <QVector>
+
+// Громкость по EBU R128 / ITU-R BS.1770-4 за один потоковый проход.
+// K-взвешивание (полка и ФВЧ, два биквада) идёт сразу по всем каналам:
+// каналы раскладываются по дорожкам вектора (1, 2, 4 или 8), и одна
+// итерация фильтра обрабатывает кадр целиком. Энергия копится шагами по
+// 100 мс; из шагов складываются блоки 400 мс (мгновенная громкость и
+// стробирование интегральной) и 3 с (кратковременная и диапазон LRA).
+// Блоки попадают в гистограммы с шагом 0.1 LU, поэтому память постоянна,
+// а process() ничего не выделяет и годится для звукового потока.
+class LoudnessMeter
+{
+public:
+    static constexpr int maxChannels = 8;
+    static constexpr int stepsPerSecond = 10;
+    static constexpr int momentarySteps = 4;  // 400 мс
+    static constexpr int shortTermSteps = 30; // 3 с
+    static constexpr double absoluteGateLufs = -70.0;
+    static constexpr double relativeGateLu = -10.0;      // Интегральная громкость
+    static constexpr double rangeRelativeGateLu = -20.0; // Диапазон громкости
+    static constexpr double minLufs = -240.0;            // Нет данных или тишина
+
+    struct Result
+    {
+        double momentaryLufs = minLufs;    // Последние 400 мс
+        double shortTermLufs = minLufs;    // Последние 3 с
+        double integratedLufs = minLufs;   // Со стробированием, с начала измерения
+        double loudnessRangeLu = 0.0;      // LRA: от 10-го до 95-го процентиля кратковременной
+        double maxMomentaryLufs = minLufs;
+        double maxShortTermLufs = minLufs;
+    };
+
+    // Каналы в порядке WAV; у 5 и 6 каналов объёмные (Ls, Rs) весят 1.41,
+    // LFE не учитывается. Каналы сверх maxChannels не измеряются.
+    LoudnessMeter(quint32 sampleRate, int channels);
+
+    void reset();
+
+    // frames сэмплов каждого канала (по указателю на канал)
+    void process(const double *const *channels, qsizetype frames);
+
+    qint64 stepCount() const { return m_stepCount; }
+    Result result() const;
+
+    // Файл целиком: участки по границам шагов считаются в threads потоках,
+    // фильтры каждого разгоняются на предыдущих шагах; энергии шагов затем
+    // сводятся по порядку, так что результат совпадает с одним проходом
+    static Result measure(const QVector<QVector<double>> &channels, quint32 sampleRate, int threads);
+
+private:
+    static constexpr int blockFrames = 256;
+    static constexpr int warmupSteps = 2;       // Переходный процесс K-фильтра - единицы мс
+    static constexpr int minSegmentSteps = 600; // Участок не короче минуты
+    static constexpr int histogramBinsPerLu = 10;
+    static constexpr double histogramMaxLufs = 10.0;
+    static constexpr int histogramBins = int((histogramMaxLufs - absoluteGateLufs) * histogramBinsPerLu);
+
+    struct Biquad
+    {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    };
+
+    // Блоки выше абсолютного порога: число и сумма энергий по полосам 0.1 LU
+    struct Histogram
+    {
+        QVector<qint64> counts;
+        QVector<double> energies;
+        qint64 total = 0;
+        double totalEnergy = 0.0;
+
+        void clear();
+        void add(double energy);
+        // Первая полоса не ниже порога относительно средней энергии
+        int gateBin(double relativeLu) const;
+    };
+
+    int m_channels = 0;
+    int m_lanes = 1;
+    qint64 m_stepLength = 1;
+    Biquad m_shelf;
+    Biquad m_highPass;
+    alignas(64) double m_weights[maxChannels] = {};
+    alignas(64) double m_state[4][maxChannels] = {}; // Состояния двух биквадов (TDF-II)
+    alignas(64) double m_sums[maxChannels] = {};     // Сумма квадратов текущего шага
+    alignas(64) double m_block[blockFrames * maxChannels] = {};
+    qint64 m_stepFill = 0;
+
+    double m_steps[shortTermSteps] = {}; // Энергии последних шагов (кольцо)
+    qint64 m_stepCount = 0;
+    double m_maxMomentary = 0.0;
+    double m_maxShortTerm = 0.0;
+    Histogram m_momentaryBlocks;
+    Histogram m_shortTermBlocks;
+
+    QVector<double> *m_stepLog = nullptr; // Для measure(): энергии всех шагов
+
+    template<int Lanes>
+    void filterBlock(int frames);
+    void finishStep();
+    void addStep(double energy);
+    double recentEnergy(int steps) const;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef REASSIGNEDSPECTROGRAM_H
+#define REASSIGNEDSPECTROGRAM_H
+
+#include <QVector>
+
+extern "C" {
+#include <kiss_fftr.h>
+}
+
+// Спектрограмма с переназначением (reassignment): помимо окна Ханна считаются
+// БПФ с окном, умноженным на время, и с производной окна. По ним энергия каждой
+// ячейки переносится в уточнённую точку (время, частота) сетки кадров.
+// Экземпляр не потокобезопасен: для параллельного расчёта нужен свой на поток.
+class ReassignedSpectrogram
+{
+public:
+    explicit ReassignedSpectrogram(int fftSize);
+    ~ReassignedSpectrogram();
+
+    ReassignedSpectrogram(const ReassignedSpectrogram &) = delete;
+    ReassignedSpectrogram &operator=(const ReassignedSpectrogram &) = delete;
+
+    int fftSize() const { return m_fftSize; }
+    int binCount() const { return m_fftSize / 2; }
+
+    // Расчёт frameCount кадров начиная с firstFrame (шаг hop) в out размером
+    // frameCount * binCount. Соседние кадры вне диапазона тоже учитываются,
+    // если их энергия переносится внутрь него.
+    void computeFrames(const double *samples,
+                       qint64 sampleCount,
+                       qint64 hop,
+                       qint64 firstFrame,
+                       int frameCount,
+                       float *out);
+
+private:
+    int m_fftSize;
+    kiss_fftr_cfg m_cfg = nullptr;
+
+    QVector<double> m_window;      // h(t)
+    QVector<double> m_timeWindow;  // t * h(t), t отсчитывается от центра окна
+    QVector<double> m_derivWindow; // dh/dt
+
+    QVector<kiss_fft_scalar> m_input;
+    QVector<kiss_fft_cpx> m_spec;
+    QVector<kiss_fft_cpx> m_specTime;
+    QVector<kiss_fft_cpx> m_specDeriv;
+    QVector<double> m_energy; // Накопленная энергия до извлечения корня
+};
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+// Кэш результатов анализа с адресацией по содержимому: ключ - SHA-256
+// данных файла вместе с версией анализа, поэтому копия файла под другим
+// именем тоже попадает в кэш, а изменённый файл - нет. Два уровня: в
+// памяти (QCache с пределом по байтам) и на диске (<каталог>/ab/<ключ>.json,
+// запись через QSaveFile). Чтобы не хешировать файл на каждый запрос,
+// ключ запоминается по пути, размеру и времени изменения. Потокобезопасен.
+class ResultCache
+{
+    Q_DECLARE_TR_FUNCTIONS(ResultCache)
+
+public:
+    struct Stats
+    {
+        qint64 memoryHits = 0;
+        qint64 diskHits = 0;
+        qint64 misses = 0;
+        qint64 hashedBytes = 0; // Прочитано для расчёта ключей
+        int memoryEntries = 0;
+        qint64 memoryBytes = 0;
+    };
+
+    ResultCache(const QString &directory, qint64 memoryLimitBytes);
+
+    // Ключ содержимого файла; version отделяет результаты разных версий анализа
+    QString keyFor(const QString &filePath, int version, QString &errorString);
+
+    // Пустой массив - промах
+    QByteArray find(const QString &key);
+    void insert(const QString &key, const QByteArray &value);
+
+    Stats stats() const;
+    QString directory() const { return m_directory; }
+
+private:
+    static constexpr qint64 hashChunk = 1 << 20;
+    static constexpr int maxFingerprints = 100000;
+
+    struct Fingerprint
+    {
+        qint64 size = 0;
+        QDateTime modified;
+        QString key;
+    };
+
+    const QString m_directory;
+    mutable QMutex m_mutex;
+    QCache<QString, QByteArray> m_memory; // Стоимость - размер в байтах
+    QHash<QString, Fingerprint> m_fingerprints;
+    Stats m_stats;
+
+    QString pathFor(const QString &key) const;
+};
+
+#endif
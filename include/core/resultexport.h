@@ -0,0 +1,50 @@
+#pragma once
+#ifndef RESULTEXPORT_H
+#define RESULTEXPORT_H
+
+#include "audiomodel.h"
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+// Экспорт результатов анализа в файлы. Формат выбирается по расширению:
+// небольшие результаты - CSV (.csv) или JSON Lines (.jsonl), матрицы -
+// NPY (.npy) или "AFSG" float32 (.f32, как при экспорте из GUI). Всё
+// пишется потоково через BufferedWriter и QSaveFile: файл появляется
+// только целиком, а спектрограмма считается полосами и в памяти целиком
+// не собирается. Функции можно вызывать из любого потока.
+namespace ResultExport {
+
+enum class Format { Csv, JsonLines, Npy, RawFloat };
+
+Format formatForFile(const QString &filePath);
+
+// Одна запись: файл-источник и метаданные
+bool writeMetadata(const QString &filePath,
+                   const QString &sourceFile,
+                   const AudioModel::Meta &meta,
+                   QString &errorString);
+
+// Строки частота, Гц - уровень, дБ (CSV/JSONL)
+bool writeSpectrum(const QString &filePath,
+                   const QVector<double> &frequencies,
+                   const QVector<double> &db,
+                   QString &errorString);
+
+// Кадры x бины в дБ (NPY/f32) по параметрам SpectrogramCache; cancel
+// проверяется между полосами
+bool writeSpectrogram(const QString &filePath,
+                      const QVector<double> &samples,
+                      int hop,
+                      QString &errorString,
+                      const std::atomic_bool *cancel = nullptr);
+
+// Покадровый ряд AudioFeatures (CSV/JSONL)
+bool writeFeatureSeries(const QString &filePath,
+                        const QVector<double> &samples,
+                        quint32 sampleRate,
+                        QString &errorString);
+
+} // namespace ResultExport
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#ifndef SIMDREDUCE_H
+#define SIMDREDUCE_H
+
+#include <QtGlobal>
+
+// Векторные ядра свёртки блока сэмплов в мин/макс/сумму квадратов (для
+// осциллограммы, пирамиды и измерителя уровня). Реализация AVX2 или SSE2
+// выбирается при запуске по возможностям процессора, иначе - скалярная.
+namespace SimdReduce {
+
+enum class Kernel { Scalar, Sse2, Avx2 };
+
+struct Result
+{
+    float min = 0.0f;
+    float max = 0.0f;
+    double sumSquares = 0.0;
+};
+
+// Лучшее ядро, доступное на текущем процессоре
+Kernel bestKernel();
+bool isSupported(Kernel kernel);
+const char *kernelName(Kernel kernel);
+
+// Сэмплы int16 приводятся к диапазону [-1, 1) (деление на 32768)
+Result reduce(const float *data, qsizetype count, Kernel kernel = bestKernel());
+Result reduce(const double *data, qsizetype count, Kernel kernel = bestKernel());
+Result reduce(const qint16 *data, qsizetype count, Kernel kernel = bestKernel());
+
+} // namespace SimdReduce
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef SPECTROGRAMCACHE_H
+#define SPECTROGRAMCACHE_H
+
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
+
+// Ленивая спектрограмма: кадры считаются плитками только для запрошенного
+// участка, шаг между кадрами (hop) зависит от уровня детализации
+class SpectrogramCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int fftSize = 512;
+    static constexpr int binCount = fftSize / 2;
+    static constexpr int baseHop = 64;     // Шаг кадров на самом детальном уровне
+    static constexpr int tileFrames = 128; // Число кадров в одной плитке
+    static constexpr int maxLevels = 24;
+
+    // Плитка: tileFrames кадров по binCount магнитуд подряд
+    using Tile = QSharedPointer<const QVector<float>>;
+
+    // Способ расчёта кадров: обычное STFT или спектрограмма с переназначением
+    enum class Mode { Standard, Reassigned };
+
+    explicit SpectrogramCache(QObject *parent = nullptr);
+    ~SpectrogramCache() override;
+
+    void setSamples(const QVector<double> &samples, quint32 sampleRate);
+    void clear();
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+    qint64 sampleCount() const;
+    quint32 sampleRate() const;
+    int levelCount() const;
+
+    static qint64 hopForLevel(int level) { return qint64(baseHop) << level; }
+    qint64 frameCount(int level) const;
+
+    // Самый грубый уровень, шаг которого не превышает samplesPerColumn
+    int levelForResolution(double samplesPerColumn) const;
+
+    // Готовая плитка или пустой указатель, если она ещё не рассчитана
+    Tile tile(int level, qint64 tileIndex);
+
+    // Постановка в очередь плиток для кадров [firstFrame, lastFrame] и
+    // фоновая подгрузка соседних участков той же ширины
+    void requestFrames(int level, qint64 firstFrame, qint64 lastFrame, bool prefetch = true);
+
+    // Число кадров и их расчёт без кэширования (используется и при экспорте)
+    static qint64 frameCountFor(qint64 sampleCount, qint64 hop);
+    static void computeFrames(const QVector<double> &samples,
+                              Mode mode,
+                              qint64 hop,
+                              qint64 firstFrame,
+                              int frameCount,
+                              float *out);
+
+    static quint64 tileKey(Mode mode, int level, qint64 tileIndex)
+    {
+        return (quint64(mode) << 62) | (quint64(level) << 56) | quint64(tileIndex);
+    }
+
+signals:
+    void samplesChanged();
+    void modeChanged();
+    void tileReady(int level, qint64 tileIndex);
+
+private:
+    void scheduleTile(int level, qint64 tileIndex, int priority);
+    static QVector<float> computeTile(const QVector<double> &samples,
+                                      Mode mode,
+                                      int level,
+                                      qint64 tileIndex);
+
+    QVector<double> m_samples;
+    quint32 m_sampleRate = 0;
+    int m_levelCount = 0;
+    Mode m_mode = Mode::Standard;
+    quint64 m_generation = 0; // Увеличивается при смене данных
+
+    mutable QMutex m_mutex;
+    QCache<quint64, Tile> m_tiles; // Стоимость плитки = размер в байтах
+    QSet<quint64> m_pending;       // Плитки в очереди
+    QSet<quint64> m_running;       // Плитки, которые считаются прямо сейчас
+    QThreadPool m_pool;
+};
+
+#endif
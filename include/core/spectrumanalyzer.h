@@ -0,0 +1,86 @@
+#pragma once
+#ifndef SPECTRUMANALYZER_H
+#define SPECTRUMANALYZER_H
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+#include "triplebuffer.h"
+
+class QThread;
+
+// Спектр в реальном времени в отдельном потоке. Сэмплы забираются из
+// кольцевого буфера одного писателя (отвод движка воспроизведения), план
+// FFT создаётся один раз на поток, а результат публикуется через тройной
+// буфер, который вид читает прямо при отрисовке.
+class SpectrumAnalyzer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Frame
+    {
+        QVector<float> magnitudesDb; // binCount значений, 20*log10|X|
+        quint32 sampleRate = 0;
+        quint64 sequence = 0; // Номер кадра, растёт с каждой публикацией
+    };
+
+    // Чтение до count сэмплов из кольцевого буфера; вызывается потоком анализа
+    using Reader = std::function<qsizetype(float *dst, qsizetype count)>;
+
+    static constexpr int fftSize = 2048;
+    static constexpr int binCount = fftSize / 2;
+
+    explicit SpectrumAnalyzer(QObject *parent = nullptr);
+    ~SpectrumAnalyzer() override;
+
+    // Источник сэмплов; меняется только при остановленном анализе
+    void setReader(Reader reader);
+
+    void setSampleRate(quint32 sampleRate) { m_sampleRate = sampleRate; }
+
+    // Задержка устройства: окно заканчивается на столько сэмплов раньше
+    // последнего прочитанного, чтобы совпадать со звучащим
+    void setLatencyFrames(qint64 frames) { m_latency = qMax<qint64>(0, frames); }
+
+    // Сбросить накопленную историю (после перемотки)
+    void reset() { m_resetRequested = true; }
+
+    void start();
+    void stop();
+    bool isRunning() const { return m_thread != nullptr; }
+
+    // Для потока GUI: забрать последний кадр (false - нового нет) и прочитать его.
+    // Ссылка действительна до следующего takeFrame().
+    bool takeFrame();
+    const Frame &frame() const { return m_output.readBuffer(); }
+
+signals:
+    // Есть новый кадр; повторно не приходит, пока кадр не забран
+    void frameReady();
+
+private:
+    static constexpr int historySize = 1 << 15; // Степень двойки: окно + запас на задержку
+    static constexpr int readChunk = 4096;
+    static constexpr int idleWaitMs = 2;
+
+    Reader m_reader;
+    std::atomic<quint32> m_sampleRate{0};
+    std::atomic<qint64> m_latency{0};
+    std::atomic_bool m_resetRequested{false};
+    std::atomic_bool m_running{false};
+    std::atomic_bool m_notifyPending{false};
+
+    QThread *m_thread = nullptr;
+    QMutex m_waitMutex;
+    QWaitCondition m_wake;
+
+    TripleBuffer<Frame> m_output;
+
+    void run();
+};
+
+#endif
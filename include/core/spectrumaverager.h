@@ -0,0 +1,65 @@
+#pragma once
+#ifndef SPECTRUMAVERAGER_H
+#define SPECTRUMAVERAGER_H
+
+#include <QVector>
+
+// Усреднение и удержание пиков спектра в дБ: экспоненциальное с постоянной
+// времени, линейное по последним N кадрам и максимум с затуханием. Всё
+// считается на месте над массивами float векторными ядрами (SSE2/AVX2 по
+// возможностям процессора, как в SimdReduce).
+class SpectrumAverager
+{
+public:
+    enum class Mode { Off, Exponential, Linear };
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+
+    // Экспоненциальное: за timeConstant секунд среднее проходит 63% скачка
+    void setTimeConstant(double seconds);
+    double timeConstant() const { return m_timeConstant; }
+
+    // Линейное: среднее последних frames кадров
+    void setLinearCount(int frames);
+    int linearCount() const { return m_linearCount; }
+
+    // Пик: максимум кадров, опускающийся на decay дБ в секунду
+    void setPeakHold(bool enabled);
+    bool peakHold() const { return m_peakHold; }
+    void setPeakDecay(double dbPerSecond);
+    double peakDecay() const { return m_peakDecay; }
+
+    void reset();
+
+    // Новый кадр; dtSeconds - время с предыдущего. Смена числа полос - сброс.
+    void add(const float *db, int count, double dtSeconds);
+
+    int binCount() const { return m_current.size(); }
+    const QVector<float> &current() const { return m_current; }
+    const QVector<float> &average() const { return m_average; }
+    const QVector<float> &peak() const { return m_peak; }
+    bool hasAverage() const { return m_mode != Mode::Off && !m_average.isEmpty(); }
+    bool hasPeak() const { return m_peakHold && !m_peak.isEmpty(); }
+
+private:
+    Mode m_mode = Mode::Off;
+    double m_timeConstant = 0.5;
+    int m_linearCount = 16;
+    bool m_peakHold = false;
+    double m_peakDecay = 20.0;
+
+    QVector<float> m_current;
+    QVector<float> m_average;
+    QVector<float> m_peak;
+
+    // Линейное среднее: кольцо последних кадров и их сумма
+    QVector<float> m_history;
+    QVector<float> m_sum;
+    int m_historyFill = 0;
+    int m_historyIndex = 0;
+
+    void addLinear(const float *db, int count);
+};
+
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+#ifndef SPECTRUMTRACK_H
+#define SPECTRUMTRACK_H
+
+#include <QObject>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include "spectrumanalyzer.h"
+
+// Дорожка спектра, рассчитанная заранее с фиксированным шагом (10 мс) для
+// всего файла. Кадры те же, что у живого анализатора (окно заканчивается на
+// звучащем сэмпле), но хранятся квантованными в байт, поэтому спектр для
+// позиции воспроизведения или перемотки - это поиск по индексу, а не FFT.
+// Расчёт идёт в фоне блоками; готовые блоки доступны сразу.
+class SpectrumTrack : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int fftSize = SpectrumAnalyzer::fftSize;
+    static constexpr int binCount = SpectrumAnalyzer::binCount;
+    static constexpr int hopMs = 10;
+    static constexpr int blockFrames = 256; // Кадров в одной фоновой задаче
+
+    // Диапазон квантования: 256 уровней по ~0.8 дБ
+    static constexpr float minDb = -120.0f;
+    static constexpr float maxDb = 80.0f;
+
+    explicit SpectrumTrack(QObject *parent = nullptr);
+    ~SpectrumTrack() override;
+
+    // Начать расчёт для новых сэмплов; прежняя дорожка отбрасывается
+    void setSamples(const QVector<double> &samples, quint32 sampleRate);
+    void clear();
+
+    quint32 sampleRate() const;
+    qint64 hop() const;
+    qint64 frameCount() const;
+    bool isComplete() const;
+    qint64 memoryBytes() const;
+
+    // Спектр (binCount значений в дБ) для сэмпла sample: кадр по индексу и,
+    // если interpolate, линейная интерполяция с соседним. false - блок
+    // ещё не рассчитан или дорожки нет.
+    bool lookup(qint64 sample, float *magnitudesDb, bool interpolate = true) const;
+
+signals:
+    void progress(int blocksDone, int blocks);
+    void completed();
+
+private:
+    // Общие с фоновыми задачами данные; задачи держат свою ссылку, поэтому
+    // смена дорожки не ждёт их окончания, а только выставляет cancelled
+    struct Storage
+    {
+        QVector<double> samples;
+        quint32 sampleRate = 0;
+        qint64 hop = 0;
+        qint64 frames = 0;
+        int blocks = 0;
+        std::unique_ptr<quint8[]> data; // frames * binCount уровней
+        std::unique_ptr<std::atomic_bool[]> blockReady;
+        std::atomic_int blocksDone{0};
+        std::atomic_bool cancelled{false};
+    };
+
+    QSharedPointer<Storage> m_storage;
+    QThreadPool m_pool;
+
+    static void computeBlock(Storage &storage, int block);
+    const quint8 *frameData(qint64 frame) const;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+
+// Кольцевой буфер без блокировок для одного писателя и одного читателя
+// (например, аудиопоток -> поток анализа). Ёмкость округляется до степени
+// двойки. write() вызывается только писателем, read()/clear() - только читателем.
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(qsizetype capacity)
+    {
+        qsizetype size = 1;
+        while (size < capacity)
+            size <<= 1;
+        m_data.resize(size);
+        m_mask = size - 1;
+    }
+
+    qsizetype capacity() const { return m_data.size(); }
+
+    // Сколько элементов можно прочитать / записать прямо сейчас
+    qsizetype readAvailable() const
+    {
+        return qsizetype(m_head.load(std::memory_order_acquire)
+                         - m_tail.load(std::memory_order_relaxed));
+    }
+    qsizetype writeAvailable() const
+    {
+        return capacity()
+               - qsizetype(m_head.load(std::memory_order_relaxed)
+                           - m_tail.load(std::memory_order_acquire));
+    }
+
+    // Запись до count элементов; при нехватке места лишнее отбрасывается
+    qsizetype write(const T *src, qsizetype count)
+    {
+        const quint64 head = m_head.load(std::memory_order_relaxed);
+        const quint64 tail = m_tail.load(std::memory_order_acquire);
+        const qsizetype n = qMin(count, capacity() - qsizetype(head - tail));
+        copyIn(head, src, n);
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Чтение до count элементов
+    qsizetype read(T *dst, qsizetype count)
+    {
+        const quint64 tail = m_tail.load(std::memory_order_relaxed);
+        const quint64 head = m_head.load(std::memory_order_acquire);
+        const qsizetype n = qMin(count, qsizetype(head - tail));
+        copyOut(tail, dst, n);
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    // Отбросить всё непрочитанное (со стороны читателя)
+    void clear() { m_tail.store(m_head.load(std::memory_order_acquire), std::memory_order_release); }
+
+private:
+    void copyIn(quint64 position, const T *src, qsizetype count)
+    {
+        const qsizetype offset = qsizetype(position & m_mask);
+        const qsizetype first = qMin(count, capacity() - offset);
+        std::copy(src, src + first, m_data.data() + offset);
+        std::copy(src + first, src + count, m_data.data());
+    }
+
+    void copyOut(quint64 position, T *dst, qsizetype count) const
+    {
+        const qsizetype offset = qsizetype(position & m_mask);
+        const qsizetype first = qMin(count, capacity() - offset);
+        std::copy(m_data.constData() + offset, m_data.constData() + offset + first, dst);
+        std::copy(m_data.constData(), m_data.constData() + (count - first), dst + first);
+    }
+
+    QVector<T> m_data;
+    quint64 m_mask = 0;
+
+    // Счётчики растут монотонно, позиция в буфере - по маске
+    alignas(64) std::atomic<quint64> m_head{0}; // Пишет только писатель
+    alignas(64) std::atomic<quint64> m_tail{0}; // Пишет только читатель
+};
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef STREAMINGSTFT_H
+#define STREAMINGSTFT_H
+
+#include <QVector>
+#include <functional>
+
+extern "C" {
+#include <kiss_fftr.h>
+}
+
+// Оконное преобразование Фурье для потока: сэмплы приходят блоками любой
+// длины, кадр (окно Ханна fftSize, шаг hop) считается, как только для него
+// набралось данных. Номер кадра - номер сэмпла сразу после конца окна.
+class StreamingStft
+{
+public:
+    // magnitudes - binCount() линейных магнитуд |X|
+    using FrameHandler = std::function<void(const float *magnitudes, qint64 endSample)>;
+
+    StreamingStft(int fftSize, int hop);
+    ~StreamingStft();
+
+    StreamingStft(const StreamingStft &) = delete;
+    StreamingStft &operator=(const StreamingStft &) = delete;
+
+    int fftSize() const { return m_fftSize; }
+    int hop() const { return m_hop; }
+    int binCount() const { return m_fftSize / 2; }
+
+    // Сэмплов принято (с учётом пропущенных)
+    qint64 position() const { return m_position; }
+
+    // Возвращает число посчитанных кадров
+    int push(const float *samples, qsizetype count, const FrameHandler &onFrame);
+
+    // Разрыв потока: skipped сэмплов пропущено, начатое окно отбрасывается
+    void skip(qint64 skipped);
+
+private:
+    int m_fftSize;
+    int m_hop;
+    kiss_fftr_cfg m_cfg = nullptr;
+
+    QVector<float> m_window;
+    QVector<float> m_buffer; // Последние fftSize сэмплов
+    int m_fill = 0;
+    qint64 m_position = 0;
+
+    QVector<kiss_fft_scalar> m_input;
+    QVector<kiss_fft_cpx> m_spectrum;
+    QVector<float> m_magnitudes;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Тройной буфер без блокировок для одного писателя и одного читателя:
+// писатель заполняет свой слот и публикует его, читатель забирает последний
+// опубликованный. Ни одна сторона не ждёт другую, промежуточные кадры,
+// которые читатель не успел забрать, пропускаются.
+template<typename T>
+class TripleBuffer
+{
+public:
+    // Слот писателя; после заполнения - publish()
+    T &writeBuffer() { return m_slots[m_write]; }
+
+    void publish()
+    {
+        const int previous = m_shared.exchange(m_write | freshBit, std::memory_order_acq_rel);
+        m_write = previous & indexMask;
+    }
+
+    // Забрать последний опубликованный кадр; false - нового нет
+    bool update()
+    {
+        if (!(m_shared.load(std::memory_order_acquire) & freshBit))
+            return false;
+        const int previous = m_shared.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & indexMask;
+        return true;
+    }
+
+    bool hasFresh() const { return m_shared.load(std::memory_order_acquire) & freshBit; }
+
+    // Слот читателя: последний забранный кадр
+    const T &readBuffer() const { return m_slots[m_read]; }
+
+    // Начальная настройка всех слотов (до запуска писателя)
+    template<typename Fn>
+    void initialize(Fn fn)
+    {
+        for (T &slot : m_slots)
+            fn(slot);
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    T m_slots[3];
+    int m_write = 0;                 // Только писатель
+    int m_read = 1;                  // Только читатель
+    std::atomic<int> m_shared{2};    // Обменный слот и признак свежести
+};
+
+#endif
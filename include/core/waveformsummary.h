@@ -0,0 +1,56 @@
+#pragma once
+#ifndef WAVEFORMSUMMARY_H
+#define WAVEFORMSUMMARY_H
+
+#include <QVector>
+
+// Многоуровневая сводка сигнала (пирамида мин/макс/RMS) для быстрой отрисовки:
+// блоки по 64, 512, 4096... сэмплов, каждый уровень в 8 раз грубее предыдущего.
+// Строится один раз при загрузке, запрос диапазона не зависит от его длины.
+class WaveformSummary
+{
+public:
+    struct Bucket
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+        double sumSquares = 0.0;
+        qint64 count = 0;
+
+        double rms() const;
+        void merge(const Bucket &other);
+    };
+
+    static constexpr int baseBlock = 64;
+    static constexpr int levelFactor = 8;
+
+    void build(const QVector<double> &samples);
+    void clear();
+
+    bool isEmpty() const { return m_samples.isEmpty(); }
+    qint64 sampleCount() const { return m_samples.size(); }
+    int levelCount() const { return m_levels.size(); }
+
+    // Мин/макс/RMS сэмплов [begin, end)
+    Bucket range(qint64 begin, qint64 end) const;
+
+    // Исходные сэмплы для отрисовки при сильном приближении
+    const QVector<double> &samples() const { return m_samples; }
+
+private:
+    struct Block
+    {
+        float min;
+        float max;
+        float sumSquares;
+    };
+
+    static qint64 blockSize(int level);
+    Bucket rangeAtLevel(int level, qint64 begin, qint64 end) const;
+    Bucket scanSamples(qint64 begin, qint64 end) const;
+
+    QVector<double> m_samples; // Неявно разделяется с исходным буфером
+    QVector<QVector<Block>> m_levels;
+};
+
+#endif
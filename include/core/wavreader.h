@@ -0,0 +1,56 @@
+#pragma once
+#ifndef WAVREADER_H
+#define WAVREADER_H
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+
+// Чтение WAV (PCM 8/16 бит) блоками: разбор заголовка отдельно от данных,
+// чтение произвольного диапазона кадров и перевод сырых байт в сэмплы
+// double [-1, 1). Используется загрузкой файла в AudioModel и конвейером
+// пакетной обработки.
+class WavReader
+{
+    Q_DECLARE_TR_FUNCTIONS(WavReader)
+
+public:
+    struct Format
+    {
+        quint16 audioFormat = 0;
+        quint16 channels = 0;
+        quint32 sampleRate = 0;
+        quint32 byteRate = 0;
+        quint16 blockAlign = 0;
+        quint16 bitsPerSample = 0;
+        qint64 dataOffset = 0; // Начало чанка data в файле
+        quint32 dataSize = 0;  // Размер по заголовку (файл может быть короче)
+
+        qint64 frameBytes() const { return qint64(channels) * (bitsPerSample / 8); }
+        qint64 frameCount() const { return frameBytes() > 0 ? dataSize / frameBytes() : 0; }
+    };
+
+    // Разбор RIFF/WAVE, чанков fmt и data; поддерживается только PCM
+    bool open(const QString &filePath, QString &errorString);
+    void close() { m_file.close(); }
+
+    const Format &format() const { return m_format; }
+
+    // Сырые байты кадров [firstFrame, firstFrame + count); у обрезанного
+    // файла может вернуть меньше
+    QByteArray readFrames(qint64 firstFrame, qint64 count);
+
+    // Перевод frames кадров: mono - среднее по каналам, channels (если не
+    // nullptr) - по отдельности. Неподдерживаемая битность даёт нули.
+    static void decode(const char *raw,
+                       qint64 frames,
+                       const Format &format,
+                       double *mono,
+                       double *const *channels = nullptr);
+
+private:
+    QFile m_file;
+    Format m_format;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointer>
+#include <QRegion>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+class QWidget;
+class QWindow;
+
+// Единый такт обновления живых видов, привязанный к обновлению экрана
+// (QWindow::requestUpdate). Запросы перерисовки копятся до ближайшего кадра
+// и выполняются одним update() на виджет; анимации на каждом кадре берут
+// последнее состояние (позицию, готовый спектр), промежуточные пропускаются.
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        int frames = 0;              // Кадров за интервал отчёта
+        double fps = 0.0;
+        double meanIntervalMs = 0.0; // Между соседними кадрами
+        double maxIntervalMs = 0.0;
+        double meanWorkMs = 0.0;     // Время обработки кадра
+        int lateFrames = 0;          // Интервал больше полутора периодов экрана
+    };
+
+    // Кадры синхронизируются с окном верхнего уровня window
+    explicit FrameScheduler(QWidget *window, QObject *parent = nullptr);
+
+    // Перерисовать виджет (или его область) на ближайшем кадре
+    void schedule(QWidget *widget, const QRect &rect = QRect());
+
+    // Вызывается на каждом кадре, пока возвращает true
+    using Animation = std::function<bool()>;
+    void addAnimation(QObject *owner, Animation animation);
+
+    static constexpr int statsIntervalMs = 1000;
+
+signals:
+    void statsUpdated(const FrameScheduler::Stats &stats);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Entry
+    {
+        QPointer<QObject> owner;
+        Animation animation;
+    };
+
+    QWidget *m_widget;
+    QPointer<QWindow> m_window;
+    bool m_frameRequested = false;
+
+    struct Dirty
+    {
+        QPointer<QWidget> widget;
+        QRegion region;
+        bool whole = false;
+    };
+
+    QVector<Dirty> m_dirty; // Виджетов единицы, линейный поиск дешевле хеша
+    QVector<Entry> m_animations;
+
+    // Без окна (ещё не показано) кадры идут по таймеру
+    QTimer m_fallbackTimer;
+
+    QElapsedTimer m_clock;
+    qint64 m_lastFrameNs = -1;
+    qint64 m_statsStartNs = 0;
+    Stats m_accum;
+    double m_intervalSumMs = 0.0;
+    double m_workSumMs = 0.0;
+
+    void requestFrame();
+    void runFrame();
+    double refreshIntervalMs() const;
+};
+
+#endif
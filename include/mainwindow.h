@@ -3,19 +3,28 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
-#include <QAudioOutput>
 #include <QLabel>
 #include <QMainWindow>
-#include <QMediaPlayer>
+#include <QSharedPointer>
 #include <QSlider>
 #include <QString>
+#include <QThreadPool>
 
 #include <QStyle>
 #include <QToolButton>
 #include "audiomodel.h"
+#include "framescheduler.h"
+#include "inputsource.h"
+#include "liveanalyzer.h"
+#include "playbackengine.h"
+#include "spectrogramexporter.h"
 #include "spectrogramview.h"
+#include "spectrumanalyzer.h"
+#include "spectrumtrack.h"
 #include "spectrumview.h"
+#include "timeviewport.h"
 #include "waveformview.h"
+#include <atomic>
 
 class MainWindow : public QMainWindow
 {
@@ -29,6 +38,10 @@ private slots:
 
     void onOpenFile();
 
+    void onExportSpectrogram();
+
+    void onExportResults();
+
     void onMetadataReady(const AudioModel::Meta &meta);
 
     void onWaveformReady(const QVector<double> &samples, quint32 sampleRate);
@@ -39,14 +52,22 @@ private slots:
 
     void onError(const QString &err);
 
-    void onPositionChanged(qint64 pos);
+    void onPositionChanged(qint64 sample);
 
 private:
     AudioModel *m_model;
 
-    QMediaPlayer *m_player;
-    QAudioOutput *m_audioOutput;
-
+    PlaybackEngine *m_engine;     // Воспроизведение с отводом для анализа
+    SpectrumAnalyzer *m_analyzer; // Живой спектр в отдельном потоке
+    SpectrumTrack *m_track;       // Спектр всего файла с шагом 10 мс
+    QAction *m_trackAct;
+    LiveAnalyzer *m_live;         // Анализ живого входа
+    InputSource *m_input = nullptr;
+    QVector<double> m_liveFrequencies;
+    FrameScheduler *m_frames;     // Такт перерисовки по обновлению экрана
+    bool m_followingPlayback = false;
+
+    TimeViewport *m_viewport;
     WaveformView *m_waveform;
     SpectrogramView *m_spectrogram;
 
@@ -61,8 +82,26 @@ private:
     SpectrumView *m_spectrum;
     QVector<double> m_samples;
     quint32 m_sampleRate = 0;
-    qint64 m_lastSpectrumUpdate = 0;
-    const qint64 SPECTRUM_UPDATE_INTERVAL_MS = 50;
+
+    // Для экспорта результатов
+    QString m_filePath;
+    AudioModel::Meta m_meta;
+    QString m_metadataText; // Строка метаданных файла без живой громкости
+
+    // Фоновый экспорт: свой пул, чтобы окно при закрытии дождалось задач
+    QThreadPool m_exportPool;
+    QList<QSharedPointer<SpectrogramExporter>> m_exporters;
+    QList<QSharedPointer<std::atomic_bool>> m_exportCancels; // Экспорт результатов
+    QVector<double> m_spectrumFrequencies;
+    QVector<double> m_spectrumDb;
+
+    void seekTo(double seconds);
+    void followPlayback();
+    void updateLiveAnalysis();
+    void startLiveInput(InputSource *source);
+    void stopLiveInput();
+    void presentLiveSlices();
+    static QString formatLufs(double lufs);
 };
 
 #endif
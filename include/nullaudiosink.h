@@ -0,0 +1,61 @@
+#pragma once
+#ifndef NULLAUDIOSINK_H
+#define NULLAUDIOSINK_H
+
+#include <QAudio>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class QIODevice;
+
+// Замена QAudioSink без звукового устройства: забирает данные из источника
+// в реальном темпе по таймеру и отбрасывает их. Повторяет используемую часть
+// интерфейса QAudioSink (режим pull), нужна для проверок и машин без звука.
+class NullAudioSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NullAudioSink(const QAudioFormat &format, QObject *parent = nullptr);
+
+    void start(QIODevice *device);
+    void stop();
+    void suspend();
+    void resume();
+
+    QAudio::State state() const { return m_state; }
+    QAudioFormat format() const { return m_format; }
+
+    // Буфера нет: данные "звучат" сразу после чтения
+    qsizetype bufferSize() const { return 0; }
+    qsizetype bytesFree() const { return 0; }
+
+    void setVolume(qreal volume) { m_volume = volume; }
+    qreal volume() const { return m_volume; }
+
+    // Время отданного звука в микросекундах
+    qint64 processedUSecs() const;
+
+signals:
+    void stateChanged(QAudio::State state);
+
+private:
+    static constexpr int tickMs = 5;
+
+    QAudioFormat m_format;
+    QIODevice *m_device = nullptr;
+    QAudio::State m_state = QAudio::StoppedState;
+    qreal m_volume = 1.0;
+
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_elapsedBeforeSuspend = 0; // мс
+    qint64 m_framesPulled = 0;
+
+    void pull();
+    void setState(QAudio::State state);
+};
+
+#endif
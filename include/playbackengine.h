@@ -0,0 +1,140 @@
+#pragma once
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include <QAudio>
+#include <QAudioFormat>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "loudnessmeter.h"
+
+class QAudioSink;
+class NullAudioSink;
+class PlaybackSource;
+
+// Воспроизведение декодированного буфера через QAudioSink в режиме pull.
+// Звуковой поток сам забирает сэмплы из источника; позиция хранится в
+// сэмплах и атомарно, а моно-смесь отданных устройству сэмплов попадает
+// в отвод для анализа (кольцевой буфер без блокировок).
+class PlaybackEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class State { Stopped, Playing, Paused };
+
+    enum class Output {
+        Device, // Звуковое устройство по умолчанию
+        Null    // Без звука, в реальном темпе (NullAudioSink)
+    };
+
+    explicit PlaybackEngine(QObject *parent = nullptr);
+    ~PlaybackEngine() override;
+
+    void setOutput(Output output);
+    Output output() const { return m_output; }
+
+    // Новый источник; воспроизведение останавливается
+    void setSource(const QVector<QVector<double>> &channels, quint32 sampleRate);
+
+    qint64 sampleCount() const;
+    quint32 sampleRate() const { return m_sampleRate; }
+    State state() const { return m_state; }
+
+    // Следующий сэмпл, который будет отдан устройству; из любого потока
+    qint64 position() const;
+
+    // Сэмпл, звучащий сейчас: position() за вычетом данных в буфере
+    // устройства. Только из потока движка.
+    qint64 playbackPosition() const;
+    qint64 latencyFrames() const;
+
+    // Отвод для анализа: моно-смесь отданных устройству сэмплов.
+    // Читатель должен быть один; после seek() непрочитанное отбрасывается.
+    qsizetype readTap(float *dst, qsizetype count);
+    qsizetype tapAvailable() const;
+
+    // Громкость по EBU R128 того, что отдано устройству, с последней
+    // перемотки; обновляется раз в 100 мс. Для потока GUI: takeLoudness()
+    // забирает новое измерение (false - его нет), ссылка действительна до
+    // следующего вызова.
+    bool takeLoudness();
+    const LoudnessMeter::Result &loudness() const;
+
+    void setVolume(float volume);
+    float volume() const { return m_volume; }
+
+    // Период positionChanged во время воспроизведения; 0 - не уведомлять
+    // (позицию опрашивают сами на каждом кадре экрана)
+    void setNotifyInterval(int ms);
+
+    // Прослушивание при перемотке: пока курсор тянут, звучат короткие зёрна
+    // вокруг него через отдельное устройство с маленьким буфером. Состояние
+    // (Playing/Paused/Stopped) не меняется; после endScrub() воспроизведение,
+    // если оно шло, продолжается с последней позиции курсора.
+    bool isScrubbing() const { return m_scrubbing; }
+
+    // Скорость чтения зёрен со знаком (меньше нуля - назад); 0 вне перемотки
+    double scrubRate() const { return m_scrubbing ? m_scrubRate : 0.0; }
+
+    // Курсор стоит дольше - перемотка замолкает
+    static constexpr int scrubHoldMs = 60;
+
+public slots:
+    void play();
+    void pause();
+    void stop();
+    void seek(qint64 sample);
+
+    void beginScrub();
+    void scrubTo(qint64 sample);
+    void endScrub();
+
+signals:
+    void stateChanged(PlaybackEngine::State state);
+    // Периодически во время воспроизведения (см. setNotifyInterval) и при перемотке
+    void positionChanged(qint64 sample);
+    void finished();
+    void errorOccurred(const QString &error);
+
+private:
+    static constexpr int defaultNotifyIntervalMs = 15;
+    static constexpr int bufferMs = 20; // Буфер устройства: задержка против устойчивости
+
+    // Перемотка: зерно 16 мс с шагом 8 мс плюс буфер 10 мс - отклик на
+    // движение курсора не дольше ~20 мс
+    static constexpr int scrubBufferMs = 10;
+    static constexpr int grainMs = 16;
+    static constexpr double scrubSmoothMs = 30; // Сглаживание скорости курсора
+    static constexpr double minScrubRate = 0.25;
+    static constexpr double maxScrubRate = 4.0;
+
+    Output m_output = Output::Device;
+    quint32 m_sampleRate = 0;
+    int m_sourceChannels = 0;
+    State m_state = State::Stopped;
+    float m_volume = 1.0f;
+
+    PlaybackSource *m_source;
+    QAudioFormat m_format;
+    QAudioSink *m_sink = nullptr;
+    NullAudioSink *m_nullSink = nullptr;
+    QTimer m_notifyTimer;
+
+    bool m_scrubbing = false;
+    bool m_resumeAfterScrub = false;
+    qint64 m_scrubTarget = 0;
+    double m_scrubVelocity = 0.0; // Сэмплов в секунду, сглаженная
+    double m_scrubRate = 1.0;     // Последняя переданная источнику
+    QElapsedTimer m_scrubClock;
+
+    bool createSink(int bufferSizeMs);
+    bool startSink();
+    void destroySink();
+    void setState(State state);
+    void onSinkStateChanged(QAudio::State state);
+};
+
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef SPECTROGRAMCOLORMAP_H
+#define SPECTROGRAMCOLORMAP_H
+
+#include <QColor>
+
+// Палитра спектрограммы: магнитуда переводится в дБ и раскрашивается
+// от черного (minDb) до желтого (maxDb). Общая для вида и экспорта.
+class SpectrogramColorMap
+{
+public:
+    void setDecibelRange(double minDb, double maxDb);
+    double minDb() const { return m_minDb; }
+    double maxDb() const { return m_maxDb; }
+
+    QRgb color(double magnitude) const;
+
+private:
+    double m_minDb = -40.0;
+    double m_maxDb = 40.0;
+};
+
+#endif
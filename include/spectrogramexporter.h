@@ -0,0 +1,55 @@
+#pragma once
+#ifndef SPECTROGRAMEXPORTER_H
+#define SPECTROGRAMEXPORTER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "spectrogramcache.h"
+#include "spectrogramcolormap.h"
+
+// Экспорт спектрограммы в полном разрешении полосами: кадры считаются и сразу
+// записываются в файл, в памяти находится только одна полоса. Время идет
+// сверху вниз (строка = кадр), частота - слева направо (столбец = бин).
+class SpectrogramExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Format {
+        Png,     // RGB, без сжатия (блоки deflate типа stored)
+        Tiff,    // RGB, без сжатия, по полосам
+        RawFloat // Заголовок AFSG + матрица float32 (дБ) little-endian
+    };
+
+    explicit SpectrogramExporter(QObject *parent = nullptr);
+
+    void setSamples(const QVector<double> &samples);
+    void setMode(SpectrogramCache::Mode mode) { m_mode = mode; }
+    void setHop(qint64 hop) { m_hop = hop; }
+    void setStripFrames(int frames) { m_stripFrames = qMax(1, frames); }
+    void setColorMap(const SpectrogramColorMap &colorMap) { m_colorMap = colorMap; }
+
+    static Format formatForFile(const QString &filePath);
+
+    // Блокирующий экспорт; можно вызывать из рабочего потока
+    bool exportTo(const QString &filePath, Format format, QString &errorString);
+
+    // Прерывание экспорта из другого потока
+    void cancel() { m_cancelled = true; }
+    bool isCancelled() const { return m_cancelled; }
+
+signals:
+    void progress(int percent);
+
+private:
+    QVector<double> m_samples;
+    SpectrogramCache::Mode m_mode = SpectrogramCache::Mode::Standard;
+    qint64 m_hop = SpectrogramCache::fftSize / 2;
+    int m_stripFrames = 256;
+    SpectrogramColorMap m_colorMap;
+    std::atomic_bool m_cancelled{false};
+};
+
+#endif
@@ -6,6 +6,11 @@
 #include <QMutex>
 #include <QVector>
 #include <QWidget>
+#include "spectrogramcache.h"
+#include "spectrogramcolormap.h"
+
+class FrameScheduler;
+class TimeViewport;
 
 class SpectrogramView : public QWidget
 {
@@ -15,10 +20,29 @@ public:
     explicit SpectrogramView(QWidget *parent = nullptr);
     ~SpectrogramView() override = default;
 
+    // Источник кадров для ленивого режима (используется, если нет готовых данных)
+    void setCache(SpectrogramCache *cache);
+
+    // Общая временная ось: в ленивом режиме рисуется только видимый диапазон
+    void setViewport(TimeViewport *viewport);
+
+    // Общий такт перерисовки (без него - обычный update())
+    void setFrameScheduler(FrameScheduler *scheduler);
+
+    // Обычная или переназначенная (более резкая по времени и частоте) спектрограмма
+    void setMode(SpectrogramCache::Mode mode);
+
+    void setDecibelRange(double minDb, double maxDb);
+    const SpectrogramColorMap &colorMap() const { return m_colorMap; }
+
 public slots:
 
     void addSpectrumSlice(const QVector<double> &freqBins, const QVector<double> &magnitudes);
 
+    // Несколько срезов за раз (живой вход): изображение перестраивается один раз
+    void addSpectrumSlices(const QVector<double> &freqBins,
+                           const QVector<QVector<double>> &slices);
+
     void clear();
 
     void setSpectrogramData(const QVector<QVector<double>> &data);
@@ -26,6 +50,8 @@ public slots:
 protected:
     void paintEvent(QPaintEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
 
 private:
     QImage m_image;
@@ -36,7 +62,17 @@ private:
     QVector<QVector<double>> m_spectrogramData;
     QMutex m_mutex;
 
+    SpectrogramCache *m_cache = nullptr;
+    TimeViewport *m_viewport = nullptr;
+    FrameScheduler *m_scheduler = nullptr;
+    SpectrogramColorMap m_colorMap;
+    bool m_refreshPending = false;
+
     void updateImage();
+    void updateLazyImage();
+    void scheduleRefresh();
+    void scheduleUpdate();
+    void scheduleUpdate(const QRect &rect);
 
     QColor magnitudeToColor(double magnitude) const;
 };
@@ -2,12 +2,20 @@
 #ifndef SPECTRUMVIEW_H
 #define SPECTRUMVIEW_H
 
+#include <QElapsedTimer>
 #include <QLinearGradient>
 #include <QMutex>
+#include <QPixmap>
 #include <QPoint>
 #include <QRubberBand>
 #include <QVector>
 #include <QWidget>
+#include "spectrumaverager.h"
+
+class FrameScheduler;
+class QPainterPath;
+class SpectrumAnalyzer;
+class SpectrumTrack;
 
 class SpectrumView : public QWidget
 {
@@ -19,6 +27,28 @@ public:
     void setFrequencyRange(double minFreq, double maxFreq);
     void setDecibelRange(double minDB, double maxDB);
 
+    // Живой спектр: последний кадр анализатора забирается при отрисовке
+    void setAnalyzer(SpectrumAnalyzer *analyzer);
+
+    // Заранее рассчитанная дорожка: пока задана позиция (sample >= 0) и её
+    // кадр готов, спектр берётся из дорожки, иначе - из анализатора
+    void setTrack(const SpectrumTrack *track);
+    void setTrackPosition(qint64 sample);
+
+    // Общий такт перерисовки (без него - обычный update())
+    void setFrameScheduler(FrameScheduler *scheduler);
+
+    // Усреднение и удержание пиков; среднее и пик рисуются отдельными
+    // линиями поверх текущего спектра
+    void setAveraging(SpectrumAverager::Mode mode);
+    SpectrumAverager::Mode averaging() const { return m_averager.mode(); }
+    void setAveragingTimeConstant(double seconds);
+    void setAveragingCount(int frames);
+    void setPeakHold(bool enabled);
+    bool peakHold() const { return m_averager.peakHold(); }
+    void setPeakDecay(double dbPerSecond);
+    void resetAveraging();
+
 public slots:
     void setSpectrumData(const QVector<double> &frequencies, const QVector<double> &magnitudes);
     void clear();
@@ -31,16 +61,20 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void wheelEvent(QWheelEvent *event) override;
+    void leaveEvent(QEvent *event) override;
 
 private:
-    struct SpectrumPoint
-    {
-        double frequency;
-        double magnitude;
-    };
-
-    QVector<SpectrumPoint> m_spectrumData;
+    // Частоты полос и кадры в дБ: текущий, среднее, пик
+    QVector<double> m_frequencies;
+    SpectrumAverager m_averager;
+    QElapsedTimer m_frameClock; // Время между кадрами для усреднения и затухания
+    QVector<float> m_frameDb;
     QMutex m_mutex;
+    SpectrumAnalyzer *m_analyzer = nullptr;
+    const SpectrumTrack *m_track = nullptr;
+    qint64 m_trackPosition = -1;
+    qint64 m_trackFedPosition = -1; // Позиция дорожки, уже переданная в усреднение
+    FrameScheduler *m_scheduler = nullptr;
 
     double m_minFrequency = 20.0;
     double m_maxFrequency = 20000.0;
@@ -51,6 +85,8 @@ private:
 
     QLinearGradient m_spectrumGradient;
     QColor m_lineColor = QColor(138, 43, 226);
+    QColor m_averageColor = QColor(255, 252, 242);
+    QColor m_peakColor = QColor(255, 165, 0);
 
     QPoint m_zoomStart;
     QPoint m_zoomEnd;
@@ -58,9 +94,29 @@ private:
     bool m_isPanning = false;
     QPoint m_lastPanPoint;
 
+    // Сетка, спектр и подписи диапазона кэшируются в статическом слое;
+    // отсчёт под курсором рисуется поверх и обновляет только свой прямоугольник
+    QPixmap m_staticLayer;
+    bool m_staticDirty = true;
+    QPoint m_cursorPos;
+    bool m_cursorInside = false;
+
+    void invalidateStaticLayer();
+    void scheduleUpdate();
+    void scheduleUpdate(const QRect &rect);
+    void takeAnalyzerFrame();
+    bool takeTrackFrame();
+    void pushFrame(const float *db, int count, double binWidth);
+    QPainterPath tracePath(const QVector<float> &values) const;
+    void renderStaticLayer();
+    QString readoutText() const;
+    QRect readoutRect() const;
+    void setCursorPos(const QPoint &pos, bool inside);
+
     void drawGrid(QPainter &painter);
     void drawSpectrum(QPainter &painter);
     void drawLabels(QPainter &painter);
+    void drawReadout(QPainter &painter);
     void applyZoom(const QRect &zoomRect);
     QPointF dataToPoint(double freq, double mag) const;
     QPointF pointToData(const QPoint &point) const;
@@ -0,0 +1,61 @@
+#pragma once
+#ifndef TIMEVIEWPORT_H
+#define TIMEVIEWPORT_H
+
+#include <QObject>
+
+// Общая временная ось для видов: видимый диапазон сэмплов и маркер воспроизведения
+class TimeViewport : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TimeViewport(QObject *parent = nullptr);
+
+    // Наибольшее приближение: столько сэмплов на всю ширину вида,
+    // независимо от длины файла
+    static constexpr double minimumSpan = 16.0;
+
+    // Новый источник: диапазон сбрасывается на весь файл, маркер - в начало
+    void setSource(qint64 totalSamples, quint32 sampleRate);
+
+    qint64 totalSamples() const { return m_totalSamples; }
+    quint32 sampleRate() const { return m_sampleRate; }
+    bool isEmpty() const { return m_totalSamples <= 0 || m_sampleRate == 0; }
+
+    double startSample() const { return m_start; }
+    double visibleSamples() const { return m_span; }
+    double endSample() const { return m_start + m_span; }
+    double minVisibleSamples() const { return m_minSpan; }
+
+    // Перевод между координатой X виджета заданной ширины и позицией в сэмплах
+    double sampleAt(double x, int width) const;
+    double xForSample(double sample, int width) const;
+
+    double markerSeconds() const { return m_markerSec; }
+
+public slots:
+    void setRange(double startSample, double visibleSamples);
+    void scrollTo(double startSample);
+
+    // Масштабирование с сохранением позиции anchorSample под курсором
+    void zoomAt(double anchorSample, double factor);
+
+    void setMarkerSeconds(double seconds);
+
+signals:
+    void rangeChanged();
+    void markerChanged(double seconds);
+
+private:
+    qint64 m_totalSamples = 0;
+    quint32 m_sampleRate = 0;
+
+    double m_start = 0.0;
+    double m_span = 0.0;
+    double m_minSpan = 0.0;
+
+    double m_markerSec = 0.0;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef WAVEFORMRASTERIZER_H
+#define WAVEFORMRASTERIZER_H
+
+#include <QImage>
+#include <QRect>
+#include "waveformsummary.h"
+
+// Прямая растеризация осциллограммы в QImage: для каждого столбца пикселей
+// вертикальные отрезки мин/макс и RMS пишутся сразу в строки изображения,
+// без построения и тесселяции QPainterPath. Когда на пиксель приходится
+// меньше сэмпла, рисуется линия, восстановленная sinc-интерполяцией
+// (окно Ланцоша), а при достаточном приближении - точки самих сэмплов.
+class WaveformRasterizer
+{
+public:
+    struct Style
+    {
+        QRgb background = qRgb(0, 0, 0);
+        QRgb fill = qRgb(0, 100, 0);   // Заливка огибающей
+        QRgb rms = qRgb(94, 197, 94);  // Полоса RMS
+        QRgb line = qRgb(0, 255, 0);   // Контур огибающей
+        QRgb sample = qRgb(255, 255, 255); // Точки отдельных сэмплов
+        bool antialiasing = true;      // Частичное покрытие краевых пикселей
+        int sampleDotRadius = 2;       // Радиус точки сэмпла в пикселях изображения
+        float gain = 1.0f;             // Вертикальный масштаб: 1 - полная шкала на высоту области
+    };
+
+    // Отрисовка столбцов [x0, x1) области area; столбец x покрывает сэмплы
+    // [startSample + x * samplesPerPixel, startSample + (x + 1) * samplesPerPixel)
+    static void render(QImage &image,
+                       const QRect &area,
+                       const WaveformSummary &summary,
+                       double startSample,
+                       double samplesPerPixel,
+                       int x0,
+                       int x1,
+                       const Style &style);
+
+    // Порядок окна Ланцоша для интерполяции между сэмплами
+    static constexpr int interpolationTaps = 8;
+
+    // Значение сигнала в дробной позиции t (в сэмплах); за границами сигнал нулевой
+    static double interpolate(const QVector<double> &samples, double t);
+};
+
+#endif
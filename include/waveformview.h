@@ -2,10 +2,21 @@
 #ifndef WAVEFORMVIEW_H
 #define WAVEFORMVIEW_H
 
-#include <QPainterPath>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
 #include <QScrollBar>
+#include <QSharedPointer>
+#include <QThreadPool>
 #include <QVector>
 #include <QWidget>
+#include <atomic>
+#include "waveformrasterizer.h"
+#include "waveformsummary.h"
+
+class FrameScheduler;
+class QPainter;
+class TimeViewport;
 
 class WaveformView : public QWidget
 {
@@ -13,16 +24,44 @@ class WaveformView : public QWidget
 
 public:
     explicit WaveformView(QWidget *parent = nullptr);
+    ~WaveformView() override;
+
+    // Общая с другими видами временная ось (по умолчанию - собственная)
+    void setViewport(TimeViewport *viewport);
+    TimeViewport *viewport() const { return m_viewport; }
+
+    // Общий такт перерисовки (без него - обычный update())
+    void setFrameScheduler(FrameScheduler *scheduler);
+
+    // Сглаживание краёв отрезков при растеризации
+    void setAntialiasing(bool enabled);
+
+    // Дорожки каналов: у каждой свой вертикальный масштаб, скрытие и соло.
+    // Если хотя бы одна дорожка в режиме соло, показываются только такие.
+    int laneCount() const { return m_lanes.size(); }
+    void setLaneVisible(int lane, bool visible);
+    bool isLaneVisible(int lane) const;
+    void setLaneSolo(int lane, bool solo);
+    bool isLaneSolo(int lane) const;
+    void setLaneGain(int lane, double gain);
+    double laneGain(int lane) const;
 
 public slots:
 
+    // Одна дорожка (моно)
     void setSamples(const QVector<double> &samples, quint32 sampleRate);
 
+    // По дорожке на канал; все каналы одной длины
+    void setChannels(const QVector<QVector<double>> &channels, quint32 sampleRate);
+
     void setMarkerPosition(double seconds);
 
 signals:
 
     void markerPositionChanged(double seconds);
+    // Маркер взят и отпущен мышью (для прослушивания при перемотке)
+    void markerDragStarted();
+    void markerDragFinished();
 
 protected:
     void paintEvent(QPaintEvent *ev) override;
@@ -35,29 +74,107 @@ protected:
 
     void mouseReleaseEvent(QMouseEvent *ev) override;
 
+    void leaveEvent(QEvent *ev) override;
+
     void wheelEvent(QWheelEvent *ev) override;
 
+    void contextMenuEvent(QContextMenuEvent *ev) override;
+
 private:
-    QVector<double> m_samples;
+    // Готовый растр дорожки и параметры, с которыми он построен
+    struct LaneFrame
+    {
+        QImage image; // В физических пикселях
+        double start = 0.0;
+        double span = 0.0;
+        float gain = 1.0f;
+        bool antialiasing = true;
+    };
+
+    struct Lane
+    {
+        // Пирамида мин/макс/RMS для отрисовки за O(ширина); разделяется с фоновыми задачами
+        QSharedPointer<const WaveformSummary> summary;
+        LaneFrame frame; // Показанный кадр (передний буфер)
+        double gain = 1.0;
+        bool visible = true;
+        bool solo = false;
+    };
+
+    QVector<Lane> m_lanes;
+    qint64 m_sampleCount = 0;
     quint32 m_sampleRate = 0;
-    double m_markerSec = 0.0;
 
-    double m_zoom = 1.0;
-    const double m_minZoom = 10.0;
-    const double m_maxZoom = 500.0;
+    TimeViewport *m_viewport = nullptr;
+    FrameScheduler *m_scheduler = nullptr;
 
     QScrollBar *m_hScroll = nullptr;
+    static constexpr int scrollSteps = 1 << 30; // Предел делений скроллбара
+    double m_scrollUnit = 0.0;                  // Сэмплов на одно деление скроллбара
     bool m_draggingMarker = false;
 
-    QPainterPath m_cachedPath;
-    int m_cachedOffset = -1;
-    QSize m_cachedSize;
+    WaveformRasterizer::Style m_style;
+
+    // Дорожки растеризуются в фоне, по задаче на дорожку. Готовые кадры копятся
+    // в заднем буфере и заменяют показанные все сразу, когда готовы все дорожки.
+    // Новый запрос увеличивает поколение, устаревшие задачи прерываются.
+    QThreadPool m_lanePool;
+    std::atomic<quint64> m_generation{0};
+    QHash<int, LaneFrame> m_backFrames;
+    int m_backRemaining = 0;
+
+    static constexpr int renderChunk = 256;            // Столбцов между проверками отмены
+    static constexpr double maxPlaceholderStretch = 64.0; // Предел растяжения прежнего кадра
+
+    static constexpr double minLaneGain = 0.25;
+    static constexpr double maxLaneGain = 64.0;
+
+    // Отображаемые дорожки с учётом скрытия и соло
+    QVector<int> shownLanes() const;
+    QRect laneRect(int position, int shownCount) const;
+    int laneAt(int y) const;
+    void invalidateLanes();
+
+    // Дорожки, подписи и фон кэшируются в статическом слое. Маркер и курсор
+    // рисуются поверх него и обновляют только занятые ими прямоугольники.
+    QPixmap m_staticLayer;
+    bool m_staticDirty = true;
+    QRect m_markerRect; // Где маркер нарисован сейчас
+    int m_cursorX = -1; // Положение курсора мыши, -1 - вне виджета
+
+    void renderStaticLayer();
+    void invalidateStaticLayer();
+    void scheduleUpdate();
+    void scheduleUpdate(const QRect &rect);
+    void drawOverlay(QPainter &p);
+    int markerX() const;
+    QString markerText() const;
+    QString cursorText() const;
+    QRect markerRect() const;
+    QRect cursorRect() const;
+    void onMarkerChanged();
+    void setCursorX(int x);
+
+    void onRangeChanged();
 
     void updateScroll();
 
     void updateMarkerFromPos(int x);
 
-    void updateCachedPath();
+    void requestRender();
+    void onLaneRendered(quint64 generation, int lane, const LaneFrame &frame);
+
+    // Растр дорожки; при прокрутке без смены масштаба переиспользует prev.
+    // Возвращает false, если запрос устарел во время работы.
+    bool renderLane(quint64 generation,
+                    const WaveformSummary &summary,
+                    const QSize &size,
+                    qreal dpr,
+                    double start,
+                    double span,
+                    const WaveformRasterizer::Style &style,
+                    const LaneFrame &prev,
+                    LaneFrame &out) const;
 };
 
 #endif
@@ -0,0 +1,150 @@
+#include "audiocapturesource.h"
+#include <QAudioSource>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <QVector>
+
+// Приёмник данных устройства: сведение в моно и запись в кольцевой буфер.
+// writeData вызывается тем потоком, в котором устройство отдаёт данные.
+class CaptureDevice : public QIODevice
+{
+public:
+    CaptureDevice(AudioCaptureSource *owner, const QAudioFormat &format)
+        : QIODevice(owner)
+        , m_owner(owner)
+        , m_format(format)
+    {}
+
+protected:
+    qint64 readData(char *, qint64) override { return -1; }
+
+    qint64 writeData(const char *data, qint64 len) override
+    {
+        const int channels = m_format.channelCount();
+        const int frameBytes = m_format.bytesPerFrame();
+        if (frameBytes <= 0)
+            return len;
+
+        // Неполный кадр на границе блока дописывается следующим вызовом
+        m_partial.append(data, len);
+        const qint64 frames = m_partial.size() / frameBytes;
+        const char *src = m_partial.constData();
+
+        for (qint64 done = 0; done < frames;) {
+            const int n = int(qMin<qint64>(frames - done, chunkFrames));
+            for (int f = 0; f < n; ++f) {
+                float sum = 0.0f;
+                for (int c = 0; c < channels; ++c)
+                    sum += m_format.normalizedSampleValue(src + c * m_format.bytesPerSample());
+                m_mono[f] = sum / channels;
+                src += frameBytes;
+            }
+            m_owner->pushFrames(m_mono, n);
+            done += n;
+        }
+
+        m_partial.remove(0, int(frames * frameBytes));
+        return len;
+    }
+
+private:
+    static constexpr int chunkFrames = 512;
+
+    AudioCaptureSource *m_owner;
+    QAudioFormat m_format;
+    QByteArray m_partial;
+    float m_mono[chunkFrames];
+};
+
+AudioCaptureSource::AudioCaptureSource(const QAudioDevice &device, QObject *parent)
+    : InputSource(parent)
+    , m_device(device)
+{}
+
+AudioCaptureSource::~AudioCaptureSource()
+{
+    stop();
+}
+
+QString AudioCaptureSource::name() const
+{
+    return m_device.isNull() ? QMediaDevices::defaultAudioInput().description()
+                             : m_device.description();
+}
+
+// Моно float на родной частоте устройства, если оно его принимает,
+// иначе предпочтительный формат устройства с преобразованием на лету
+bool AudioCaptureSource::start(QString &err)
+{
+    stop();
+
+    const QAudioDevice device = m_device.isNull() ? QMediaDevices::defaultAudioInput() : m_device;
+    if (device.isNull()) {
+        err = tr("Нет устройства звукового входа");
+        return false;
+    }
+
+    m_format = device.preferredFormat();
+    QAudioFormat mono = m_format;
+    mono.setChannelCount(1);
+    mono.setSampleFormat(QAudioFormat::Float);
+    if (device.isFormatSupported(mono))
+        m_format = mono;
+
+    if (m_format.sampleRate() <= 0 || m_format.bytesPerFrame() <= 0) {
+        err = tr("Неподдерживаемый формат входа: %1").arg(device.description());
+        return false;
+    }
+
+    reset(quint32(m_format.sampleRate()));
+    m_sink = new CaptureDevice(this, m_format);
+    m_sink->open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+    m_source = new QAudioSource(device, m_format, this);
+    m_source->setBufferSize(m_format.bytesForDuration(qint64(bufferMs) * 1000));
+    m_source->start(m_sink);
+    if (m_source->error() != QAudio::NoError) {
+        err = tr("Не удалось начать захват: %1").arg(device.description());
+        stop();
+        return false;
+    }
+
+    // Сбой во время захвата (устройство отключили, поток прервался):
+    // QAudioSource останавливается с ошибкой, владелец узнаёт об этом.
+    // Подключается после запуска, чтобы отказ start() не сообщался дважды.
+    connect(m_source, &QAudioSource::stateChanged, this, [this](QAudio::State state) {
+        if (state != QAudio::StoppedState || !m_source)
+            return;
+        switch (m_source->error()) {
+        case QAudio::NoError:
+            break;
+        case QAudio::OpenError:
+            emit errorOccurred(tr("Не удалось открыть устройство входа: %1").arg(name()));
+            break;
+        case QAudio::IOError:
+            emit errorOccurred(tr("Ошибка чтения со входа: %1").arg(name()));
+            break;
+        case QAudio::UnderrunError:
+        case QAudio::FatalError:
+            emit errorOccurred(tr("Захват со входа прерван: %1").arg(name()));
+            break;
+        }
+    });
+    return true;
+}
+
+void AudioCaptureSource::stop()
+{
+    if (m_source) {
+        m_source->stop();
+        delete m_source;
+        m_source = nullptr;
+    }
+    delete m_sink;
+    m_sink = nullptr;
+}
+
+bool AudioCaptureSource::isActive() const
+{
+    return m_source && m_source->state() != QAudio::StoppedState;
+}
@@ -0,0 +1,389 @@
+#include "audioanalyzer.h"
+#include "audiomodel.h"
+#include "spectrogramcache.h"
+#include "streamingstft.h"
+#include "wavreader.h"
+#include <QFileInfo>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+
+// Объявления из заголовка должны совпадать с ядром
+static_assert(AA_SPECTROGRAM_FFT_SIZE == SpectrogramCache::fftSize, "fft size mismatch");
+static_assert(AA_SPECTROGRAM_BINS == SpectrogramCache::binCount, "bin count mismatch");
+static_assert(AA_SPECTRUM_FFT_SIZE == AudioModel::spectrumFftSize, "spectrum fft size mismatch");
+static_assert(AA_SPECTRUM_BINS == AudioModel::spectrumBinCount, "spectrum bin count mismatch");
+
+struct aa_audio
+{
+    quint32 sampleRate = 0;
+    quint32 bitsPerSample = 0;
+    QVector<double> mono;
+    QVector<QVector<double>> channels; // Пусто для моно: канал совпадает со смесью
+};
+
+struct aa_stream
+{
+    aa_stream(int fftSize, int hop)
+        : stft(fftSize, hop)
+    {}
+
+    StreamingStft stft;
+};
+
+namespace {
+
+constexpr qint64 decodeBlockFrames = 1 << 16;
+
+thread_local std::string lastError;
+
+aa_status fail(aa_status status, const QString &message)
+{
+    lastError = message.toStdString();
+    return status;
+}
+
+aa_status invalid(const char *message)
+{
+    lastError = message;
+    return AA_ERROR_INVALID_ARGUMENT;
+}
+
+// Исключения (нехватка памяти в контейнерах Qt) не должны пересекать границу C
+template<typename Function>
+aa_status guarded(Function &&function)
+{
+    try {
+        lastError.clear();
+        return function();
+    } catch (const std::bad_alloc &) {
+        lastError = "out of memory";
+        return AA_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        lastError = "internal error";
+        return AA_ERROR_INTERNAL;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t aa_version(void)
+{
+    return AUDIOANALYZER_VERSION;
+}
+
+const char *aa_status_string(aa_status status)
+{
+    switch (status) {
+    case AA_OK:
+        return "ok";
+    case AA_ERROR_INVALID_ARGUMENT:
+        return "invalid argument";
+    case AA_ERROR_IO:
+        return "i/o error";
+    case AA_ERROR_UNSUPPORTED_FORMAT:
+        return "unsupported format";
+    case AA_ERROR_BUFFER_TOO_SMALL:
+        return "buffer too small";
+    case AA_ERROR_OUT_OF_MEMORY:
+        return "out of memory";
+    case AA_ERROR_INTERNAL:
+        return "internal error";
+    }
+    return "unknown status";
+}
+
+const char *aa_last_error(void)
+{
+    return lastError.c_str();
+}
+
+aa_status aa_audio_open_wav(const char *path, aa_audio **out_audio)
+{
+    if (!path || !out_audio)
+        return invalid("path and out_audio must not be NULL");
+    *out_audio = nullptr;
+
+    return guarded([&] {
+        const QString filePath = QString::fromUtf8(path);
+        WavReader reader;
+        QString errorString;
+        if (!reader.open(filePath, errorString))
+            return fail(QFileInfo(filePath).isReadable() ? AA_ERROR_UNSUPPORTED_FORMAT : AA_ERROR_IO,
+                        errorString);
+
+        const WavReader::Format &format = reader.format();
+        if (format.channels == 0 || (format.bitsPerSample != 8 && format.bitsPerSample != 16))
+            return fail(AA_ERROR_UNSUPPORTED_FORMAT,
+                        QStringLiteral("unsupported bits per sample: %1").arg(format.bitsPerSample));
+
+        auto audio = std::make_unique<aa_audio>();
+        audio->sampleRate = format.sampleRate;
+        audio->bitsPerSample = format.bitsPerSample;
+
+        // Декодирование блоками: в памяти нет сырых данных всего файла
+        const qint64 frames = format.frameCount();
+        audio->mono.resize(frames);
+        if (format.channels > 1) {
+            audio->channels.resize(format.channels);
+            for (QVector<double> &channel : audio->channels)
+                channel.resize(frames);
+        }
+        QVector<double *> channelData(audio->channels.size());
+        qint64 decoded = 0;
+        while (decoded < frames) {
+            const QByteArray raw = reader.readFrames(decoded, qMin(decodeBlockFrames, frames - decoded));
+            const qint64 n = raw.size() / format.frameBytes();
+            if (n <= 0)
+                break; // Файл короче, чем указано в заголовке
+            for (int c = 0; c < channelData.size(); ++c)
+                channelData[c] = audio->channels[c].data() + decoded;
+            WavReader::decode(raw.constData(),
+                              n,
+                              format,
+                              audio->mono.data() + decoded,
+                              channelData.isEmpty() ? nullptr : channelData.constData());
+            decoded += n;
+        }
+        audio->mono.resize(decoded);
+        for (QVector<double> &channel : audio->channels)
+            channel.resize(decoded);
+
+        *out_audio = audio.release();
+        return AA_OK;
+    });
+}
+
+aa_status aa_audio_create(const float *interleaved,
+                          int64_t frames,
+                          uint32_t channels,
+                          uint32_t sample_rate,
+                          aa_audio **out_audio)
+{
+    if (!out_audio || (!interleaved && frames > 0) || frames < 0 || channels == 0 || sample_rate == 0)
+        return invalid("invalid samples, channel count or sample rate");
+    *out_audio = nullptr;
+
+    return guarded([&] {
+        auto audio = std::make_unique<aa_audio>();
+        audio->sampleRate = sample_rate;
+        audio->mono.resize(frames);
+        if (channels > 1) {
+            audio->channels.resize(int(channels));
+            for (QVector<double> &channel : audio->channels)
+                channel.resize(frames);
+        }
+
+        const float *src = interleaved;
+        for (qint64 f = 0; f < frames; ++f) {
+            double sum = 0.0;
+            for (uint32_t c = 0; c < channels; ++c) {
+                sum += src[c];
+                if (channels > 1)
+                    audio->channels[int(c)][f] = src[c];
+            }
+            audio->mono[f] = sum / channels;
+            src += channels;
+        }
+
+        *out_audio = audio.release();
+        return AA_OK;
+    });
+}
+
+void aa_audio_free(aa_audio *audio)
+{
+    delete audio;
+}
+
+aa_status aa_audio_info_get(const aa_audio *audio, aa_audio_info *out_info)
+{
+    if (!audio || !out_info || out_info->struct_size < sizeof(uint32_t))
+        return invalid("audio and out_info must not be NULL, struct_size must be set");
+
+    aa_audio_info info;
+    info.struct_size = out_info->struct_size;
+    info.sample_rate = audio->sampleRate;
+    info.channels = audio->channels.isEmpty() ? 1 : uint32_t(audio->channels.size());
+    info.bits_per_sample = audio->bitsPerSample;
+    info.frames = audio->mono.size();
+    info.duration_seconds = double(audio->mono.size()) / audio->sampleRate;
+
+    // Старый вызывающий получает только известные ему поля
+    std::memcpy(out_info, &info, std::min<size_t>(out_info->struct_size, sizeof(info)));
+    return AA_OK;
+}
+
+aa_status aa_audio_read(const aa_audio *audio,
+                        int32_t channel,
+                        int64_t first_frame,
+                        int64_t count,
+                        float *out,
+                        int64_t *out_read)
+{
+    if (out_read)
+        *out_read = 0;
+    if (!audio || (!out && count > 0) || first_frame < 0 || count < 0)
+        return invalid("invalid audio, range or output buffer");
+
+    const QVector<double> *source = &audio->mono;
+    if (channel >= 0) {
+        if (channel >= qMax(1, int(audio->channels.size())))
+            return invalid("channel out of range");
+        if (!audio->channels.isEmpty())
+            source = &audio->channels[channel];
+    }
+
+    const qint64 n = qBound<qint64>(0, source->size() - first_frame, count);
+    const double *src = source->constData() + first_frame;
+    for (qint64 i = 0; i < n; ++i)
+        out[i] = float(src[i]);
+    if (out_read)
+        *out_read = n;
+    return AA_OK;
+}
+
+aa_status aa_audio_spectrum(const aa_audio *audio, int64_t first_frame, double *out_db)
+{
+    if (!audio || !out_db || first_frame < 0)
+        return invalid("invalid audio, position or output buffer");
+
+    return guarded([&] {
+        const qint64 start = qMin<qint64>(first_frame, audio->mono.size());
+        if (!AudioModel::computeSpectrum(audio->mono.constData() + start, audio->mono.size() - start, out_db))
+            return fail(AA_ERROR_INTERNAL, QStringLiteral("kissfft initialization failed"));
+        return AA_OK;
+    });
+}
+
+int64_t aa_audio_spectrogram_frames(const aa_audio *audio, int32_t hop)
+{
+    return audio ? SpectrogramCache::frameCountFor(audio->mono.size(), hop) : 0;
+}
+
+aa_status aa_audio_spectrogram(const aa_audio *audio,
+                               aa_spectrogram_mode mode,
+                               int32_t hop,
+                               int64_t first_frame,
+                               int64_t frame_count,
+                               float *out,
+                               int64_t capacity,
+                               int64_t *out_required)
+{
+    if (!audio || hop <= 0 || first_frame < 0 || frame_count < 0
+        || (mode != AA_SPECTROGRAM_STANDARD && mode != AA_SPECTROGRAM_REASSIGNED))
+        return invalid("invalid audio, mode, hop or frame range");
+    if (first_frame + frame_count > SpectrogramCache::frameCountFor(audio->mono.size(), hop))
+        return invalid("frame range exceeds aa_audio_spectrogram_frames()");
+
+    const int64_t required = frame_count * AA_SPECTROGRAM_BINS;
+    if (out_required)
+        *out_required = required;
+    if (!out || capacity < required) {
+        lastError = "output buffer too small";
+        return AA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    return guarded([&] {
+        const auto cacheMode = mode == AA_SPECTROGRAM_REASSIGNED ? SpectrogramCache::Mode::Reassigned
+                                                                 : SpectrogramCache::Mode::Standard;
+        // computeFrames принимает int кадров; большие диапазоны - частями
+        constexpr int64_t chunkFrames = 1 << 20;
+        for (int64_t done = 0; done < frame_count; done += chunkFrames) {
+            const int n = int(qMin(chunkFrames, frame_count - done));
+            SpectrogramCache::computeFrames(audio->mono,
+                                            cacheMode,
+                                            hop,
+                                            first_frame + done,
+                                            n,
+                                            out + done * AA_SPECTROGRAM_BINS);
+        }
+        return AA_OK;
+    });
+}
+
+aa_status aa_stream_create(int32_t fft_size, int32_t hop, aa_stream **out_stream)
+{
+    if (!out_stream || fft_size < 2 || fft_size % 2 != 0 || hop < 1 || hop > fft_size)
+        return invalid("fft_size must be even and positive, hop in [1, fft_size]");
+    *out_stream = nullptr;
+
+    return guarded([&] {
+        *out_stream = new aa_stream(fft_size, hop);
+        return AA_OK;
+    });
+}
+
+void aa_stream_free(aa_stream *stream)
+{
+    delete stream;
+}
+
+int32_t aa_stream_bins(const aa_stream *stream)
+{
+    return stream ? stream->stft.binCount() : 0;
+}
+
+aa_status aa_stream_push(aa_stream *stream,
+                         const float *samples,
+                         int64_t count,
+                         float *out,
+                         int32_t max_frames,
+                         int64_t *out_end_samples,
+                         int64_t *out_consumed,
+                         int32_t *out_frames)
+{
+    if (out_consumed)
+        *out_consumed = 0;
+    if (out_frames)
+        *out_frames = 0;
+    if (!stream || (!samples && count > 0) || count < 0 || max_frames < 0 || (!out && max_frames > 0))
+        return invalid("invalid stream, samples or output buffer");
+
+    return guarded([&] {
+        StreamingStft &stft = stream->stft;
+        const int bins = stft.binCount();
+        int frames = 0;
+        const StreamingStft::FrameHandler onFrame = [&](const float *magnitudes, qint64 endSample) {
+            std::memcpy(out + qsizetype(frames) * bins, magnitudes, bins * sizeof(float));
+            if (out_end_samples)
+                out_end_samples[frames] = endSample;
+            ++frames;
+        };
+
+        // Порция не длиннее hop даёт не больше одного кадра, поэтому приём
+        // останавливается точно на заполнении out
+        int64_t consumed = 0;
+        while (consumed < count && frames < max_frames) {
+            const qsizetype n = qsizetype(qMin<int64_t>(count - consumed, stft.hop()));
+            stft.push(samples + consumed, n, onFrame);
+            consumed += n;
+        }
+
+        if (out_consumed)
+            *out_consumed = consumed;
+        if (out_frames)
+            *out_frames = frames;
+        return AA_OK;
+    });
+}
+
+aa_status aa_stream_skip(aa_stream *stream, int64_t skipped)
+{
+    if (!stream || skipped < 0)
+        return invalid("invalid stream or skip length");
+    stream->stft.skip(skipped);
+    return AA_OK;
+}
+
+int64_t aa_stream_position(const aa_stream *stream)
+{
+    return stream ? stream->stft.position() : 0;
+}
+
+} // extern "C"
@@ -0,0 +1,378 @@
+#include "analysispipeline.h"
+#include "boundedqueue.h"
+#include "bufferedwriter.h"
+#include "spectrogramcache.h"
+#include "wavreader.h"
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThread>
+#include <QtEndian>
+#include <atomic>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+// Состояние файла, общее для всех его блоков
+struct FileState
+{
+    AnalysisPipeline::Job job;
+    WavReader::Format format;
+    qint64 frames = 0;
+    std::atomic<int> remaining{0}; // Блоков ещё не записано
+
+    QMutex mutex; // Вывод: открытие и запись по смещению
+    std::unique_ptr<QSaveFile> out;
+    bool failed = false;
+    QString error;
+};
+using FilePtr = QSharedPointer<FileState>;
+
+struct RawBlock
+{
+    FilePtr file;
+    qint64 firstFrame = 0;
+    int frameCount = 0;
+    QByteArray raw;
+};
+
+struct PcmBlock
+{
+    FilePtr file;
+    qint64 firstFrame = 0;
+    int frameCount = 0;
+    QVector<double> samples;
+};
+
+struct DbBlock
+{
+    FilePtr file;
+    qint64 firstFrame = 0;
+    int frameCount = 0;
+    QVector<float> db;
+};
+
+struct StageCounters
+{
+    const char *name;
+    int threads;
+    std::atomic<qint64> items{0};
+    std::atomic<qint64> bytes{0};
+    std::atomic<qint64> busyNs{0};
+    std::atomic<int> alive{0};
+};
+
+// Учёт работы потока стадии без ожидания очередей
+class BusyScope
+{
+public:
+    BusyScope(StageCounters &stage, qint64 bytes)
+        : m_stage(stage)
+        , m_bytes(bytes)
+    {
+        m_timer.start();
+    }
+    ~BusyScope()
+    {
+        m_stage.busyNs += m_timer.nsecsElapsed();
+        m_stage.bytes += m_bytes;
+        ++m_stage.items;
+    }
+    void setBytes(qint64 bytes) { m_bytes = bytes; }
+
+private:
+    StageCounters &m_stage;
+    qint64 m_bytes;
+    QElapsedTimer m_timer;
+};
+
+} // namespace
+
+AnalysisPipeline::AnalysisPipeline(const Config &config)
+    : m_config(config)
+{
+    m_config.readThreads = qMax(1, m_config.readThreads);
+    m_config.decodeThreads = qMax(1, m_config.decodeThreads);
+    m_config.analyzeThreads = qMax(1, m_config.analyzeThreads);
+    m_config.writeThreads = qMax(1, m_config.writeThreads);
+    m_config.blockFrames = qMax(1, m_config.blockFrames);
+    m_config.hop = qMax(1, m_config.hop);
+}
+
+AnalysisPipeline::Stats AnalysisPipeline::run(const QVector<Job> &jobs,
+                                              const FileHandler &onFile,
+                                              const StatsHandler &onStats,
+                                              int statsIntervalMs)
+{
+    const Config config = m_config;
+    const int fftSize = SpectrogramCache::fftSize;
+    const int bins = SpectrogramCache::binCount;
+
+    BoundedQueue<RawBlock> readQueue(config.queueCapacity);
+    BoundedQueue<PcmBlock> decodeQueue(config.queueCapacity);
+    BoundedQueue<DbBlock> analyzeQueue(config.queueCapacity);
+
+    StageCounters read{"read", config.readThreads};
+    StageCounters decode{"decode", config.decodeThreads};
+    StageCounters analyze{"analyze", config.analyzeThreads};
+    StageCounters write{"write", config.writeThreads};
+
+    std::atomic<int> nextJob{0};
+    std::atomic<int> filesDone{0};
+    std::atomic<int> filesFailed{0};
+    QElapsedTimer clock;
+    clock.start();
+
+    auto finishFile = [&](const Job &job, bool ok, const QString &error) {
+        ++filesDone;
+        if (!ok)
+            ++filesFailed;
+        if (onFile)
+            onFile(job, ok, error);
+    };
+
+    // ---- Чтение: файл целиком одним потоком, блоки с перекрытием окон ----
+    auto readWorker = [&]() {
+        WavReader reader;
+        for (int index = nextJob++; index < jobs.size(); index = nextJob++) {
+            auto file = FilePtr::create();
+            file->job = jobs[index];
+
+            QString error;
+            if (!reader.open(file->job.input, error)) {
+                finishFile(file->job, false, error);
+                continue;
+            }
+            file->format = reader.format();
+            file->frames = SpectrogramCache::frameCountFor(file->format.frameCount(), config.hop);
+
+            // Короткий файл - один пустой блок, чтобы записался заголовок
+            const qint64 blocks = qMax<qint64>(1, (file->frames + config.blockFrames - 1) / config.blockFrames);
+            file->remaining = int(blocks);
+            for (qint64 b = 0; b < blocks; ++b) {
+                RawBlock block;
+                block.file = file;
+                block.firstFrame = b * config.blockFrames;
+                block.frameCount = int(qMin<qint64>(config.blockFrames, file->frames - block.firstFrame));
+                {
+                    BusyScope busy(read, 0);
+                    if (block.frameCount > 0)
+                        block.raw = reader.readFrames(block.firstFrame * config.hop,
+                                                      qint64(block.frameCount - 1) * config.hop + fftSize);
+                    busy.setBytes(block.raw.size());
+                }
+                readQueue.push(std::move(block));
+            }
+            reader.close();
+        }
+        if (--read.alive == 0)
+            readQueue.close();
+    };
+
+    // ---- Декодирование: PCM -> моно double ----
+    auto decodeWorker = [&]() {
+        RawBlock in;
+        while (readQueue.pop(in)) {
+            PcmBlock out;
+            {
+                BusyScope busy(decode, 0);
+                out.file = in.file;
+                out.firstFrame = in.firstFrame;
+                out.frameCount = in.frameCount;
+                if (in.frameCount > 0) {
+                    // Обрезанный файл дополняется нулями до конца последнего окна
+                    const qint64 needed = qint64(in.frameCount - 1) * config.hop + fftSize;
+                    const qint64 frames = qMin<qint64>(needed, in.raw.size() / in.file->format.frameBytes());
+                    out.samples.fill(0.0, needed);
+                    WavReader::decode(in.raw.constData(), frames, in.file->format, out.samples.data());
+                }
+                busy.setBytes(out.samples.size() * qint64(sizeof(double)));
+                in = RawBlock(); // Сырые данные больше не нужны
+            }
+            decodeQueue.push(std::move(out));
+        }
+        if (--decode.alive == 0)
+            decodeQueue.close();
+    };
+
+    // ---- Анализ: кадры STFT -> дБ ----
+    auto analyzeWorker = [&]() {
+        PcmBlock in;
+        while (decodeQueue.pop(in)) {
+            DbBlock out;
+            {
+                BusyScope busy(analyze, 0);
+                out.file = in.file;
+                out.firstFrame = in.firstFrame;
+                out.frameCount = in.frameCount;
+                out.db.resize(qsizetype(in.frameCount) * bins);
+                if (in.frameCount > 0) {
+                    SpectrogramCache::computeFrames(in.samples,
+                                                    SpectrogramCache::Mode::Standard,
+                                                    config.hop,
+                                                    0,
+                                                    in.frameCount,
+                                                    out.db.data());
+                    for (float &value : out.db)
+                        value = qToLittleEndian(float(20 * std::log10(value + 1e-12)));
+                }
+                busy.setBytes(out.db.size() * qint64(sizeof(float)));
+                in = PcmBlock();
+            }
+            analyzeQueue.push(std::move(out));
+        }
+        if (--analyze.alive == 0)
+            analyzeQueue.close();
+    };
+
+    // ---- Запись: блок по своему смещению в NPY ----
+    auto writeWorker = [&]() {
+        DbBlock in;
+        while (analyzeQueue.pop(in)) {
+            FileState &file = *in.file;
+            {
+                BusyScope busy(write, 0);
+                QMutexLocker lock(&file.mutex);
+                if (!file.failed && !file.out) {
+                    const QString path = file.job.output;
+                    QDir().mkpath(QFileInfo(path).absolutePath());
+                    file.out = std::make_unique<QSaveFile>(path);
+                    const QByteArray header = NpyWriter::header(file.frames, bins);
+                    // Блоки приходят в любом порядке: запись за концом файла его расширяет
+                    if (!file.out->open(QIODevice::WriteOnly) || file.out->write(header) != header.size()) {
+                        file.failed = true;
+                        file.error = tr("Не удалось создать %1").arg(path);
+                    }
+                }
+                if (!file.failed && in.frameCount > 0) {
+                    const qint64 offset = NpyWriter::headerSize + in.firstFrame * bins * qint64(sizeof(float));
+                    const qint64 size = in.db.size() * qint64(sizeof(float));
+                    if (!file.out->seek(offset)
+                        || file.out->write(reinterpret_cast<const char *>(in.db.constData()), size) != size) {
+                        file.failed = true;
+                        file.error = tr("Ошибка записи %1").arg(file.job.output);
+                    }
+                    busy.setBytes(size);
+                }
+            }
+
+            if (--file.remaining == 0) {
+                // Последний блок файла: результат появляется целиком или никак
+                bool ok = !file.failed;
+                if (file.out) {
+                    if (ok && !file.out->commit()) {
+                        ok = false;
+                        file.error = tr("Ошибка записи %1").arg(file.job.output);
+                    }
+                    if (!ok)
+                        file.out->cancelWriting();
+                    file.out.reset();
+                }
+                finishFile(file.job, ok, file.error);
+            }
+            in = DbBlock();
+        }
+        --write.alive;
+    };
+
+    auto snapshot = [&]() {
+        Stats stats;
+        stats.elapsedMs = clock.nsecsElapsed() / 1e6;
+        stats.filesDone = filesDone.load();
+        stats.filesFailed = filesFailed.load();
+
+        const auto readStats = readQueue.stats();
+        const auto decodeStats = decodeQueue.stats();
+        const auto analyzeStats = analyzeQueue.stats();
+
+        auto stage = [](const StageCounters &c, qint64 inputWaitNs, qint64 outputWaitNs) {
+            StageStats s;
+            s.name = QString::fromLatin1(c.name);
+            s.threads = c.threads;
+            s.items = c.items.load();
+            s.bytes = c.bytes.load();
+            s.busyMs = c.busyNs.load() / 1e6;
+            s.inputWaitMs = inputWaitNs / 1e6;
+            s.outputWaitMs = outputWaitNs / 1e6;
+            return s;
+        };
+        stats.stages = {stage(read, 0, readStats.pushWaitNs),
+                        stage(decode, readStats.popWaitNs, decodeStats.pushWaitNs),
+                        stage(analyze, decodeStats.popWaitNs, analyzeStats.pushWaitNs),
+                        stage(write, analyzeStats.popWaitNs, 0)};
+
+        auto queue = [](const char *name, const auto &q) {
+            QueueStats s;
+            s.name = QString::fromLatin1(name);
+            s.capacity = q.capacity;
+            s.depth = q.depth;
+            s.maxDepth = q.maxDepth;
+            s.meanDepth = q.meanDepth;
+            return s;
+        };
+        stats.queues = {queue("read->decode", readStats),
+                        queue("decode->analyze", decodeStats),
+                        queue("analyze->write", analyzeStats)};
+        return stats;
+    };
+
+    QVector<QThread *> threads;
+    auto start = [&threads](StageCounters &stage, const std::function<void()> &worker) {
+        stage.alive = stage.threads;
+        for (int i = 0; i < stage.threads; ++i) {
+            QThread *thread = QThread::create(worker);
+            thread->setObjectName(QString::fromLatin1(stage.name));
+            threads.append(thread);
+        }
+    };
+    start(read, readWorker);
+    start(decode, decodeWorker);
+    start(analyze, analyzeWorker);
+    start(write, writeWorker);
+    for (QThread *thread : std::as_const(threads))
+        thread->start();
+
+    for (QThread *thread : std::as_const(threads)) {
+        while (!thread->wait(QDeadlineTimer(qMax(1, statsIntervalMs)))) {
+            if (onStats)
+                onStats(snapshot());
+        }
+        delete thread;
+    }
+    return snapshot();
+}
+
+QString AnalysisPipeline::formatStats(const Stats &stats)
+{
+    const double seconds = qMax(1e-3, stats.elapsedMs / 1000.0);
+    QStringList lines;
+    lines << tr("%1 с, файлов %2 (ошибок %3)")
+                 .arg(seconds, 0, 'f', 1)
+                 .arg(stats.filesDone)
+                 .arg(stats.filesFailed);
+    for (const StageStats &s : stats.stages) {
+        const double busy = 100.0 * s.busyMs / (stats.elapsedMs * qMax(1, s.threads) + 1e-9);
+        lines << tr("  %1 x%2: %3 блоков, %4 МБ/с, занятость %5%, ждали вход %6 мс, выход %7 мс")
+                     .arg(s.name, -8)
+                     .arg(s.threads)
+                     .arg(s.items)
+                     .arg(s.bytes / seconds / 1e6, 0, 'f', 1)
+                     .arg(busy, 0, 'f', 0)
+                     .arg(s.inputWaitMs, 0, 'f', 0)
+                     .arg(s.outputWaitMs, 0, 'f', 0);
+    }
+    for (const QueueStats &q : stats.queues) {
+        lines << tr("  очередь %1: %2/%3, макс %4, средняя %5")
+                     .arg(q.name, -16)
+                     .arg(q.depth)
+                     .arg(q.capacity)
+                     .arg(q.maxDepth)
+                     .arg(q.meanDepth, 0, 'f', 1);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,68 @@
+#include "analysisreport.h"
+#include <QFileInfo>
+#include <QJsonArray>
+
+bool AnalysisReport::analyze(const QString &filePath, QString &errorString)
+{
+    m_filePath = QFileInfo(filePath).absoluteFilePath();
+
+    // Только декодирование, спектр и уровни: спектрограмму вызывающий
+    // считает полосами сам, когда она нужна
+    AudioModel model;
+    model.setSpectrogramEnabled(false);
+    QObject::connect(&model, &AudioModel::waveformReady, [this](const QVector<double> &s, quint32 rate) {
+        m_samples = s;
+        m_sampleRate = rate;
+    });
+    QObject::connect(&model,
+                     &AudioModel::spectrumReady,
+                     [this](const QVector<double> &f, const QVector<double> &db) {
+                         m_frequencies = f;
+                         m_spectrumDb = db;
+                     });
+
+    if (!model.loadWav(filePath, m_meta, errorString))
+        return false;
+    m_features = AudioFeatures::compute(m_samples, m_sampleRate);
+    return true;
+}
+
+QJsonObject AnalysisReport::toJson() const
+{
+    QJsonObject root;
+    root["file"] = m_filePath;
+    root["meta"] = QJsonObject{
+        {"durationSeconds", m_meta.durationSeconds},
+        {"sampleRate", qint64(m_meta.sampleRate)},
+        {"channels", m_meta.channels},
+        {"bitsPerSample", m_meta.bitsPerSample},
+        {"bitRate", qint64(m_meta.bitRate)},
+        {"peakDb", m_meta.peakDb},
+        {"rmsDb", m_meta.rmsDb},
+        {"integratedLufs", m_meta.integratedLufs},
+        {"loudnessRangeLu", m_meta.loudnessRangeLu},
+        {"maxMomentaryLufs", m_meta.maxMomentaryLufs},
+        {"maxShortTermLufs", m_meta.maxShortTermLufs},
+    };
+    root["features"] = QJsonObject{
+        {"frameCount", m_features.frameCount},
+        {"rmsDb", m_features.rmsDb},
+        {"peakDb", m_features.peakDb},
+        {"crestFactorDb", m_features.crestFactorDb},
+        {"zeroCrossingRate", m_features.zeroCrossingRate},
+        {"spectralCentroidHz", m_features.spectralCentroidHz},
+        {"spectralSpreadHz", m_features.spectralSpreadHz},
+        {"spectralRolloffHz", m_features.spectralRolloffHz},
+        {"spectralFlatness", m_features.spectralFlatness},
+        {"spectralFlux", m_features.spectralFlux},
+    };
+
+    QJsonArray db;
+    for (double value : m_spectrumDb)
+        db.append(value);
+    root["spectrum"] = QJsonObject{
+        {"binWidthHz", m_frequencies.size() > 1 ? m_frequencies[1] - m_frequencies[0] : 0.0},
+        {"db", db},
+    };
+    return root;
+}
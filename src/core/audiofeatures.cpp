@@ -0,0 +1,139 @@
+#include "audiofeatures.h"
+#include "simdreduce.h"
+#include "streamingstft.h"
+#include <algorithm>
+#include <cmath>
+
+namespace AudioFeatures {
+
+qint64 forEachFrame(const QVector<double> &samples, quint32 sampleRate, const FrameHandler &onFrame)
+{
+    const qsizetype count = samples.size();
+    if (count == 0 || sampleRate == 0)
+        return 0;
+
+    StreamingStft stft(fftSize, hop);
+    const int bins = stft.binCount();
+    const double binWidth = double(sampleRate) / fftSize;
+    QVector<float> previous(bins, 0.0f);
+    double previousNorm = 0.0;
+    qint64 frames = 0;
+
+    auto onStftFrame = [&](const float *magnitudes, qint64 endSample) {
+        ++frames;
+        Frame frame;
+        frame.endSample = endSample;
+
+        // Временные признаки по тем же сэмплам окна
+        const qsizetype first = endSample - fftSize;
+        double squares = 0.0;
+        int crossings = 0;
+        for (qsizetype i = first; i < endSample; ++i) {
+            squares += samples[i] * samples[i];
+            if (i > first)
+                crossings += (samples[i - 1] < 0.0) != (samples[i] < 0.0);
+        }
+        frame.rmsDb = 10 * std::log10(squares / fftSize + 1e-24);
+        frame.zeroCrossingRate = double(crossings) / fftSize;
+
+        double power = 0.0, weighted = 0.0, logSum = 0.0, norm = 0.0;
+        for (int k = 0; k < bins; ++k) {
+            const double p = double(magnitudes[k]) * magnitudes[k];
+            power += p;
+            weighted += p * k;
+            logSum += std::log(p + 1e-20);
+            norm += magnitudes[k];
+        }
+
+        // Поток - по спектрам, нормированным к единичной сумме
+        if (previousNorm > 0.0 && norm > 0.0) {
+            double flux = 0.0;
+            for (int k = 0; k < bins; ++k) {
+                const double d = magnitudes[k] / norm - previous[k] / previousNorm;
+                flux += d * d;
+            }
+            frame.spectralFlux = std::sqrt(flux);
+        }
+        std::copy(magnitudes, magnitudes + bins, previous.begin());
+        previousNorm = norm;
+
+        if (power > 1e-20) {
+            const double centroid = weighted / power;
+            double spread = 0.0, cumulative = 0.0;
+            int rolloff = -1;
+            for (int k = 0; k < bins; ++k) {
+                const double p = double(magnitudes[k]) * magnitudes[k];
+                spread += p * (k - centroid) * (k - centroid);
+                cumulative += p;
+                if (rolloff < 0 && cumulative >= rolloffFraction * power)
+                    rolloff = k;
+            }
+
+            frame.silent = false;
+            frame.spectralCentroidHz = centroid * binWidth;
+            frame.spectralSpreadHz = std::sqrt(spread / power) * binWidth;
+            frame.spectralRolloffHz = qMax(0, rolloff) * binWidth;
+            frame.spectralFlatness = std::exp(logSum / bins) / (power / bins);
+        }
+        onFrame(frame);
+    };
+
+    // Сэмплы подаются порциями float
+    constexpr int chunk = 4096;
+    float block[chunk];
+    for (qsizetype done = 0; done < count; done += chunk) {
+        const int n = int(qMin<qsizetype>(chunk, count - done));
+        for (int i = 0; i < n; ++i)
+            block[i] = float(samples[done + i]);
+        stft.push(block, n, onStftFrame);
+    }
+    return frames;
+}
+
+Summary compute(const QVector<double> &samples, quint32 sampleRate)
+{
+    Summary summary;
+    const qsizetype count = samples.size();
+    if (count == 0 || sampleRate == 0)
+        return summary;
+
+    // Временные признаки по всей записи
+    const SimdReduce::Result level = SimdReduce::reduce(samples.constData(), count);
+    const double peak = qMax(qAbs(double(level.min)), qAbs(double(level.max)));
+    const double rms = std::sqrt(level.sumSquares / count);
+    summary.peakDb = 20 * std::log10(peak + 1e-12);
+    summary.rmsDb = 20 * std::log10(rms + 1e-12);
+    summary.crestFactorDb = summary.peakDb - summary.rmsDb;
+
+    qint64 crossings = 0;
+    for (qsizetype i = 1; i < count; ++i)
+        crossings += (samples[i - 1] < 0.0) != (samples[i] < 0.0);
+    summary.zeroCrossingRate = double(crossings) / count;
+
+    // Спектральные - средние по кадрам; тишина не смещает средние
+    double centroidSum = 0.0, spreadSum = 0.0, rolloffSum = 0.0, flatnessSum = 0.0;
+    double fluxSum = 0.0;
+    qint64 voicedFrames = 0;
+    summary.frameCount = forEachFrame(samples, sampleRate, [&](const Frame &frame) {
+        fluxSum += frame.spectralFlux;
+        if (frame.silent)
+            return;
+        centroidSum += frame.spectralCentroidHz;
+        spreadSum += frame.spectralSpreadHz;
+        rolloffSum += frame.spectralRolloffHz;
+        flatnessSum += frame.spectralFlatness;
+        ++voicedFrames;
+    });
+
+    if (voicedFrames > 0) {
+        summary.spectralCentroidHz = centroidSum / voicedFrames;
+        summary.spectralSpreadHz = spreadSum / voicedFrames;
+        summary.spectralRolloffHz = rolloffSum / voicedFrames;
+        summary.spectralFlatness = flatnessSum / voicedFrames;
+    }
+    if (summary.frameCount > 1)
+        summary.spectralFlux = fluxSum / (summary.frameCount - 1);
+    return summary;
+}
+
+} // namespace AudioFeatures
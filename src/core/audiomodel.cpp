@@ -0,0 +1,223 @@
+#include "audiomodel.h"
+#include "loudnessmeter.h"
+#include "simdreduce.h"
+#include "spectrogramcache.h"
+#include "wavreader.h"
+#include <QtEndian>
+#include <cmath>
+
+extern "C" {
+#include <kiss_fft.h>
+#include <kiss_fftr.h>
+}
+
+namespace {
+
+// Кадров на блок чтения: сырые данные и копия int16 для уровня не растут
+// с длиной файла
+constexpr qint64 decodeBlockFrames = 1 << 16;
+
+void mergeLevel(SimdReduce::Result &total, const SimdReduce::Result &block, bool first)
+{
+    total.min = first ? block.min : qMin(total.min, block.min);
+    total.max = first ? block.max : qMax(total.max, block.max);
+    total.sumSquares += block.sumSquares;
+}
+
+} // namespace
+
+AudioModel::AudioModel(QObject *parent)
+    : QObject(parent)
+    , m_spectrogramCache(new SpectrogramCache(this))
+{}
+
+void AudioModel::setLazySpectrogram(bool enabled)
+{
+    m_lazySpectrogram = enabled;
+    if (!enabled)
+        m_spectrogramCache->clear();
+}
+
+// Загрузка WAV-файла и извлечение данных
+bool AudioModel::loadWav(const QString &filePath, Meta &outMeta, QString &errorString)
+{
+    WavReader reader;
+    if (!reader.open(filePath, errorString)) {
+        emit errorOccurred(errorString);
+        return false;
+    }
+    const WavReader::Format &format = reader.format();
+
+    // Формирование метаданных
+    double durationSec = double(format.dataSize) / format.byteRate;
+    quint32 bitRate = format.byteRate * 8;
+    outMeta = {durationSec,
+               format.sampleRate,
+               format.byteRate,
+               format.channels,
+               format.bitsPerSample,
+               bitRate};
+    const quint32 sampleRate = format.sampleRate;
+    const int numChannels = format.channels;
+    const int bitsPerSample = format.bitsPerSample;
+
+    // Обработка сэмплов: смешивание каналов и нормализация [-1.0, 1.0].
+    // Для дорожек осциллограммы каналы также раскладываются по отдельности.
+    // Чтение, декодирование и уровень - блоками, как в C API.
+    const qint64 frames = format.frameCount();
+    QVector<double> samples(frames, 0.0);
+    QVector<QVector<double>> channels(numChannels > 1 ? numChannels : 0);
+    for (QVector<double> &channel : channels)
+        channel.resize(frames);
+    QVector<double *> channelData(channels.size());
+
+    SimdReduce::Result level;
+    QVector<qint16> pcm;
+    qint64 numSamples = 0;
+    while (numSamples < frames) {
+        const QByteArray raw = reader.readFrames(numSamples,
+                                                 qMin(decodeBlockFrames, frames - numSamples));
+        const qint64 n = raw.size() / format.frameBytes();
+        if (n <= 0)
+            break; // Файл короче, чем указано в заголовке
+        for (int c = 0; c < channelData.size(); ++c)
+            channelData[c] = channels[c].data() + numSamples;
+        WavReader::decode(raw.constData(),
+                          n,
+                          format,
+                          samples.data() + numSamples,
+                          channelData.isEmpty() ? nullptr : channelData.constData());
+
+        // Уровень по всем каналам (не по смеси), при любой битности
+        if (bitsPerSample == 16) {
+            pcm.resize(n * numChannels);
+            qFromLittleEndian<qint16>(raw.constData(), pcm.size(), pcm.data());
+            mergeLevel(level, SimdReduce::reduce(pcm.constData(), pcm.size()), numSamples == 0);
+        } else if (bitsPerSample == 8) {
+            if (channelData.isEmpty()) {
+                mergeLevel(level,
+                           SimdReduce::reduce(samples.constData() + numSamples, n),
+                           numSamples == 0);
+            }
+            for (int c = 0; c < channelData.size(); ++c)
+                mergeLevel(level, SimdReduce::reduce(channelData[c], n), numSamples == 0 && c == 0);
+        }
+        numSamples += n;
+    }
+    samples.resize(numSamples);
+    for (QVector<double> &channel : channels)
+        channel.resize(numSamples);
+
+    // Пиковый и RMS-уровень в dBFS
+    const qint64 levelCount = numSamples * numChannels;
+    const double peak = qMax(qAbs(double(level.min)), qAbs(double(level.max)));
+    outMeta.peakDb = 20 * log10(peak + 1e-12);
+    outMeta.rmsDb = levelCount > 0 ? 10 * log10(level.sumSquares / levelCount + 1e-24) : -240.0;
+
+    if (channels.isEmpty())
+        channels.append(samples); // Моно: единственная дорожка совпадает со смесью
+
+    // Громкость по каналам (не по смеси), участки файла - параллельно
+    const LoudnessMeter::Result loudness =
+        LoudnessMeter::measure(channels, sampleRate, m_loudnessThreads);
+    outMeta.integratedLufs = loudness.integratedLufs;
+    outMeta.loudnessRangeLu = loudness.loudnessRangeLu;
+    outMeta.maxMomentaryLufs = loudness.maxMomentaryLufs;
+    outMeta.maxShortTermLufs = loudness.maxShortTermLufs;
+    emit metadataReady(outMeta);
+    emit channelsReady(channels, sampleRate);
+    emit waveformReady(samples, sampleRate);
+
+    // Вычисление спектральных характеристик
+    calculateSpectrum(samples, sampleRate);
+    if (!m_spectrogramEnabled)
+        return true;
+    if (m_lazySpectrogram)
+        m_spectrogramCache->setSamples(samples, sampleRate); // Кадры посчитаются по запросу вида
+    else
+        calculateSpectrogram(samples, sampleRate);
+
+    return true;
+}
+
+// ИЗМЕНЕН calculateSpectrum
+void AudioModel::calculateSpectrum(const QVector<double> &samples, quint32 sampleRate)
+{
+    QVector<double> amplitudes(spectrumBinCount);
+    if (!computeSpectrum(samples.constData(), samples.size(), amplitudes.data())) {
+        emit errorOccurred(tr("Не удалось инициализировать kissfft"));
+        return;
+    }
+
+    QVector<double> frequencies(spectrumBinCount);
+    for (int i = 0; i < spectrumBinCount; ++i)
+        frequencies[i] = i * double(sampleRate) / spectrumFftSize;
+
+    emit spectrumReady(frequencies, amplitudes);
+}
+
+bool AudioModel::computeSpectrum(const double *samples, qsizetype count, double *magnitudesDb)
+{
+    const int fftSize = spectrumFftSize;
+    const int n = int(qMin<qsizetype>(count, fftSize));
+
+    kiss_fft_cfg cfg = kiss_fft_alloc(fftSize, 0, nullptr, nullptr);
+    if (!cfg)
+        return false;
+
+    QVector<kiss_fft_cpx> input(fftSize);
+    QVector<kiss_fft_cpx> output(fftSize);
+
+    // Применяем оконную функцию Ханна для уменьчения артефактов
+    for (int i = 0; i < fftSize; ++i) {
+        double window = 0.5 * (1 - cos(2 * M_PI * i / (fftSize - 1)));
+        input[i].r = (i < n) ? samples[i] * window : 0.0;
+        input[i].i = 0.0;
+    }
+
+    kiss_fft(cfg, input.data(), output.data());
+
+    for (int i = 0; i < fftSize / 2; ++i) {
+        double amp = std::sqrt(output[i].r * output[i].r + output[i].i * output[i].i);
+
+        // Правильный расчет dB (без инверсии)
+        magnitudesDb[i] = 20 * log10(amp + 1e-12); // +1e-12 чтобы избежать log(0)
+    }
+
+    free(cfg);
+    return true;
+}
+
+// Вычисление спектрограммы блоками кадров (тот же расчёт кадра, что у
+// ленивой спектрограммы и конвейера пакетной обработки)
+void AudioModel::calculateSpectrogram(const QVector<double> &samples, quint32 sampleRate)
+{
+    Q_UNUSED(sampleRate);
+    const int fftSize = SpectrogramCache::fftSize;
+    const int hopSize = fftSize / 2; // 50% перекрытие окон
+    const qint64 numFrames = SpectrogramCache::frameCountFor(samples.size(), hopSize);
+    if (numFrames <= 0)
+        return;
+
+    QVector<QVector<double>> spectrogram;
+    spectrogram.reserve(numFrames);
+
+    constexpr int blockFrames = 256;
+    const int bins = SpectrogramCache::binCount;
+    QVector<float> block(blockFrames * bins);
+    for (qint64 first = 0; first < numFrames; first += blockFrames) {
+        const int n = int(qMin<qint64>(blockFrames, numFrames - first));
+        SpectrogramCache::computeFrames(samples,
+                                        SpectrogramCache::Mode::Standard,
+                                        hopSize,
+                                        first,
+                                        n,
+                                        block.data());
+        for (int f = 0; f < n; ++f) {
+            const float *mags = block.constData() + qsizetype(f) * bins;
+            spectrogram.append(QVector<double>(mags, mags + bins));
+        }
+    }
+
+    emit spectrogramReady(spectrogram);
+}
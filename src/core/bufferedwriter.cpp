@@ -0,0 +1,186 @@
+#include "bufferedwriter.h"
+#include <QJsonDocument>
+#include <QtEndian>
+#include <cmath>
+
+BufferedWriter::BufferedWriter(QIODevice *device)
+    : m_device(device)
+{
+    m_buffer.reserve(bufferSize);
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+void BufferedWriter::write(const char *data, qsizetype size)
+{
+    if (!m_ok)
+        return;
+    if (m_buffer.size() + size > bufferSize) {
+        if (!flush())
+            return;
+        if (size >= bufferSize) { // Большой блок - сразу в устройство
+            m_ok = m_device->write(data, size) == size;
+            return;
+        }
+    }
+    m_buffer.append(data, size);
+}
+
+void BufferedWriter::write(char c)
+{
+    if (m_buffer.size() >= bufferSize && !flush())
+        return;
+    if (m_ok)
+        m_buffer.append(c);
+}
+
+void BufferedWriter::writeNumber(double value, int precision)
+{
+    write(QByteArray::number(value, 'g', precision));
+}
+
+void BufferedWriter::writeNumber(qint64 value)
+{
+    write(QByteArray::number(value));
+}
+
+void BufferedWriter::writeFloats(const float *values, qsizetype count)
+{
+    // Порциями через стек: на big-endian порядок байт меняется при копировании
+    constexpr qsizetype chunk = 1024;
+    float converted[chunk];
+    while (count > 0 && m_ok) {
+        const qsizetype n = qMin(chunk, count);
+        qToLittleEndian<float>(values, n, converted);
+        write(reinterpret_cast<const char *>(converted), n * qsizetype(sizeof(float)));
+        values += n;
+        count -= n;
+    }
+}
+
+bool BufferedWriter::flush()
+{
+    if (m_ok && !m_buffer.isEmpty())
+        m_ok = m_device->write(m_buffer) == m_buffer.size();
+    m_buffer.clear(); // Ёмкость сохраняется
+    return m_ok;
+}
+
+// ---- CSV ----
+
+CsvWriter::CsvWriter(QIODevice *device)
+    : m_out(device)
+{}
+
+void CsvWriter::writeHeader(const QStringList &columns)
+{
+    for (const QString &column : columns)
+        field(column);
+    endRow();
+}
+
+void CsvWriter::separator()
+{
+    if (m_rowStarted)
+        m_out.write(',');
+    m_rowStarted = true;
+}
+
+CsvWriter &CsvWriter::field(double value, int precision)
+{
+    separator();
+    if (std::isfinite(value))
+        m_out.writeNumber(value, precision);
+    return *this; // NaN и бесконечность - пустое поле
+}
+
+CsvWriter &CsvWriter::field(qint64 value)
+{
+    separator();
+    m_out.writeNumber(value);
+    return *this;
+}
+
+CsvWriter &CsvWriter::field(const QString &value)
+{
+    separator();
+    const QByteArray utf8 = value.toUtf8();
+    if (utf8.contains(',') || utf8.contains('"') || utf8.contains('\n') || utf8.contains('\r')) {
+        QByteArray quoted = utf8;
+        quoted.replace("\"", "\"\"");
+        m_out.write('"');
+        m_out.write(quoted);
+        m_out.write('"');
+    } else {
+        m_out.write(utf8);
+    }
+    return *this;
+}
+
+void CsvWriter::endRow()
+{
+    m_out.write('\n');
+    m_rowStarted = false;
+}
+
+// ---- JSON Lines ----
+
+JsonLinesWriter::JsonLinesWriter(QIODevice *device)
+    : m_out(device)
+{}
+
+void JsonLinesWriter::write(const QJsonObject &object)
+{
+    m_out.write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    m_out.write('\n');
+}
+
+// ---- NPY ----
+
+NpyWriter::NpyWriter(QIODevice *device)
+    : m_out(device)
+{}
+
+// Магическая строка, версия, длина словаря и сам словарь, дополненный
+// пробелами до headerSize и завершённый \n
+QByteArray NpyWriter::header(qint64 rows, int columns)
+{
+    QByteArray dict = "{'descr': '<f4', 'fortran_order': False, 'shape': ("
+                      + QByteArray::number(rows) + ", " + QByteArray::number(columns) + "), }";
+    const int prefix = 10;
+    dict.append(QByteArray(headerSize - prefix - dict.size() - 1, ' '));
+    dict.append('\n');
+
+    QByteArray out("\x93NUMPY\x01\x00", 8);
+    const quint16 length = qToLittleEndian(quint16(dict.size()));
+    out.append(reinterpret_cast<const char *>(&length), sizeof(length));
+    out.append(dict);
+    return out;
+}
+
+bool NpyWriter::begin(int columns)
+{
+    m_columns = columns;
+    m_rows = 0;
+    m_out.write(header(0, columns));
+    return m_out.ok();
+}
+
+void NpyWriter::appendRows(const float *values, qint64 rows)
+{
+    m_out.writeFloats(values, rows * m_columns);
+    m_rows += rows;
+}
+
+bool NpyWriter::finish()
+{
+    if (!m_out.flush())
+        return false;
+    QIODevice *device = m_out.device();
+    const qint64 end = device->pos();
+    const QByteArray final = header(m_rows, m_columns);
+    return device->seek(0) && device->write(final) == final.size() && device->seek(end);
+}
@@ -0,0 +1,80 @@
+#include "generatorsource.h"
+#include <QRandomGenerator>
+#include <cmath>
+
+GeneratorSource::GeneratorSource(QObject *parent)
+    : InputSource(parent)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(tickMs);
+    connect(&m_timer, &QTimer::timeout, this, &GeneratorSource::produce);
+}
+
+void GeneratorSource::setSamples(const QVector<double> &samples, quint32 sampleRate)
+{
+    Q_ASSERT(!isActive());
+    m_samples = samples;
+    m_rate = sampleRate;
+}
+
+void GeneratorSource::setTone(double frequency, quint32 sampleRate, double amplitude, double noise)
+{
+    Q_ASSERT(!isActive());
+    m_samples.clear();
+    m_rate = sampleRate;
+    m_frequency = frequency;
+    m_amplitude = amplitude;
+    m_noise = noise;
+}
+
+QString GeneratorSource::name() const
+{
+    if (!m_samples.isEmpty())
+        return tr("Файл по кругу");
+    return tr("Тон %1 Гц").arg(m_frequency);
+}
+
+bool GeneratorSource::start(QString &err)
+{
+    if (m_rate == 0) {
+        err = tr("Генератор не настроен");
+        return false;
+    }
+    reset(m_rate);
+    m_produced = 0;
+    m_phase = 0.0;
+    m_clock.start();
+    m_timer.start();
+    return true;
+}
+
+void GeneratorSource::stop()
+{
+    m_timer.stop();
+}
+
+// Выдача столько сэмплов, сколько "записалось" с момента старта
+void GeneratorSource::produce()
+{
+    const qint64 due = m_clock.elapsed() * m_rate / 1000 - m_produced;
+    if (due <= 0)
+        return;
+
+    m_block.resize(due);
+    if (!m_samples.isEmpty()) {
+        const qint64 size = m_samples.size();
+        for (qint64 i = 0; i < due; ++i)
+            m_block[i] = float(m_samples[(m_produced + i) % size]);
+    } else {
+        const double step = 2 * M_PI * m_frequency / m_rate;
+        QRandomGenerator *random = QRandomGenerator::global();
+        for (qint64 i = 0; i < due; ++i) {
+            const double noise = m_noise * (2 * random->generateDouble() - 1);
+            m_block[i] = float(m_amplitude * std::sin(m_phase) + noise);
+            m_phase = std::fmod(m_phase + step, 2 * M_PI);
+        }
+    }
+
+    pushFrames(m_block.constData(), due);
+    m_produced += due;
+}
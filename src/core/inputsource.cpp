@@ -0,0 +1,56 @@
+#include "inputsource.h"
+#include <QDeadlineTimer>
+
+InputSource::InputSource(QObject *parent)
+    : QObject(parent)
+{}
+
+qint64 InputSource::clockNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+void InputSource::reset(quint32 sampleRate)
+{
+    m_ring.clear();
+    m_sampleRate = sampleRate;
+    m_captured = 0;
+    m_dropped = 0;
+    m_stampFrames = 0;
+    m_stampNs = clockNs();
+}
+
+void InputSource::pushFrames(const float *mono, qsizetype count)
+{
+    const qsizetype written = m_ring.write(mono, count);
+    m_dropped += count - written;
+
+    const qint64 captured = m_captured + count;
+    m_captured = captured;
+    m_stampNs = clockNs();
+    m_stampFrames = captured;
+}
+
+qsizetype InputSource::skip(qsizetype count)
+{
+    float scratch[1024];
+    qsizetype skipped = 0;
+    while (skipped < count) {
+        const qsizetype n = m_ring.read(scratch, qMin<qsizetype>(count - skipped, 1024));
+        if (n == 0)
+            break;
+        skipped += n;
+    }
+    return skipped;
+}
+
+// Последний блок принят в момент stampNs; более ранние сэмплы звучали раньше
+// на своё расстояние от его конца
+qint64 InputSource::captureTimeNs(qint64 sample) const
+{
+    const quint32 rate = m_sampleRate;
+    if (rate == 0)
+        return clockNs();
+    const qint64 frames = m_stampFrames;
+    return m_stampNs - (frames - sample) * 1000000000 / rate;
+}
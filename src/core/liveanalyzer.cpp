@@ -0,0 +1,167 @@
+#include "liveanalyzer.h"
+#include "inputsource.h"
+#include "streamingstft.h"
+#include <QThread>
+#include <utility>
+
+namespace {
+
+// Запас на доставку до экрана: кадр GUI при 60 Гц и его отрисовка
+constexpr double displayBudgetMs = 2 * 1000.0 / 60;
+
+} // namespace
+
+LiveAnalyzer::LiveAnalyzer(QObject *parent)
+    : QObject(parent)
+{}
+
+LiveAnalyzer::~LiveAnalyzer()
+{
+    stop();
+}
+
+void LiveAnalyzer::setSource(InputSource *source)
+{
+    Q_ASSERT(!isRunning());
+    m_source = source;
+}
+
+void LiveAnalyzer::start()
+{
+    if (m_thread || !m_source)
+        return;
+
+    {
+        QMutexLocker locker(&m_sliceMutex);
+        m_pending.clear();
+        m_droppedSlices = 0;
+    }
+    m_skipped = 0;
+    m_latency = Latency();
+    m_latencySumMs = 0.0;
+    m_latencyCount = 0;
+    m_latencyWindowNs = InputSource::clockNs();
+
+    m_running = true;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("LiveAnalyzer");
+    m_thread->start(QThread::HighPriority);
+}
+
+void LiveAnalyzer::stop()
+{
+    if (!m_thread)
+        return;
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_running = false;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+QVector<double> LiveAnalyzer::frequencies() const
+{
+    QVector<double> result(binCount);
+    const double binWidth = m_source ? double(m_source->sampleRate()) / fftSize : 0.0;
+    for (int k = 0; k < binCount; ++k)
+        result[k] = k * binWidth;
+    return result;
+}
+
+QVector<LiveAnalyzer::Slice> LiveAnalyzer::takeSlices()
+{
+    m_notifyPending = false;
+    QMutexLocker locker(&m_sliceMutex);
+    return std::exchange(m_pending, {});
+}
+
+// Цикл потока анализа: сначала ограничение отставания, затем всё накопленное
+// через STFT; срезы копятся до забора потоком GUI
+void LiveAnalyzer::run()
+{
+    StreamingStft stft(fftSize, hop);
+    QVector<float> chunk(readChunk);
+    qint64 dropped = m_source->framesDropped();
+
+    auto onFrame = [this](const float *magnitudes, qint64 endSample) {
+        Slice slice;
+        slice.magnitudes.resize(binCount);
+        for (int k = 0; k < binCount; ++k)
+            slice.magnitudes[k] = magnitudes[k];
+        slice.endSample = endSample;
+
+        QMutexLocker locker(&m_sliceMutex);
+        m_pending.append(std::move(slice));
+        if (m_pending.size() > maxPendingSlices) {
+            m_pending.removeFirst();
+            ++m_droppedSlices;
+        }
+    };
+
+    while (m_running) {
+        // Переполнение кольца источника - тоже разрыв потока
+        const qint64 lost = m_source->framesDropped() - dropped;
+        if (lost > 0) {
+            dropped += lost;
+            stft.skip(lost);
+        }
+
+        const qsizetype backlog = m_source->available();
+        const qsizetype maxBacklog = qsizetype(m_source->sampleRate()) * maxBacklogMs / 1000;
+        if (backlog > maxBacklog) {
+            const qsizetype skipped = m_source->skip(backlog - maxBacklog);
+            m_skipped += skipped;
+            stft.skip(skipped);
+        }
+
+        int frames = 0;
+        qsizetype got = 0;
+        while ((got = m_source->read(chunk.data(), readChunk)) > 0)
+            frames += stft.push(chunk.constData(), got, onFrame);
+
+        if (frames > 0 && !m_notifyPending.exchange(true))
+            QMetaObject::invokeMethod(this, &LiveAnalyzer::slicesReady, Qt::QueuedConnection);
+
+        QMutexLocker locker(&m_waitMutex);
+        if (m_running)
+            m_wake.wait(&m_waitMutex, idleWaitMs);
+    }
+}
+
+double LiveAnalyzer::latencyBoundMs() const
+{
+    return maxBacklogMs + idleWaitMs + displayBudgetMs;
+}
+
+void LiveAnalyzer::markPresented(qint64 endSample)
+{
+    if (!m_source)
+        return;
+
+    const qint64 now = InputSource::clockNs();
+    const double latencyMs = qMax<qint64>(0, now - m_source->captureTimeNs(endSample)) / 1e6;
+    m_latency.currentMs = latencyMs;
+    m_latency.maxMs = qMax(m_latency.maxMs, latencyMs);
+    m_latencySumMs += latencyMs;
+    ++m_latencyCount;
+
+    if ((now - m_latencyWindowNs) / 1000000 < statsIntervalMs)
+        return;
+
+    m_latency.meanMs = m_latencySumMs / m_latencyCount;
+    m_latency.boundMs = latencyBoundMs();
+    m_latency.skippedFrames = m_skipped;
+    {
+        QMutexLocker locker(&m_sliceMutex);
+        m_latency.droppedSlices = m_droppedSlices;
+    }
+    emit latencyUpdated(m_latency);
+
+    m_latency.maxMs = 0.0;
+    m_latencySumMs = 0.0;
+    m_latencyCount = 0;
+    m_latencyWindowNs = now;
+}
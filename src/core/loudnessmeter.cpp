@@ -0,0 +1,321 @@
+#include "loudnessmeter.h"
+#include <QThreadPool>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Громкость блока по средней взвешенной энергии (BS.1770, формула 2)
+double toLufs(double energy)
+{
+    return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : LoudnessMeter::minLufs;
+}
+
+} // namespace
+
+// Коэффициенты K-фильтра пересчитываются для любой частоты из аналоговых
+// прототипов, при 48 кГц совпадают с таблицами BS.1770
+LoudnessMeter::LoudnessMeter(quint32 sampleRate, int channels)
+    : m_channels(qBound(0, channels, int(maxChannels)))
+    , m_stepLength(qMax<qint64>(1, qRound64(double(sampleRate) / stepsPerSecond)))
+{
+    while (m_lanes < m_channels)
+        m_lanes *= 2;
+
+    const double rate = qMax(1.0, double(sampleRate));
+
+    // Полка: +4 дБ выше ~1.7 кГц (модель головы)
+    {
+        const double f0 = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        m_shelf.b0 = (vh + vb * k / q + k * k) / a0;
+        m_shelf.b1 = 2.0 * (k * k - vh) / a0;
+        m_shelf.b2 = (vh - vb * k / q + k * k) / a0;
+        m_shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_shelf.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    // ФВЧ RLB ~38 Гц; числитель нормирован, как в BS.1770
+    {
+        const double f0 = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(M_PI * f0 / rate);
+        const double a0 = 1.0 + k / q + k * k;
+        m_highPass.b0 = 1.0;
+        m_highPass.b1 = -2.0;
+        m_highPass.b2 = 1.0;
+        m_highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+        m_highPass.a2 = (1.0 - k / q + k * k) / a0;
+    }
+
+    for (int c = 0; c < m_channels; ++c)
+        m_weights[c] = 1.0;
+    if (m_channels == 5) { // L R C Ls Rs
+        m_weights[3] = m_weights[4] = 1.41;
+    } else if (m_channels == 6) { // L R C LFE Ls Rs
+        m_weights[3] = 0.0;
+        m_weights[4] = m_weights[5] = 1.41;
+    }
+
+    for (Histogram *h : {&m_momentaryBlocks, &m_shortTermBlocks}) {
+        h->counts.resize(histogramBins);
+        h->energies.resize(histogramBins);
+    }
+}
+
+void LoudnessMeter::reset()
+{
+    std::fill(&m_state[0][0], &m_state[0][0] + 4 * maxChannels, 0.0);
+    std::fill(std::begin(m_sums), std::end(m_sums), 0.0);
+    std::fill(std::begin(m_steps), std::end(m_steps), 0.0);
+    m_stepFill = 0;
+    m_stepCount = 0;
+    m_maxMomentary = 0.0;
+    m_maxShortTerm = 0.0;
+    m_momentaryBlocks.clear();
+    m_shortTermBlocks.clear();
+}
+
+// Один кадр - одна итерация по дорожкам: рекурсии каналов независимы,
+// и цикл по Lanes компилятор разворачивает в векторные операции
+template<int Lanes>
+void LoudnessMeter::filterBlock(int frames)
+{
+    const Biquad s = m_shelf;
+    const Biquad h = m_highPass;
+    double z1[Lanes], z2[Lanes], z3[Lanes], z4[Lanes], sums[Lanes];
+    for (int l = 0; l < Lanes; ++l) {
+        z1[l] = m_state[0][l];
+        z2[l] = m_state[1][l];
+        z3[l] = m_state[2][l];
+        z4[l] = m_state[3][l];
+        sums[l] = m_sums[l];
+    }
+
+    const double *in = m_block;
+    for (int i = 0; i < frames; ++i, in += Lanes) {
+        for (int l = 0; l < Lanes; ++l) {
+            const double x = in[l];
+            const double y1 = s.b0 * x + z1[l];
+            z1[l] = s.b1 * x - s.a1 * y1 + z2[l];
+            z2[l] = s.b2 * x - s.a2 * y1;
+            const double y2 = h.b0 * y1 + z3[l];
+            z3[l] = h.b1 * y1 - h.a1 * y2 + z4[l];
+            z4[l] = h.b2 * y1 - h.a2 * y2;
+            sums[l] += y2 * y2;
+        }
+    }
+
+    for (int l = 0; l < Lanes; ++l) {
+        m_state[0][l] = z1[l];
+        m_state[1][l] = z2[l];
+        m_state[2][l] = z3[l];
+        m_state[3][l] = z4[l];
+        m_sums[l] = sums[l];
+    }
+}
+
+void LoudnessMeter::process(const double *const *channels, qsizetype frames)
+{
+    if (m_channels == 0)
+        return;
+
+    qsizetype done = 0;
+    while (done < frames) {
+        const int n = int(std::min<qint64>({qint64(frames - done), qint64(blockFrames), m_stepLength - m_stepFill}));
+
+        // Кадры подряд по дорожкам; лишние дорожки всегда нулевые
+        for (int c = 0; c < m_channels; ++c) {
+            const double *src = channels[c] + done;
+            double *dst = m_block + c;
+            for (int i = 0; i < n; ++i)
+                dst[i * m_lanes] = src[i];
+        }
+
+        switch (m_lanes) {
+        case 1:
+            filterBlock<1>(n);
+            break;
+        case 2:
+            filterBlock<2>(n);
+            break;
+        case 4:
+            filterBlock<4>(n);
+            break;
+        default:
+            filterBlock<8>(n);
+            break;
+        }
+
+        done += n;
+        m_stepFill += n;
+        if (m_stepFill == m_stepLength)
+            finishStep();
+    }
+}
+
+void LoudnessMeter::finishStep()
+{
+    double energy = 0.0;
+    for (int c = 0; c < m_channels; ++c) {
+        energy += m_weights[c] * m_sums[c];
+        m_sums[c] = 0.0;
+    }
+    energy /= double(m_stepLength);
+    m_stepFill = 0;
+
+    if (m_stepLog)
+        m_stepLog->append(energy);
+    addStep(energy);
+}
+
+void LoudnessMeter::addStep(double energy)
+{
+    m_steps[m_stepCount % shortTermSteps] = energy;
+    ++m_stepCount;
+
+    // Блоки 400 мс и 3 с с шагом 100 мс (перекрытие 75% и ~97%)
+    if (m_stepCount >= momentarySteps) {
+        const double block = recentEnergy(momentarySteps);
+        m_maxMomentary = std::max(m_maxMomentary, block);
+        m_momentaryBlocks.add(block);
+    }
+    if (m_stepCount >= shortTermSteps) {
+        const double block = recentEnergy(shortTermSteps);
+        m_maxShortTerm = std::max(m_maxShortTerm, block);
+        m_shortTermBlocks.add(block);
+    }
+}
+
+// Средняя энергия последних steps шагов (сколько есть, если меньше)
+double LoudnessMeter::recentEnergy(int steps) const
+{
+    const int n = int(std::min<qint64>(steps, m_stepCount));
+    if (n == 0)
+        return 0.0;
+    double sum = 0.0;
+    for (int i = 1; i <= n; ++i)
+        sum += m_steps[(m_stepCount - i) % shortTermSteps];
+    return sum / n;
+}
+
+LoudnessMeter::Result LoudnessMeter::result() const
+{
+    Result r;
+    r.momentaryLufs = toLufs(recentEnergy(momentarySteps));
+    r.shortTermLufs = toLufs(recentEnergy(shortTermSteps));
+    r.maxMomentaryLufs = toLufs(m_maxMomentary);
+    r.maxShortTermLufs = toLufs(m_maxShortTerm);
+
+    // Интегральная: средняя энергия блоков не тише (средняя - 10 LU)
+    const Histogram &blocks = m_momentaryBlocks;
+    qint64 count = 0;
+    double energy = 0.0;
+    for (int b = blocks.gateBin(relativeGateLu); b < histogramBins; ++b) {
+        count += blocks.counts[b];
+        energy += blocks.energies[b];
+    }
+    if (count > 0)
+        r.integratedLufs = toLufs(energy / count);
+
+    // LRA: разброс кратковременной громкости не тише (средняя - 20 LU)
+    const Histogram &shortTerm = m_shortTermBlocks;
+    const int first = shortTerm.gateBin(rangeRelativeGateLu);
+    qint64 gated = 0;
+    for (int b = first; b < histogramBins; ++b)
+        gated += shortTerm.counts[b];
+    if (gated > 0) {
+        const auto percentile = [&](double fraction) {
+            const qint64 rank = qint64(std::ceil(fraction * gated));
+            qint64 seen = 0;
+            for (int b = first; b < histogramBins; ++b) {
+                seen += shortTerm.counts[b];
+                if (seen >= rank)
+                    return absoluteGateLufs + (b + 0.5) / histogramBinsPerLu;
+            }
+            return histogramMaxLufs;
+        };
+        r.loudnessRangeLu = percentile(0.95) - percentile(0.10);
+    }
+    return r;
+}
+
+void LoudnessMeter::Histogram::clear()
+{
+    counts.fill(0);
+    energies.fill(0.0);
+    total = 0;
+    totalEnergy = 0.0;
+}
+
+void LoudnessMeter::Histogram::add(double energy)
+{
+    const double lufs = toLufs(energy);
+    if (lufs < absoluteGateLufs)
+        return;
+    const int bin = std::min(histogramBins - 1, int((lufs - absoluteGateLufs) * histogramBinsPerLu));
+    ++counts[bin];
+    energies[bin] += energy;
+    ++total;
+    totalEnergy += energy;
+}
+
+int LoudnessMeter::Histogram::gateBin(double relativeLu) const
+{
+    if (total == 0)
+        return histogramBins;
+    const double gate = toLufs(totalEnergy / total) + relativeLu;
+    return qBound(0, int((gate - absoluteGateLufs) * histogramBinsPerLu), histogramBins);
+}
+
+LoudnessMeter::Result LoudnessMeter::measure(const QVector<QVector<double>> &channels,
+                                             quint32 sampleRate,
+                                             int threads)
+{
+    LoudnessMeter meter(sampleRate, int(channels.size()));
+    if (meter.m_channels == 0)
+        return meter.result();
+
+    const qint64 stepLength = meter.m_stepLength;
+    const qint64 steps = channels.first().size() / stepLength; // Неполный последний шаг не учитывается
+    const int segments = int(qBound<qint64>(1, steps / minSegmentSteps, qMax(1, threads)));
+
+    QVector<QVector<double>> energies(segments);
+    const auto measureSegment = [&](int segment) {
+        const qint64 first = steps * segment / segments;
+        const qint64 last = steps * (segment + 1) / segments;
+        const qint64 warmup = std::min<qint64>(first, warmupSteps);
+
+        LoudnessMeter part(sampleRate, meter.m_channels);
+        const double *data[maxChannels];
+        for (int c = 0; c < part.m_channels; ++c)
+            data[c] = channels[c].constData() + (first - warmup) * stepLength;
+        part.process(data, warmup * stepLength);
+
+        energies[segment].reserve(last - first);
+        part.m_stepLog = &energies[segment];
+        for (int c = 0; c < part.m_channels; ++c)
+            data[c] = channels[c].constData() + first * stepLength;
+        part.process(data, (last - first) * stepLength);
+    };
+
+    if (segments == 1) {
+        measureSegment(0);
+    } else {
+        QThreadPool pool;
+        pool.setMaxThreadCount(segments);
+        for (int s = 0; s < segments; ++s)
+            pool.start([&measureSegment, s] { measureSegment(s); });
+        pool.waitForDone();
+    }
+
+    for (const QVector<double> &segment : std::as_const(energies))
+        for (double energy : segment)
+            meter.addStep(energy);
+    return meter.result();
+}
@@ -0,0 +1,89 @@
+#include "reassignedspectrogram.h"
+#include <algorithm>
+#include <cmath>
+
+ReassignedSpectrogram::ReassignedSpectrogram(int fftSize)
+    : m_fftSize(fftSize)
+    , m_cfg(kiss_fftr_alloc(fftSize, 0, nullptr, nullptr))
+    , m_window(fftSize)
+    , m_timeWindow(fftSize)
+    , m_derivWindow(fftSize)
+    , m_input(fftSize)
+    , m_spec(fftSize / 2 + 1)
+    , m_specTime(fftSize / 2 + 1)
+    , m_specDeriv(fftSize / 2 + 1)
+{
+    // Окно Ханна, его взвешенная по времени версия и производная
+    const double center = (fftSize - 1) / 2.0;
+    const double step = 2 * M_PI / (fftSize - 1);
+    for (int i = 0; i < fftSize; ++i) {
+        m_window[i] = 0.5 * (1 - cos(step * i));
+        m_timeWindow[i] = (i - center) * m_window[i];
+        m_derivWindow[i] = 0.5 * step * sin(step * i);
+    }
+}
+
+ReassignedSpectrogram::~ReassignedSpectrogram()
+{
+    kiss_fftr_free(m_cfg);
+}
+
+void ReassignedSpectrogram::computeFrames(const double *samples,
+                                          qint64 sampleCount,
+                                          qint64 hop,
+                                          qint64 firstFrame,
+                                          int frameCount,
+                                          float *out)
+{
+    const int bins = binCount();
+    m_energy.fill(0.0, qsizetype(frameCount) * bins);
+
+    if (!m_cfg || sampleCount < m_fftSize || frameCount <= 0 || hop <= 0) {
+        std::fill(out, out + qsizetype(frameCount) * bins, 0.0f);
+        return;
+    }
+
+    const qint64 totalFrames = (sampleCount - m_fftSize) / hop + 1;
+    const double binPerRad = m_fftSize / (2 * M_PI);
+
+    // Энергия может сместиться не более чем на половину окна
+    const qint64 margin = (m_fftSize / 2) / hop + 1;
+    const qint64 begin = qMax<qint64>(0, firstFrame - margin);
+    const qint64 end = qMin<qint64>(totalFrames, firstFrame + frameCount + margin);
+
+    auto transform = [this](const double *in, const QVector<double> &window, kiss_fft_cpx *dst) {
+        for (int i = 0; i < m_fftSize; ++i)
+            m_input[i] = kiss_fft_scalar(in[i] * window[i]);
+        kiss_fftr(m_cfg, m_input.data(), dst);
+    };
+
+    for (qint64 frame = begin; frame < end; ++frame) {
+        const double *in = samples + frame * hop;
+        transform(in, m_window, m_spec.data());
+        transform(in, m_timeWindow, m_specTime.data());
+        transform(in, m_derivWindow, m_specDeriv.data());
+
+        for (int k = 0; k < bins; ++k) {
+            const double re = m_spec[k].r;
+            const double im = m_spec[k].i;
+            const double power = re * re + im * im;
+            if (power < 1e-12)
+                continue;
+
+            // Сдвиг по времени: Re(X_th / X_h), по частоте: -Im(X_dh / X_h)
+            const double dt = (m_specTime[k].r * re + m_specTime[k].i * im) / power;
+            const double dw = -(m_specDeriv[k].i * re - m_specDeriv[k].r * im) / power;
+
+            const double framePos = frame + dt / hop; // Центр кадра frame + dt, в единицах шага
+            const qint64 col = qint64(std::floor(framePos + 0.5)) - firstFrame;
+            const int bin = int(std::floor(k + dw * binPerRad + 0.5));
+            if (col < 0 || col >= frameCount || bin < 0 || bin >= bins)
+                continue;
+
+            m_energy[col * bins + bin] += power;
+        }
+    }
+
+    for (qsizetype i = 0; i < m_energy.size(); ++i)
+        out[i] = float(std::sqrt(m_energy[i]));
+}
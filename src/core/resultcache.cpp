@@ -0,0 +1,112 @@
+#include "resultcache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+ResultCache::ResultCache(const QString &directory, qint64 memoryLimitBytes)
+    : m_directory(directory)
+{
+    m_memory.setMaxCost(memoryLimitBytes);
+    QDir().mkpath(directory);
+}
+
+QString ResultCache::keyFor(const QString &filePath, int version, QString &errorString)
+{
+    const QFileInfo info(filePath);
+    const QString path = info.canonicalFilePath();
+    if (path.isEmpty() || !info.isFile()) {
+        errorString = tr("Файл не найден: %1").arg(filePath);
+        return {};
+    }
+
+    {
+        QMutexLocker lock(&m_mutex);
+        const auto it = m_fingerprints.constFind(path);
+        if (it != m_fingerprints.constEnd() && it->size == info.size()
+            && it->modified == info.lastModified())
+            return it->key;
+    }
+
+    // Хеширование без блокировки: файлы могут быть большими
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorString = tr("Не удалось открыть файл %1").arg(filePath);
+        return {};
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(QByteArray::number(version) + '\n');
+    qint64 hashed = 0;
+    while (!file.atEnd()) {
+        const QByteArray chunk = file.read(hashChunk);
+        if (chunk.isEmpty())
+            break;
+        hash.addData(chunk);
+        hashed += chunk.size();
+    }
+    const QString key = QString::fromLatin1(hash.result().toHex());
+
+    QMutexLocker lock(&m_mutex);
+    if (m_fingerprints.size() >= maxFingerprints)
+        m_fingerprints.clear(); // Редкий сброс вместо учёта давности
+    m_fingerprints.insert(path, {info.size(), info.lastModified(), key});
+    m_stats.hashedBytes += hashed;
+    return key;
+}
+
+QString ResultCache::pathFor(const QString &key) const
+{
+    return QDir(m_directory).filePath(key.left(2) + '/' + key + ".json");
+}
+
+QByteArray ResultCache::find(const QString &key)
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        if (const QByteArray *value = m_memory.object(key)) {
+            ++m_stats.memoryHits;
+            return *value;
+        }
+    }
+
+    QFile file(pathFor(key));
+    QByteArray value;
+    if (file.open(QIODevice::ReadOnly))
+        value = file.readAll();
+
+    QMutexLocker lock(&m_mutex);
+    if (value.isEmpty()) {
+        ++m_stats.misses;
+        return {};
+    }
+    ++m_stats.diskHits;
+    m_memory.insert(key, new QByteArray(value), value.size());
+    return value;
+}
+
+void ResultCache::insert(const QString &key, const QByteArray &value)
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        m_memory.insert(key, new QByteArray(value), value.size());
+    }
+
+    // Запись на диск целиком или никак; сбой записи - только потеря кэша
+    const QString path = pathFor(key);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(value);
+        file.commit();
+    }
+}
+
+ResultCache::Stats ResultCache::stats() const
+{
+    QMutexLocker lock(&m_mutex);
+    Stats stats = m_stats;
+    stats.memoryEntries = m_memory.count();
+    stats.memoryBytes = m_memory.totalCost();
+    return stats;
+}
@@ -0,0 +1,247 @@
+#include "resultexport.h"
+#include "audiofeatures.h"
+#include "bufferedwriter.h"
+#include "spectrogramcache.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QtEndian>
+#include <cmath>
+
+namespace ResultExport {
+
+namespace {
+
+constexpr int stripFrames = 256; // Кадров спектрограммы за одну полосу
+
+QString tr(const char *text)
+{
+    return QCoreApplication::translate("ResultExport", text);
+}
+
+bool open(QSaveFile &file, QString &errorString)
+{
+    if (file.open(QIODevice::WriteOnly))
+        return true;
+    errorString = tr("Не удалось создать %1").arg(file.fileName());
+    return false;
+}
+
+bool commit(QSaveFile &file, bool written, QString &errorString)
+{
+    if (written && file.commit())
+        return true;
+    file.cancelWriting();
+    errorString = tr("Ошибка записи %1").arg(file.fileName());
+    return false;
+}
+
+bool isTextFormat(Format format)
+{
+    return format == Format::Csv || format == Format::JsonLines;
+}
+
+} // namespace
+
+Format formatForFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "jsonl" || suffix == "json")
+        return Format::JsonLines;
+    if (suffix == "npy")
+        return Format::Npy;
+    if (suffix == "f32")
+        return Format::RawFloat;
+    return Format::Csv;
+}
+
+bool writeMetadata(const QString &filePath,
+                   const QString &sourceFile,
+                   const AudioModel::Meta &meta,
+                   QString &errorString)
+{
+    QSaveFile file(filePath);
+    if (!open(file, errorString))
+        return false;
+
+    bool written = false;
+    if (formatForFile(filePath) == Format::JsonLines) {
+        JsonLinesWriter out(&file);
+        out.write(QJsonObject{
+            {"file", sourceFile},
+            {"durationSeconds", meta.durationSeconds},
+            {"sampleRate", qint64(meta.sampleRate)},
+            {"channels", meta.channels},
+            {"bitsPerSample", meta.bitsPerSample},
+            {"bitRate", qint64(meta.bitRate)},
+            {"peakDb", meta.peakDb},
+            {"rmsDb", meta.rmsDb},
+            {"integratedLufs", meta.integratedLufs},
+            {"loudnessRangeLu", meta.loudnessRangeLu},
+            {"maxMomentaryLufs", meta.maxMomentaryLufs},
+            {"maxShortTermLufs", meta.maxShortTermLufs},
+        });
+        written = out.finish();
+    } else {
+        CsvWriter out(&file);
+        out.writeHeader({"file", "duration_s", "sample_rate", "channels", "bits_per_sample",
+                         "bit_rate", "peak_db", "rms_db", "integrated_lufs", "loudness_range_lu",
+                         "max_momentary_lufs", "max_short_term_lufs"});
+        out.field(sourceFile)
+            .field(meta.durationSeconds, 10)
+            .field(qint64(meta.sampleRate))
+            .field(qint64(meta.channels))
+            .field(qint64(meta.bitsPerSample))
+            .field(qint64(meta.bitRate))
+            .field(meta.peakDb)
+            .field(meta.rmsDb)
+            .field(meta.integratedLufs)
+            .field(meta.loudnessRangeLu)
+            .field(meta.maxMomentaryLufs)
+            .field(meta.maxShortTermLufs);
+        out.endRow();
+        written = out.finish();
+    }
+    return commit(file, written, errorString);
+}
+
+bool writeSpectrum(const QString &filePath,
+                   const QVector<double> &frequencies,
+                   const QVector<double> &db,
+                   QString &errorString)
+{
+    const qsizetype count = qMin(frequencies.size(), db.size());
+    QSaveFile file(filePath);
+    if (!open(file, errorString))
+        return false;
+
+    bool written = false;
+    if (formatForFile(filePath) == Format::JsonLines) {
+        JsonLinesWriter out(&file);
+        for (qsizetype i = 0; i < count; ++i)
+            out.write(QJsonObject{{"frequencyHz", frequencies[i]}, {"db", db[i]}});
+        written = out.finish();
+    } else {
+        CsvWriter out(&file);
+        out.writeHeader({"frequency_hz", "db"});
+        for (qsizetype i = 0; i < count; ++i) {
+            out.field(frequencies[i]).field(db[i]);
+            out.endRow();
+        }
+        written = out.finish();
+    }
+    return commit(file, written, errorString);
+}
+
+bool writeSpectrogram(const QString &filePath,
+                      const QVector<double> &samples,
+                      int hop,
+                      QString &errorString,
+                      const std::atomic_bool *cancel)
+{
+    const Format format = formatForFile(filePath);
+    if (isTextFormat(format)) {
+        errorString = tr("Спектрограмма сохраняется только в .npy или .f32");
+        return false;
+    }
+
+    const int bins = SpectrogramCache::binCount;
+    const qint64 frames = SpectrogramCache::frameCountFor(samples.size(), hop);
+    if (format == Format::RawFloat && frames > 0xffffffffLL) {
+        errorString = tr("Слишком длинная запись для формата f32");
+        return false;
+    }
+
+    QSaveFile file(filePath);
+    if (!open(file, errorString))
+        return false;
+
+    // Заголовок: NPY дописывает число строк в конце, "AFSG" знает его сразу
+    NpyWriter npy(&file);
+    BufferedWriter raw(&file);
+    if (format == Format::Npy) {
+        npy.begin(bins);
+    } else {
+        raw.write("AFSG", 4);
+        const quint32 shape[2] = {qToLittleEndian(quint32(qMax<qint64>(0, frames))),
+                                  qToLittleEndian(quint32(bins))};
+        raw.write(reinterpret_cast<const char *>(shape), sizeof(shape));
+    }
+
+    QVector<float> strip(stripFrames * bins);
+    for (qint64 first = 0; first < frames; first += stripFrames) {
+        if (cancel && cancel->load()) {
+            file.cancelWriting();
+            errorString = tr("Экспорт отменён");
+            return false;
+        }
+
+        const int n = int(qMin<qint64>(stripFrames, frames - first));
+        SpectrogramCache::computeFrames(samples,
+                                        SpectrogramCache::Mode::Standard,
+                                        hop,
+                                        first,
+                                        n,
+                                        strip.data());
+        const qsizetype count = qsizetype(n) * bins;
+        for (qsizetype i = 0; i < count; ++i)
+            strip[i] = float(20 * std::log10(strip[i] + 1e-12));
+
+        if (format == Format::Npy)
+            npy.appendRows(strip.constData(), n);
+        else
+            raw.writeFloats(strip.constData(), count);
+    }
+
+    const bool written = format == Format::Npy ? npy.finish() : raw.flush();
+    return commit(file, written, errorString);
+}
+
+bool writeFeatureSeries(const QString &filePath,
+                        const QVector<double> &samples,
+                        quint32 sampleRate,
+                        QString &errorString)
+{
+    QSaveFile file(filePath);
+    if (!open(file, errorString))
+        return false;
+
+    const double rate = qMax<quint32>(1, sampleRate);
+    bool written = false;
+    if (formatForFile(filePath) == Format::JsonLines) {
+        JsonLinesWriter out(&file);
+        AudioFeatures::forEachFrame(samples, sampleRate, [&](const AudioFeatures::Frame &f) {
+            out.write(QJsonObject{
+                {"timeSeconds", f.endSample / rate},
+                {"rmsDb", f.rmsDb},
+                {"zeroCrossingRate", f.zeroCrossingRate},
+                {"spectralCentroidHz", f.spectralCentroidHz},
+                {"spectralSpreadHz", f.spectralSpreadHz},
+                {"spectralRolloffHz", f.spectralRolloffHz},
+                {"spectralFlatness", f.spectralFlatness},
+                {"spectralFlux", f.spectralFlux},
+            });
+        });
+        written = out.finish();
+    } else {
+        CsvWriter out(&file);
+        out.writeHeader({"time_s", "rms_db", "zero_crossing_rate", "centroid_hz", "spread_hz",
+                         "rolloff_hz", "flatness", "flux"});
+        AudioFeatures::forEachFrame(samples, sampleRate, [&](const AudioFeatures::Frame &f) {
+            out.field(f.endSample / rate, 9)
+                .field(f.rmsDb)
+                .field(f.zeroCrossingRate)
+                .field(f.spectralCentroidHz)
+                .field(f.spectralSpreadHz)
+                .field(f.spectralRolloffHz)
+                .field(f.spectralFlatness)
+                .field(f.spectralFlux);
+            out.endRow();
+        });
+        written = out.finish();
+    }
+    return commit(file, written, errorString);
+}
+
+} // namespace ResultExport
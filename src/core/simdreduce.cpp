@@ -0,0 +1,367 @@
+#include "simdreduce.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMDREDUCE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang собирают функции AVX2 без глобального -mavx2, MSVC - без атрибутов
+#if defined(SIMDREDUCE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMDREDUCE_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMDREDUCE_AVX2
+#endif
+
+namespace SimdReduce {
+
+namespace {
+
+constexpr double int16Scale = 1.0 / 32768.0;
+
+// Скалярные ядра, они же дочитывают хвосты векторных
+template<typename T>
+void scalarAccumulate(const T *data, qsizetype count, double &mn, double &mx, double &sq)
+{
+    for (qsizetype i = 0; i < count; ++i) {
+        const double v = double(data[i]);
+        mn = std::min(mn, v);
+        mx = std::max(mx, v);
+        sq += v * v;
+    }
+}
+
+template<typename T>
+Result scalarReduce(const T *data, qsizetype count, double scale)
+{
+    Result result;
+    if (count <= 0)
+        return result;
+
+    double mn = double(data[0]);
+    double mx = mn;
+    double sq = 0.0;
+    scalarAccumulate(data, count, mn, mx, sq);
+    result.min = float(mn * scale);
+    result.max = float(mx * scale);
+    result.sumSquares = sq * scale * scale;
+    return result;
+}
+
+#ifdef SIMDREDUCE_X86
+
+double horizontalMin(__m128d v)
+{
+    return std::min(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)));
+}
+
+double horizontalMax(__m128d v)
+{
+    return std::max(_mm_cvtsd_f64(v), _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)));
+}
+
+double horizontalSum(__m128d v)
+{
+    return _mm_cvtsd_f64(v) + _mm_cvtsd_f64(_mm_unpackhi_pd(v, v));
+}
+
+// ---- SSE2 ----
+
+Result sse2Reduce(const float *data, qsizetype count)
+{
+    if (count < 4)
+        return scalarReduce(data, count, 1.0);
+
+    __m128 vmin = _mm_loadu_ps(data);
+    __m128 vmax = vmin;
+    __m128d sqLo = _mm_setzero_pd();
+    __m128d sqHi = _mm_setzero_pd();
+
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_loadu_ps(data + i);
+        vmin = _mm_min_ps(vmin, v);
+        vmax = _mm_max_ps(vmax, v);
+        const __m128d lo = _mm_cvtps_pd(v);
+        const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+        sqLo = _mm_add_pd(sqLo, _mm_mul_pd(lo, lo));
+        sqHi = _mm_add_pd(sqHi, _mm_mul_pd(hi, hi));
+    }
+
+    alignas(16) float mins[4];
+    alignas(16) float maxs[4];
+    _mm_store_ps(mins, vmin);
+    _mm_store_ps(maxs, vmax);
+    double mn = *std::min_element(mins, mins + 4);
+    double mx = *std::max_element(maxs, maxs + 4);
+    double sq = horizontalSum(_mm_add_pd(sqLo, sqHi));
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn), float(mx), sq};
+}
+
+Result sse2Reduce(const double *data, qsizetype count)
+{
+    if (count < 2)
+        return scalarReduce(data, count, 1.0);
+
+    __m128d vmin = _mm_loadu_pd(data);
+    __m128d vmax = vmin;
+    __m128d vsq = _mm_setzero_pd();
+
+    qsizetype i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d v = _mm_loadu_pd(data + i);
+        vmin = _mm_min_pd(vmin, v);
+        vmax = _mm_max_pd(vmax, v);
+        vsq = _mm_add_pd(vsq, _mm_mul_pd(v, v));
+    }
+
+    double mn = horizontalMin(vmin);
+    double mx = horizontalMax(vmax);
+    double sq = horizontalSum(vsq);
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn), float(mx), sq};
+}
+
+Result sse2Reduce(const qint16 *data, qsizetype count)
+{
+    if (count < 8)
+        return scalarReduce(data, count, int16Scale);
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmin = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+    __m128i vmax = vmin;
+    __m128i vsq = _mm_setzero_si128(); // 2 x uint64
+
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        vmin = _mm_min_epi16(vmin, v);
+        vmax = _mm_max_epi16(vmax, v);
+        // Сумма пар квадратов не превышает 2^31 и помещается в uint32
+        const __m128i pairs = _mm_madd_epi16(v, v);
+        vsq = _mm_add_epi64(vsq, _mm_unpacklo_epi32(pairs, zero));
+        vsq = _mm_add_epi64(vsq, _mm_unpackhi_epi32(pairs, zero));
+    }
+
+    alignas(16) qint16 mins[8];
+    alignas(16) qint16 maxs[8];
+    alignas(16) quint64 sums[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(mins), vmin);
+    _mm_store_si128(reinterpret_cast<__m128i *>(maxs), vmax);
+    _mm_store_si128(reinterpret_cast<__m128i *>(sums), vsq);
+
+    double mn = *std::min_element(mins, mins + 8);
+    double mx = *std::max_element(maxs, maxs + 8);
+    double sq = double(sums[0] + sums[1]);
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn * int16Scale), float(mx * int16Scale), sq * int16Scale * int16Scale};
+}
+
+// ---- AVX2 ----
+
+SIMDREDUCE_AVX2 Result avx2Reduce(const float *data, qsizetype count)
+{
+    if (count < 8)
+        return scalarReduce(data, count, 1.0);
+
+    __m256 vmin = _mm256_loadu_ps(data);
+    __m256 vmax = vmin;
+    __m256d sqLo = _mm256_setzero_pd();
+    __m256d sqHi = _mm256_setzero_pd();
+
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(data + i);
+        vmin = _mm256_min_ps(vmin, v);
+        vmax = _mm256_max_ps(vmax, v);
+        const __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(v));
+        const __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1));
+        sqLo = _mm256_add_pd(sqLo, _mm256_mul_pd(lo, lo));
+        sqHi = _mm256_add_pd(sqHi, _mm256_mul_pd(hi, hi));
+    }
+
+    alignas(32) float mins[8];
+    alignas(32) float maxs[8];
+    alignas(32) double sums[4];
+    _mm256_store_ps(mins, vmin);
+    _mm256_store_ps(maxs, vmax);
+    _mm256_store_pd(sums, _mm256_add_pd(sqLo, sqHi));
+
+    double mn = *std::min_element(mins, mins + 8);
+    double mx = *std::max_element(maxs, maxs + 8);
+    double sq = sums[0] + sums[1] + sums[2] + sums[3];
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn), float(mx), sq};
+}
+
+SIMDREDUCE_AVX2 Result avx2Reduce(const double *data, qsizetype count)
+{
+    if (count < 4)
+        return scalarReduce(data, count, 1.0);
+
+    __m256d vmin = _mm256_loadu_pd(data);
+    __m256d vmax = vmin;
+    __m256d vsq = _mm256_setzero_pd();
+
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d v = _mm256_loadu_pd(data + i);
+        vmin = _mm256_min_pd(vmin, v);
+        vmax = _mm256_max_pd(vmax, v);
+        vsq = _mm256_add_pd(vsq, _mm256_mul_pd(v, v));
+    }
+
+    alignas(32) double mins[4];
+    alignas(32) double maxs[4];
+    alignas(32) double sums[4];
+    _mm256_store_pd(mins, vmin);
+    _mm256_store_pd(maxs, vmax);
+    _mm256_store_pd(sums, vsq);
+
+    double mn = *std::min_element(mins, mins + 4);
+    double mx = *std::max_element(maxs, maxs + 4);
+    double sq = sums[0] + sums[1] + sums[2] + sums[3];
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn), float(mx), sq};
+}
+
+SIMDREDUCE_AVX2 Result avx2Reduce(const qint16 *data, qsizetype count)
+{
+    if (count < 16)
+        return scalarReduce(data, count, int16Scale);
+
+    __m256i vmin = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data));
+    __m256i vmax = vmin;
+    __m256i vsq = _mm256_setzero_si256(); // 4 x uint64
+
+    qsizetype i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        vmin = _mm256_min_epi16(vmin, v);
+        vmax = _mm256_max_epi16(vmax, v);
+        // Сумма пар квадратов не превышает 2^31 и помещается в uint32
+        const __m256i pairs = _mm256_madd_epi16(v, v);
+        vsq = _mm256_add_epi64(vsq, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(pairs)));
+        vsq = _mm256_add_epi64(vsq, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pairs, 1)));
+    }
+
+    alignas(32) qint16 mins[16];
+    alignas(32) qint16 maxs[16];
+    alignas(32) quint64 sums[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(mins), vmin);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maxs), vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(sums), vsq);
+
+    double mn = *std::min_element(mins, mins + 16);
+    double mx = *std::max_element(maxs, maxs + 16);
+    double sq = double(sums[0] + sums[1] + sums[2] + sums[3]);
+    scalarAccumulate(data + i, count - i, mn, mx, sq);
+
+    return {float(mn * int16Scale), float(mx * int16Scale), sq * int16Scale * int16Scale};
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool osxsave = info[2] & (1 << 27);
+    const bool avx = info[2] & (1 << 28);
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // SIMDREDUCE_X86
+
+template<typename T>
+Result dispatch(const T *data, qsizetype count, Kernel kernel, double scalarScale)
+{
+#ifdef SIMDREDUCE_X86
+    if (kernel == Kernel::Avx2 && isSupported(Kernel::Avx2))
+        return avx2Reduce(data, count);
+    if (kernel != Kernel::Scalar)
+        return sse2Reduce(data, count);
+#else
+    Q_UNUSED(kernel);
+#endif
+    return scalarReduce(data, count, scalarScale);
+}
+
+} // namespace
+
+Kernel bestKernel()
+{
+    static const Kernel kernel = [] {
+#ifdef SIMDREDUCE_X86
+        return cpuHasAvx2() ? Kernel::Avx2 : Kernel::Sse2;
+#else
+        return Kernel::Scalar;
+#endif
+    }();
+    return kernel;
+}
+
+bool isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+    case Kernel::Sse2:
+#ifdef SIMDREDUCE_X86
+        return true;
+#else
+        return false;
+#endif
+    case Kernel::Avx2:
+        return bestKernel() == Kernel::Avx2;
+    }
+    return false;
+}
+
+const char *kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return "scalar";
+    case Kernel::Sse2:
+        return "sse2";
+    case Kernel::Avx2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+Result reduce(const float *data, qsizetype count, Kernel kernel)
+{
+    return dispatch(data, count, kernel, 1.0);
+}
+
+Result reduce(const double *data, qsizetype count, Kernel kernel)
+{
+    return dispatch(data, count, kernel, 1.0);
+}
+
+Result reduce(const qint16 *data, qsizetype count, Kernel kernel)
+{
+    return dispatch(data, count, kernel, int16Scale);
+}
+
+} // namespace SimdReduce
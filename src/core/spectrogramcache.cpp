@@ -0,0 +1,256 @@
+#include "spectrogramcache.h"
+#include "reassignedspectrogram.h"
+#include <QThread>
+#include <cmath>
+
+extern "C" {
+#include <kiss_fftr.h>
+}
+
+SpectrogramCache::SpectrogramCache(QObject *parent)
+    : QObject(parent)
+{
+    m_tiles.setMaxCost(256 * 1024 * 1024); // Не более 256 МБ плиток в памяти
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+SpectrogramCache::~SpectrogramCache()
+{
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+// Установка новых данных: старые плитки и очередь сбрасываются
+void SpectrogramCache::setSamples(const QVector<double> &samples, quint32 sampleRate)
+{
+    m_pool.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_generation;
+        m_samples = samples;
+        m_sampleRate = sampleRate;
+        m_tiles.clear();
+        m_pending.clear();
+        m_running.clear();
+
+        // Уровней столько, чтобы самый грубый умещался в одну плитку
+        m_levelCount = 0;
+        if (m_samples.size() >= fftSize) {
+            m_levelCount = 1;
+            while (m_levelCount < maxLevels
+                   && frameCount(m_levelCount - 1) > tileFrames) {
+                ++m_levelCount;
+            }
+        }
+    }
+    emit samplesChanged();
+}
+
+void SpectrogramCache::clear()
+{
+    setSamples({}, 0);
+}
+
+// Смена способа расчёта: плитки другого режима остаются в кэше
+void SpectrogramCache::setMode(Mode mode)
+{
+    if (mode == m_mode)
+        return;
+
+    m_pool.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_mode = mode;
+        m_pending = m_running;
+    }
+    emit modeChanged();
+}
+
+qint64 SpectrogramCache::sampleCount() const
+{
+    return m_samples.size();
+}
+
+quint32 SpectrogramCache::sampleRate() const
+{
+    return m_sampleRate;
+}
+
+int SpectrogramCache::levelCount() const
+{
+    return m_levelCount;
+}
+
+qint64 SpectrogramCache::frameCount(int level) const
+{
+    return frameCountFor(m_samples.size(), hopForLevel(level));
+}
+
+int SpectrogramCache::levelForResolution(double samplesPerColumn) const
+{
+    if (m_levelCount == 0)
+        return 0;
+
+    int level = 0;
+    while (level + 1 < m_levelCount && hopForLevel(level + 1) <= samplesPerColumn)
+        ++level;
+    return level;
+}
+
+SpectrogramCache::Tile SpectrogramCache::tile(int level, qint64 tileIndex)
+{
+    QMutexLocker locker(&m_mutex);
+    Tile *cached = m_tiles.object(tileKey(m_mode, level, tileIndex));
+    return cached ? *cached : Tile();
+}
+
+void SpectrogramCache::requestFrames(int level, qint64 firstFrame, qint64 lastFrame, bool prefetch)
+{
+    if (level < 0 || level >= m_levelCount)
+        return;
+
+    const qint64 frames = frameCount(level);
+    if (frames <= 0)
+        return;
+
+    const qint64 lastTile = (frames - 1) / tileFrames;
+    const qint64 first = qBound<qint64>(0, firstFrame / tileFrames, lastTile);
+    const qint64 last = qBound<qint64>(first, lastFrame / tileFrames, lastTile);
+
+    // Ещё не начатые задачи устарели: видимая область сменилась
+    m_pool.clear();
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending = m_running;
+    }
+
+    for (qint64 t = first; t <= last; ++t)
+        scheduleTile(level, t, 2);
+
+    if (!prefetch)
+        return;
+
+    // Соседние участки слева и справа, ближние плитки раньше дальних
+    const qint64 span = last - first + 1;
+    for (qint64 d = 1; d <= span; ++d) {
+        if (last + d <= lastTile)
+            scheduleTile(level, last + d, 1);
+        if (first - d >= 0)
+            scheduleTile(level, first - d, 1);
+    }
+
+    // Более грубый уровень нужен как заглушка при отдалении
+    if (level + 1 < m_levelCount)
+        scheduleTile(level + 1, first / 2, 0);
+}
+
+void SpectrogramCache::scheduleTile(int level, qint64 tileIndex, int priority)
+{
+    const Mode mode = m_mode;
+    const quint64 key = tileKey(mode, level, tileIndex);
+    QVector<double> samples;
+    quint64 generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_tiles.contains(key) || m_pending.contains(key))
+            return;
+        m_pending.insert(key);
+        samples = m_samples; // Неявное разделение данных, без копирования
+        generation = m_generation;
+    }
+
+    m_pool.start(
+        [this, samples, generation, mode, level, tileIndex, key]() {
+            {
+                QMutexLocker locker(&m_mutex);
+                if (generation != m_generation)
+                    return;
+                m_running.insert(key);
+            }
+
+            auto data = QSharedPointer<QVector<float>>::create(
+                computeTile(samples, mode, level, tileIndex));
+
+            {
+                QMutexLocker locker(&m_mutex);
+                m_running.remove(key);
+                m_pending.remove(key);
+                if (generation != m_generation)
+                    return;
+                m_tiles.insert(key, new Tile(data), int(data->size() * sizeof(float)));
+            }
+            emit tileReady(level, tileIndex);
+        },
+        priority);
+}
+
+// Расчёт магнитуд для кадров одной плитки
+QVector<float> SpectrogramCache::computeTile(const QVector<double> &samples,
+                                             Mode mode,
+                                             int level,
+                                             qint64 tileIndex)
+{
+    QVector<float> result(tileFrames * binCount, 0.0f);
+
+    const qint64 hop = hopForLevel(level);
+    const qint64 firstFrame = tileIndex * tileFrames;
+    const qint64 endFrame = qMin(firstFrame + tileFrames, frameCountFor(samples.size(), hop));
+    if (endFrame > firstFrame)
+        computeFrames(samples, mode, hop, firstFrame, int(endFrame - firstFrame), result.data());
+    return result;
+}
+
+qint64 SpectrogramCache::frameCountFor(qint64 sampleCount, qint64 hop)
+{
+    if (sampleCount < fftSize || hop <= 0)
+        return 0;
+    return (sampleCount - fftSize) / hop + 1;
+}
+
+// Расчёт магнитуд кадров [firstFrame, firstFrame + frameCount) (окно Ханна, как в calculateSpectrogram)
+void SpectrogramCache::computeFrames(const QVector<double> &samples,
+                                     Mode mode,
+                                     qint64 hop,
+                                     qint64 firstFrame,
+                                     int frameCount,
+                                     float *out)
+{
+    if (mode == Mode::Reassigned) {
+        // Свой экземпляр на поток: кадры разных плиток считаются параллельно
+        thread_local ReassignedSpectrogram engine(fftSize);
+        engine.computeFrames(samples.constData(), samples.size(), hop, firstFrame, frameCount, out);
+        return;
+    }
+
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(fftSize, 0, nullptr, nullptr);
+    if (!cfg)
+        return;
+
+    static const QVector<double> window = [] {
+        QVector<double> w(fftSize);
+        for (int i = 0; i < fftSize; ++i)
+            w[i] = 0.5 * (1 - cos(2 * M_PI * i / (fftSize - 1)));
+        return w;
+    }();
+
+    QVector<kiss_fft_scalar> input(fftSize);
+    QVector<kiss_fft_cpx> output(fftSize / 2 + 1);
+    const double *src = samples.constData();
+
+    for (int f = 0; f < frameCount; ++f) {
+        const double *in = src + (firstFrame + f) * hop;
+        for (int i = 0; i < fftSize; ++i)
+            input[i] = kiss_fft_scalar(in[i] * window[i]);
+
+        kiss_fftr(cfg, input.data(), output.data());
+
+        float *mags = out + qsizetype(f) * binCount;
+        for (int i = 0; i < binCount; ++i) {
+            const double re = output[i].r;
+            const double im = output[i].i;
+            mags[i] = float(std::sqrt(re * re + im * im));
+        }
+    }
+
+    kiss_fftr_free(cfg);
+}
@@ -0,0 +1,116 @@
+#include "spectrumanalyzer.h"
+#include <QThread>
+#include <cmath>
+#include <kiss_fftr.h>
+
+SpectrumAnalyzer::SpectrumAnalyzer(QObject *parent)
+    : QObject(parent)
+{
+    // Слоты выделяются заранее, в потоке анализа память не выделяется
+    m_output.initialize([](Frame &frame) { frame.magnitudesDb.resize(binCount); });
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    stop();
+}
+
+void SpectrumAnalyzer::setReader(Reader reader)
+{
+    Q_ASSERT(!isRunning());
+    m_reader = std::move(reader);
+}
+
+void SpectrumAnalyzer::start()
+{
+    if (m_thread || !m_reader)
+        return;
+    m_running = true;
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->setObjectName("SpectrumAnalyzer");
+    m_thread->start(QThread::HighPriority);
+}
+
+void SpectrumAnalyzer::stop()
+{
+    if (!m_thread)
+        return;
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_running = false;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+}
+
+bool SpectrumAnalyzer::takeFrame()
+{
+    m_notifyPending = false;
+    return m_output.update();
+}
+
+// Цикл потока анализа: дочитать всё из кольцевого буфера, посчитать спектр
+// окна, заканчивающегося на звучащем сэмпле, и опубликовать его
+void SpectrumAnalyzer::run()
+{
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(fftSize, 0, nullptr, nullptr);
+    if (!cfg)
+        return;
+
+    QVector<float> window(fftSize);
+    for (int i = 0; i < fftSize; ++i)
+        window[i] = float(0.5 * (1 - cos(2 * M_PI * i / (fftSize - 1))));
+
+    QVector<float> history(historySize, 0.0f);
+    QVector<float> chunk(readChunk);
+    QVector<kiss_fft_scalar> input(fftSize);
+    QVector<kiss_fft_cpx> output(fftSize / 2 + 1);
+    qint64 total = 0;     // Сколько сэмплов прочитано с последнего сброса
+    qint64 analyzed = -1; // Конец окна последнего посчитанного кадра
+    quint64 sequence = 0;
+
+    while (m_running) {
+        if (m_resetRequested.exchange(false)) {
+            total = 0;
+            analyzed = -1;
+        }
+
+        qsizetype got = 0;
+        while ((got = m_reader(chunk.data(), readChunk)) > 0) {
+            for (qsizetype i = 0; i < got; ++i)
+                history[(total + i) & (historySize - 1)] = chunk[i];
+            total += got;
+        }
+
+        const qint64 end = total - qMin<qint64>(m_latency, historySize - fftSize);
+        if (end < fftSize || end == analyzed) {
+            QMutexLocker locker(&m_waitMutex);
+            if (m_running)
+                m_wake.wait(&m_waitMutex, idleWaitMs);
+            continue;
+        }
+        analyzed = end;
+
+        for (int i = 0; i < fftSize; ++i)
+            input[i] = history[(end - fftSize + i) & (historySize - 1)] * window[i];
+        kiss_fftr(cfg, input.data(), output.data());
+
+        Frame &frame = m_output.writeBuffer();
+        for (int k = 0; k < binCount; ++k) {
+            const double amp = std::sqrt(double(output[k].r) * output[k].r
+                                         + double(output[k].i) * output[k].i);
+            frame.magnitudesDb[k] = float(20 * log10(amp + 1e-12));
+        }
+        frame.sampleRate = m_sampleRate;
+        frame.sequence = ++sequence;
+        m_output.publish();
+
+        // Одно уведомление на забранный кадр: очередь событий GUI не переполняется
+        if (!m_notifyPending.exchange(true))
+            QMetaObject::invokeMethod(this, &SpectrumAnalyzer::frameReady, Qt::QueuedConnection);
+    }
+
+    kiss_fftr_free(cfg);
+}
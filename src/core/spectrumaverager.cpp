@@ -0,0 +1,299 @@
+#include "spectrumaverager.h"
+#include "simdreduce.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define SPECTRUMAVERAGER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(SPECTRUMAVERAGER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SPECTRUMAVERAGER_AVX2 __attribute__((target("avx2")))
+#else
+#define SPECTRUMAVERAGER_AVX2
+#endif
+
+namespace {
+
+// ---- Скалярные ядра (и хвосты векторных) ----
+
+void scalarSmooth(float *avg, const float *x, qsizetype from, qsizetype count, float alpha)
+{
+    for (qsizetype i = from; i < count; ++i)
+        avg[i] += alpha * (x[i] - avg[i]);
+}
+
+void scalarAddSub(float *sum, const float *add, const float *sub, qsizetype from, qsizetype count)
+{
+    for (qsizetype i = from; i < count; ++i)
+        sum[i] += add[i] - sub[i];
+}
+
+void scalarScale(float *dst, const float *src, qsizetype from, qsizetype count, float k)
+{
+    for (qsizetype i = from; i < count; ++i)
+        dst[i] = src[i] * k;
+}
+
+void scalarDecayMax(float *peak, const float *x, qsizetype from, qsizetype count, float decay)
+{
+    for (qsizetype i = from; i < count; ++i)
+        peak[i] = std::max(x[i], peak[i] - decay);
+}
+
+#ifdef SPECTRUMAVERAGER_X86
+
+// ---- SSE2 ----
+
+void sse2Smooth(float *avg, const float *x, qsizetype count, float alpha)
+{
+    const __m128 a = _mm_set1_ps(alpha);
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 v = _mm_loadu_ps(avg + i);
+        const __m128 d = _mm_sub_ps(_mm_loadu_ps(x + i), v);
+        _mm_storeu_ps(avg + i, _mm_add_ps(v, _mm_mul_ps(a, d)));
+    }
+    scalarSmooth(avg, x, i, count, alpha);
+}
+
+void sse2AddSub(float *sum, const float *add, const float *sub, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 d = _mm_sub_ps(_mm_loadu_ps(add + i), _mm_loadu_ps(sub + i));
+        _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), d));
+    }
+    scalarAddSub(sum, add, sub, i, count);
+}
+
+void sse2Scale(float *dst, const float *src, qsizetype count, float k)
+{
+    const __m128 vk = _mm_set1_ps(k);
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(src + i), vk));
+    scalarScale(dst, src, i, count, k);
+}
+
+void sse2DecayMax(float *peak, const float *x, qsizetype count, float decay)
+{
+    const __m128 vd = _mm_set1_ps(decay);
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 decayed = _mm_sub_ps(_mm_loadu_ps(peak + i), vd);
+        _mm_storeu_ps(peak + i, _mm_max_ps(_mm_loadu_ps(x + i), decayed));
+    }
+    scalarDecayMax(peak, x, i, count, decay);
+}
+
+// ---- AVX2 ----
+
+SPECTRUMAVERAGER_AVX2 void avx2Smooth(float *avg, const float *x, qsizetype count, float alpha)
+{
+    const __m256 a = _mm256_set1_ps(alpha);
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 v = _mm256_loadu_ps(avg + i);
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(x + i), v);
+        _mm256_storeu_ps(avg + i, _mm256_add_ps(v, _mm256_mul_ps(a, d)));
+    }
+    scalarSmooth(avg, x, i, count, alpha);
+}
+
+SPECTRUMAVERAGER_AVX2 void avx2AddSub(float *sum, const float *add, const float *sub, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(add + i), _mm256_loadu_ps(sub + i));
+        _mm256_storeu_ps(sum + i, _mm256_add_ps(_mm256_loadu_ps(sum + i), d));
+    }
+    scalarAddSub(sum, add, sub, i, count);
+}
+
+SPECTRUMAVERAGER_AVX2 void avx2Scale(float *dst, const float *src, qsizetype count, float k)
+{
+    const __m256 vk = _mm256_set1_ps(k);
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), vk));
+    scalarScale(dst, src, i, count, k);
+}
+
+SPECTRUMAVERAGER_AVX2 void avx2DecayMax(float *peak, const float *x, qsizetype count, float decay)
+{
+    const __m256 vd = _mm256_set1_ps(decay);
+    qsizetype i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 decayed = _mm256_sub_ps(_mm256_loadu_ps(peak + i), vd);
+        _mm256_storeu_ps(peak + i, _mm256_max_ps(_mm256_loadu_ps(x + i), decayed));
+    }
+    scalarDecayMax(peak, x, i, count, decay);
+}
+
+#endif // SPECTRUMAVERAGER_X86
+
+// Выбор ядра один раз по возможностям процессора (как в SimdReduce)
+const SimdReduce::Kernel kernel = SimdReduce::bestKernel();
+
+void smooth(float *avg, const float *x, qsizetype count, float alpha)
+{
+#ifdef SPECTRUMAVERAGER_X86
+    if (kernel == SimdReduce::Kernel::Avx2)
+        return avx2Smooth(avg, x, count, alpha);
+    if (kernel == SimdReduce::Kernel::Sse2)
+        return sse2Smooth(avg, x, count, alpha);
+#endif
+    scalarSmooth(avg, x, 0, count, alpha);
+}
+
+void addSub(float *sum, const float *add, const float *sub, qsizetype count)
+{
+#ifdef SPECTRUMAVERAGER_X86
+    if (kernel == SimdReduce::Kernel::Avx2)
+        return avx2AddSub(sum, add, sub, count);
+    if (kernel == SimdReduce::Kernel::Sse2)
+        return sse2AddSub(sum, add, sub, count);
+#endif
+    scalarAddSub(sum, add, sub, 0, count);
+}
+
+void scale(float *dst, const float *src, qsizetype count, float k)
+{
+#ifdef SPECTRUMAVERAGER_X86
+    if (kernel == SimdReduce::Kernel::Avx2)
+        return avx2Scale(dst, src, count, k);
+    if (kernel == SimdReduce::Kernel::Sse2)
+        return sse2Scale(dst, src, count, k);
+#endif
+    scalarScale(dst, src, 0, count, k);
+}
+
+void decayMax(float *peak, const float *x, qsizetype count, float decay)
+{
+#ifdef SPECTRUMAVERAGER_X86
+    if (kernel == SimdReduce::Kernel::Avx2)
+        return avx2DecayMax(peak, x, count, decay);
+    if (kernel == SimdReduce::Kernel::Sse2)
+        return sse2DecayMax(peak, x, count, decay);
+#endif
+    scalarDecayMax(peak, x, 0, count, decay);
+}
+
+} // namespace
+
+void SpectrumAverager::setMode(Mode mode)
+{
+    if (mode == m_mode)
+        return;
+    m_mode = mode;
+    m_average.clear();
+    m_history.clear(); // Старое окно не должно попасть в новое среднее
+    m_sum.clear();
+    m_historyFill = 0;
+    m_historyIndex = 0;
+}
+
+void SpectrumAverager::setTimeConstant(double seconds)
+{
+    m_timeConstant = qMax(0.001, seconds);
+}
+
+void SpectrumAverager::setLinearCount(int frames)
+{
+    frames = qMax(1, frames);
+    if (frames == m_linearCount)
+        return;
+    m_linearCount = frames;
+    m_history.clear();
+    m_sum.clear();
+    m_historyFill = 0;
+    m_historyIndex = 0;
+}
+
+void SpectrumAverager::setPeakHold(bool enabled)
+{
+    m_peakHold = enabled;
+    if (!enabled)
+        m_peak.clear();
+}
+
+void SpectrumAverager::setPeakDecay(double dbPerSecond)
+{
+    m_peakDecay = qMax(0.0, dbPerSecond);
+}
+
+void SpectrumAverager::reset()
+{
+    m_current.clear();
+    m_average.clear();
+    m_peak.clear();
+    m_history.clear();
+    m_sum.clear();
+    m_historyFill = 0;
+    m_historyIndex = 0;
+}
+
+void SpectrumAverager::add(const float *db, int count, double dtSeconds)
+{
+    if (count != m_current.size())
+        reset();
+
+    m_current.resize(count);
+    std::memcpy(m_current.data(), db, count * sizeof(float));
+
+    switch (m_mode) {
+    case Mode::Off:
+        break;
+    case Mode::Exponential:
+        if (m_average.size() != count) {
+            m_average = m_current;
+        } else {
+            const double alpha = 1.0 - std::exp(-qMax(0.0, dtSeconds) / m_timeConstant);
+            smooth(m_average.data(), db, count, float(alpha));
+        }
+        break;
+    case Mode::Linear:
+        addLinear(db, count);
+        break;
+    }
+
+    if (m_peakHold) {
+        if (m_peak.size() != count)
+            m_peak = m_current;
+        else
+            decayMax(m_peak.data(), db, count, float(m_peakDecay * qMax(0.0, dtSeconds)));
+    }
+}
+
+// Скользящая сумма: новый кадр прибавляется, вытесненный вычитается. Когда
+// кольцо проходит полный круг, сумма пересчитывается заново, чтобы ошибка
+// округления float не накапливалась.
+void SpectrumAverager::addLinear(const float *db, int count)
+{
+    const int n = m_linearCount;
+    if (m_historyFill == 0 || m_history.size() != qsizetype(n) * count) {
+        m_history.fill(0.0f, qsizetype(n) * count);
+        m_sum.fill(0.0f, count);
+        m_historyFill = 0;
+        m_historyIndex = 0;
+    }
+
+    float *slot = m_history.data() + qsizetype(m_historyIndex) * count;
+    addSub(m_sum.data(), db, slot, count); // Пустой слот - нули
+    std::memcpy(slot, db, count * sizeof(float));
+    m_historyFill = qMin(m_historyFill + 1, n);
+    m_historyIndex = (m_historyIndex + 1) % n;
+
+    if (m_historyIndex == 0) {
+        std::fill(m_sum.begin(), m_sum.end(), 0.0f);
+        const QVector<float> zeros(count, 0.0f);
+        for (int f = 0; f < n; ++f)
+            addSub(m_sum.data(), m_history.constData() + qsizetype(f) * count, zeros.constData(), count);
+    }
+
+    m_average.resize(count);
+    scale(m_average.data(), m_sum.constData(), count, 1.0f / m_historyFill);
+}
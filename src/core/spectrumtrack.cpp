@@ -0,0 +1,199 @@
+#include "spectrumtrack.h"
+#include <QThread>
+#include <cmath>
+
+extern "C" {
+#include <kiss_fftr.h>
+}
+
+namespace {
+
+constexpr float levelsPerDb = 255.0f / (SpectrumTrack::maxDb - SpectrumTrack::minDb);
+
+quint8 quantize(float db)
+{
+    const float level = (db - SpectrumTrack::minDb) * levelsPerDb;
+    return quint8(qBound(0.0f, level + 0.5f, 255.0f));
+}
+
+// Обратное квантование по таблице
+const float *levelTable()
+{
+    static const QVector<float> table = [] {
+        QVector<float> t(256);
+        for (int i = 0; i < 256; ++i)
+            t[i] = SpectrumTrack::minDb + i / levelsPerDb;
+        return t;
+    }();
+    return table.constData();
+}
+
+} // namespace
+
+SpectrumTrack::SpectrumTrack(QObject *parent)
+    : QObject(parent)
+{
+    // Дорожка - фоновая работа, живому анализу и плиткам нужен запас ядер
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+SpectrumTrack::~SpectrumTrack()
+{
+    clear();
+    m_pool.waitForDone();
+}
+
+void SpectrumTrack::setSamples(const QVector<double> &samples, quint32 sampleRate)
+{
+    if (m_storage)
+        m_storage->cancelled = true;
+    m_pool.clear();
+    m_storage.reset();
+
+    if (samples.isEmpty() || sampleRate == 0)
+        return;
+
+    auto storage = QSharedPointer<Storage>::create();
+    storage->samples = samples; // Неявное разделение данных, без копирования
+    storage->sampleRate = sampleRate;
+    storage->hop = qMax<qint64>(1, qint64(sampleRate) * hopMs / 1000);
+    storage->frames = samples.size() / storage->hop + 1;
+    storage->blocks = int((storage->frames + blockFrames - 1) / blockFrames);
+    storage->data.reset(new quint8[storage->frames * binCount]);
+    storage->blockReady.reset(new std::atomic_bool[storage->blocks]);
+    for (int b = 0; b < storage->blocks; ++b)
+        storage->blockReady[b] = false;
+    m_storage = storage;
+
+    for (int b = 0; b < storage->blocks; ++b) {
+        m_pool.start([this, storage, b]() {
+            if (storage->cancelled)
+                return;
+            computeBlock(*storage, b);
+            if (storage->cancelled)
+                return;
+            storage->blockReady[b].store(true, std::memory_order_release);
+            const int done = ++storage->blocksDone;
+
+            QMetaObject::invokeMethod(
+                this,
+                [this, storage, done]() {
+                    if (storage != m_storage)
+                        return;
+                    emit progress(done, storage->blocks);
+                    if (done == storage->blocks)
+                        emit completed();
+                },
+                Qt::QueuedConnection);
+        });
+    }
+}
+
+void SpectrumTrack::clear()
+{
+    setSamples({}, 0);
+}
+
+quint32 SpectrumTrack::sampleRate() const
+{
+    return m_storage ? m_storage->sampleRate : 0;
+}
+
+qint64 SpectrumTrack::hop() const
+{
+    return m_storage ? m_storage->hop : 0;
+}
+
+qint64 SpectrumTrack::frameCount() const
+{
+    return m_storage ? m_storage->frames : 0;
+}
+
+bool SpectrumTrack::isComplete() const
+{
+    return m_storage && m_storage->blocksDone == m_storage->blocks;
+}
+
+qint64 SpectrumTrack::memoryBytes() const
+{
+    return m_storage ? m_storage->frames * binCount : 0;
+}
+
+// Уровни кадра или nullptr, если его блок ещё считается
+const quint8 *SpectrumTrack::frameData(qint64 frame) const
+{
+    const Storage &s = *m_storage;
+    if (frame < 0 || frame >= s.frames
+        || !s.blockReady[frame / blockFrames].load(std::memory_order_acquire))
+        return nullptr;
+    return s.data.get() + frame * binCount;
+}
+
+bool SpectrumTrack::lookup(qint64 sample, float *magnitudesDb, bool interpolate) const
+{
+    if (!m_storage || sample < 0)
+        return false;
+
+    const qint64 hop = m_storage->hop;
+    const qint64 frame = qMin(sample / hop, m_storage->frames - 1);
+    const quint8 *a = frameData(frame);
+    if (!a)
+        return false;
+
+    const float *table = levelTable();
+    const quint8 *b = interpolate ? frameData(frame + 1) : nullptr;
+    if (!b) {
+        for (int k = 0; k < binCount; ++k)
+            magnitudesDb[k] = table[a[k]];
+        return true;
+    }
+
+    const float t = float(sample - frame * hop) / hop;
+    for (int k = 0; k < binCount; ++k)
+        magnitudesDb[k] = table[a[k]] + t * (table[b[k]] - table[a[k]]);
+    return true;
+}
+
+// Кадр f - окно fftSize сэмплов, заканчивающееся на f * hop (до начала - тишина)
+void SpectrumTrack::computeBlock(Storage &storage, int block)
+{
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(fftSize, 0, nullptr, nullptr);
+    if (!cfg)
+        return;
+
+    static const QVector<float> window = [] {
+        QVector<float> w(fftSize);
+        for (int i = 0; i < fftSize; ++i)
+            w[i] = float(0.5 * (1 - cos(2 * M_PI * i / (fftSize - 1))));
+        return w;
+    }();
+
+    QVector<kiss_fft_scalar> input(fftSize);
+    QVector<kiss_fft_cpx> output(fftSize / 2 + 1);
+    const double *src = storage.samples.constData();
+    const qint64 count = storage.samples.size();
+
+    const qint64 first = qint64(block) * blockFrames;
+    const qint64 last = qMin(first + blockFrames, storage.frames);
+    for (qint64 f = first; f < last; ++f) {
+        if (storage.cancelled)
+            break;
+
+        const qint64 begin = f * storage.hop - fftSize;
+        for (int i = 0; i < fftSize; ++i) {
+            const qint64 s = begin + i;
+            input[i] = (s >= 0 && s < count) ? kiss_fft_scalar(src[s] * window[i]) : 0;
+        }
+        kiss_fftr(cfg, input.data(), output.data());
+
+        // Тот же масштаб, что у SpectrumAnalyzer: 20*log10|X|
+        quint8 *levels = storage.data.get() + f * binCount;
+        for (int k = 0; k < binCount; ++k) {
+            const double amp = std::sqrt(double(output[k].r) * output[k].r
+                                         + double(output[k].i) * output[k].i);
+            levels[k] = quantize(float(20 * log10(amp + 1e-12)));
+        }
+    }
+
+    kiss_fftr_free(cfg);
+}
@@ -0,0 +1,63 @@
+#include "streamingstft.h"
+#include <cmath>
+#include <cstring>
+
+StreamingStft::StreamingStft(int fftSize, int hop)
+    : m_fftSize(fftSize)
+    , m_hop(qBound(1, hop, fftSize))
+    , m_cfg(kiss_fftr_alloc(fftSize, 0, nullptr, nullptr))
+    , m_window(fftSize)
+    , m_buffer(fftSize)
+    , m_input(fftSize)
+    , m_spectrum(fftSize / 2 + 1)
+    , m_magnitudes(fftSize / 2)
+{
+    for (int i = 0; i < fftSize; ++i)
+        m_window[i] = float(0.5 * (1 - cos(2 * M_PI * i / (fftSize - 1))));
+}
+
+StreamingStft::~StreamingStft()
+{
+    kiss_fftr_free(m_cfg);
+}
+
+int StreamingStft::push(const float *samples, qsizetype count, const FrameHandler &onFrame)
+{
+    if (!m_cfg)
+        return 0;
+
+    int frames = 0;
+    while (count > 0) {
+        // Дозаполнение окна; полное окно - кадр и сдвиг на hop
+        const int n = int(qMin<qsizetype>(count, m_fftSize - m_fill));
+        std::memcpy(m_buffer.data() + m_fill, samples, n * sizeof(float));
+        m_fill += n;
+        m_position += n;
+        samples += n;
+        count -= n;
+
+        if (m_fill < m_fftSize)
+            break;
+
+        for (int i = 0; i < m_fftSize; ++i)
+            m_input[i] = m_buffer[i] * m_window[i];
+        kiss_fftr(m_cfg, m_input.data(), m_spectrum.data());
+        for (int k = 0; k < binCount(); ++k) {
+            const double re = m_spectrum[k].r;
+            const double im = m_spectrum[k].i;
+            m_magnitudes[k] = float(std::sqrt(re * re + im * im));
+        }
+        onFrame(m_magnitudes.constData(), m_position);
+        ++frames;
+
+        std::memmove(m_buffer.data(), m_buffer.data() + m_hop, (m_fftSize - m_hop) * sizeof(float));
+        m_fill -= m_hop;
+    }
+    return frames;
+}
+
+void StreamingStft::skip(qint64 skipped)
+{
+    m_position += skipped;
+    m_fill = 0;
+}
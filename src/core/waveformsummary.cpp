@@ -0,0 +1,128 @@
+#include "waveformsummary.h"
+#include "simdreduce.h"
+#include <cmath>
+
+double WaveformSummary::Bucket::rms() const
+{
+    return count > 0 ? std::sqrt(sumSquares / count) : 0.0;
+}
+
+void WaveformSummary::Bucket::merge(const Bucket &other)
+{
+    if (other.count == 0)
+        return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    min = qMin(min, other.min);
+    max = qMax(max, other.max);
+    sumSquares += other.sumSquares;
+    count += other.count;
+}
+
+qint64 WaveformSummary::blockSize(int level)
+{
+    qint64 size = baseBlock;
+    for (int i = 0; i < level; ++i)
+        size *= levelFactor;
+    return size;
+}
+
+// Построение пирамиды: нижний уровень из сэмплов, остальные из блоков уровнем ниже
+void WaveformSummary::build(const QVector<double> &samples)
+{
+    m_samples = samples;
+    m_levels.clear();
+
+    const qint64 baseCount = m_samples.size() / baseBlock;
+    if (baseCount == 0)
+        return;
+
+    QVector<Block> base(baseCount);
+    const double *src = m_samples.constData();
+    for (qint64 b = 0; b < baseCount; ++b) {
+        const SimdReduce::Result r = SimdReduce::reduce(src + b * baseBlock, baseBlock);
+        base[b] = {r.min, r.max, float(r.sumSquares)};
+    }
+    m_levels.append(base);
+
+    while (m_levels.last().size() >= levelFactor) {
+        const QVector<Block> &lower = m_levels.last();
+        QVector<Block> upper(lower.size() / levelFactor);
+        for (qint64 b = 0; b < upper.size(); ++b) {
+            Block block = lower[b * levelFactor];
+            for (int i = 1; i < levelFactor; ++i) {
+                const Block &child = lower[b * levelFactor + i];
+                block.min = qMin(block.min, child.min);
+                block.max = qMax(block.max, child.max);
+                block.sumSquares += child.sumSquares;
+            }
+            upper[b] = block;
+        }
+        m_levels.append(upper);
+    }
+}
+
+void WaveformSummary::clear()
+{
+    m_samples.clear();
+    m_levels.clear();
+}
+
+WaveformSummary::Bucket WaveformSummary::range(qint64 begin, qint64 end) const
+{
+    begin = qBound<qint64>(0, begin, m_samples.size());
+    end = qBound<qint64>(begin, end, m_samples.size());
+
+    // Самый грубый уровень, блок которого помещается в диапазон
+    int level = -1;
+    while (level + 1 < m_levels.size() && blockSize(level + 1) <= end - begin)
+        ++level;
+
+    return rangeAtLevel(level, begin, end);
+}
+
+// Целые блоки уровня берутся из пирамиды, края - с более детальных уровней
+WaveformSummary::Bucket WaveformSummary::rangeAtLevel(int level, qint64 begin, qint64 end) const
+{
+    if (level < 0)
+        return scanSamples(begin, end);
+
+    const qint64 size = blockSize(level);
+    const qint64 firstFull = (begin + size - 1) / size;
+    const qint64 lastFull = end / size;
+    if (firstFull >= lastFull)
+        return rangeAtLevel(level - 1, begin, end);
+
+    Bucket result = rangeAtLevel(level - 1, begin, firstFull * size);
+
+    const QVector<Block> &blocks = m_levels[level];
+    Bucket full;
+    full.min = blocks[firstFull].min;
+    full.max = blocks[firstFull].max;
+    for (qint64 b = firstFull; b < lastFull; ++b) {
+        full.min = qMin(full.min, blocks[b].min);
+        full.max = qMax(full.max, blocks[b].max);
+        full.sumSquares += blocks[b].sumSquares;
+    }
+    full.count = (lastFull - firstFull) * size;
+    result.merge(full);
+
+    result.merge(rangeAtLevel(level - 1, lastFull * size, end));
+    return result;
+}
+
+WaveformSummary::Bucket WaveformSummary::scanSamples(qint64 begin, qint64 end) const
+{
+    Bucket result;
+    if (begin >= end)
+        return result;
+
+    const SimdReduce::Result r = SimdReduce::reduce(m_samples.constData() + begin, end - begin);
+    result.min = r.min;
+    result.max = r.max;
+    result.sumSquares = r.sumSquares;
+    result.count = end - begin;
+    return result;
+}
@@ -0,0 +1,155 @@
+#include "wavreader.h"
+#include <QDataStream>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+// Разбор заголовка WAV-файла
+bool WavReader::open(const QString &filePath, QString &errorString)
+{
+    m_file.close();
+    m_file.setFileName(filePath);
+    m_format = Format();
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        errorString = tr("Не удалось открыть файл %1").arg(filePath);
+        return false;
+    }
+
+    QDataStream in(&m_file);
+    in.setByteOrder(QDataStream::LittleEndian); // WAV использует little-endian
+
+    // Проверка RIFF заголовка
+    char riff[4];
+    in.readRawData(riff, 4);
+    if (std::strncmp(riff, "RIFF", 4) != 0) {
+        errorString = tr("Это не WAV (нет RIFF).");
+        return false;
+    }
+
+    quint32 riffSize;
+    in >> riffSize;
+
+    char wave[4];
+    in.readRawData(wave, 4);
+    if (std::strncmp(wave, "WAVE", 4) != 0) {
+        errorString = tr("Это не WAV (нет WAVE).");
+        return false;
+    }
+
+    // Поиск чанка 'fmt '
+    bool fmtFound = false;
+    quint32 fmtChunkSize = 0;
+
+    while (!in.atEnd()) {
+        char chunkId[4];
+        in.readRawData(chunkId, 4);
+        quint32 chunkSize;
+        in >> chunkSize;
+        if (std::strncmp(chunkId, "fmt ", 4) == 0) {
+            fmtFound = true;
+            fmtChunkSize = chunkSize;
+            break;
+        } else {
+            m_file.seek(m_file.pos() + chunkSize); // Пропуск неизвестных чанков
+        }
+    }
+    if (!fmtFound) {
+        errorString = tr("Чанк fmt не найден.");
+        return false;
+    }
+
+    // Чтение параметров аудио
+    in >> m_format.audioFormat >> m_format.channels >> m_format.sampleRate >> m_format.byteRate
+        >> m_format.blockAlign >> m_format.bitsPerSample;
+
+    // Поддерживается только PCM
+    if (m_format.audioFormat != 1) {
+        errorString = tr("Поддерживается только несжатый формат PCM.");
+        return false;
+    }
+
+    // Пропуск дополнительных данных в fmt чанке
+    if (fmtChunkSize > 16) {
+        m_file.seek(m_file.pos() + (fmtChunkSize - 16));
+    }
+
+    // Поиск чанка с аудиоданными ('data')
+    bool dataFound = false;
+
+    while (!in.atEnd()) {
+        char chunkId[4];
+        in.readRawData(chunkId, 4);
+        quint32 chunkSize;
+        in >> chunkSize;
+        if (std::strncmp(chunkId, "data", 4) == 0) {
+            dataFound = true;
+            m_format.dataSize = chunkSize;
+            m_format.dataOffset = m_file.pos();
+            break;
+        } else {
+            m_file.seek(m_file.pos() + chunkSize); // Пропуск других чанков
+        }
+    }
+    if (!dataFound) {
+        errorString = tr("Чанк data не найден.");
+        return false;
+    }
+
+    if (m_format.frameBytes() <= 0) {
+        errorString = tr("Некорректный формат сэмплов.");
+        return false;
+    }
+    return true;
+}
+
+QByteArray WavReader::readFrames(qint64 firstFrame, qint64 count)
+{
+    const qint64 frameBytes = m_format.frameBytes();
+    count = qMin(count, m_format.frameCount() - firstFrame);
+    if (count <= 0 || !m_file.seek(m_format.dataOffset + firstFrame * frameBytes))
+        return {};
+    QByteArray raw = m_file.read(count * frameBytes);
+    raw.truncate(raw.size() / frameBytes * frameBytes); // Только целые кадры
+    return raw;
+}
+
+// Смешивание каналов и нормализация [-1.0, 1.0]
+void WavReader::decode(const char *raw,
+                       qint64 frames,
+                       const Format &format,
+                       double *mono,
+                       double *const *channels)
+{
+    const int numChannels = format.channels;
+    if (format.bitsPerSample == 16) {
+        const char *in = raw;
+        for (qint64 i = 0; i < frames; ++i) {
+            double currentSample = 0.0;
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const qint16 value = qFromLittleEndian<qint16>(in);
+                in += sizeof(qint16);
+                if (channels)
+                    channels[ch][i] = value / 32768.0;
+                currentSample += value;
+            }
+            mono[i] = currentSample / numChannels / 32768.0; // Усреднение по каналам
+        }
+    } else if (format.bitsPerSample == 8) {
+        const auto *in = reinterpret_cast<const quint8 *>(raw);
+        for (qint64 i = 0; i < frames; ++i) {
+            double currentSample = 0.0;
+            for (int ch = 0; ch < numChannels; ++ch) {
+                const int value = (*in++ - 128) * 256; // Конвертация 8-bit в signed
+                if (channels)
+                    channels[ch][i] = value / 32768.0;
+                currentSample += value;
+            }
+            mono[i] = currentSample / numChannels / 32768.0;
+        }
+    } else {
+        // Неподдерживаемая битность: сэмплы нулевые
+        std::fill(mono, mono + frames, 0.0);
+        for (int ch = 0; channels && ch < numChannels; ++ch)
+            std::fill(channels[ch], channels[ch] + frames, 0.0);
+    }
+}
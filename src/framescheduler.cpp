@@ -0,0 +1,145 @@
+#include "framescheduler.h"
+#include <QEvent>
+#include <QScreen>
+#include <QWidget>
+#include <QWindow>
+#include <algorithm>
+#include <utility>
+
+FrameScheduler::FrameScheduler(QWidget *window, QObject *parent)
+    : QObject(parent)
+    , m_widget(window)
+{
+    m_fallbackTimer.setSingleShot(true);
+    m_fallbackTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_fallbackTimer, &QTimer::timeout, this, &FrameScheduler::runFrame);
+    m_clock.start();
+}
+
+void FrameScheduler::schedule(QWidget *widget, const QRect &rect)
+{
+    if (!widget)
+        return;
+
+    auto it = std::find_if(m_dirty.begin(), m_dirty.end(), [widget](const Dirty &d) {
+        return d.widget == widget;
+    });
+    if (it == m_dirty.end()) {
+        m_dirty.append({widget, QRegion(), false});
+        it = m_dirty.end() - 1;
+    }
+    if (rect.isNull())
+        it->whole = true;
+    else if (!it->whole)
+        it->region += rect;
+
+    requestFrame();
+}
+
+void FrameScheduler::addAnimation(QObject *owner, Animation animation)
+{
+    m_animations.append({owner, std::move(animation)});
+    requestFrame();
+}
+
+// Один запрос кадра на все накопившиеся обновления
+void FrameScheduler::requestFrame()
+{
+    if (m_frameRequested)
+        return;
+    m_frameRequested = true;
+
+    if (!m_window && m_widget) {
+        m_window = m_widget->windowHandle();
+        if (m_window)
+            m_window->installEventFilter(this);
+    }
+
+    if (m_window) {
+        m_window->requestUpdate();
+    } else {
+        m_fallbackTimer.start(qMax(1, int(refreshIntervalMs())));
+    }
+}
+
+bool FrameScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    // Событие не поглощается: окно виджетов тоже обрабатывает UpdateRequest
+    if (watched == m_window && event->type() == QEvent::UpdateRequest && m_frameRequested)
+        runFrame();
+    return QObject::eventFilter(watched, event);
+}
+
+void FrameScheduler::runFrame()
+{
+    m_frameRequested = false;
+    const qint64 startNs = m_clock.nsecsElapsed();
+
+    // Анимации берут последнее состояние и могут запросить перерисовку.
+    // Список на время кадра забирается: addAnimation() из анимации пишет в
+    // пустой m_animations и не перераспределяет вектор, по которому идёт
+    // цикл; добавленные начнут работать со следующего кадра.
+    QVector<Entry> animations = std::exchange(m_animations, {});
+    for (qsizetype i = 0; i < animations.size();) {
+        Entry &entry = animations[i];
+        if (entry.owner && entry.animation())
+            ++i;
+        else
+            animations.removeAt(i);
+    }
+    animations.append(std::move(m_animations));
+    m_animations = std::move(animations);
+
+    const QVector<Dirty> dirty = std::exchange(m_dirty, {});
+    for (const Dirty &d : dirty) {
+        if (!d.widget)
+            continue;
+        if (d.whole)
+            d.widget->update();
+        else
+            d.widget->update(d.region);
+    }
+
+    // Статистика кадров
+    const qint64 endNs = m_clock.nsecsElapsed();
+    if (m_lastFrameNs >= 0) {
+        const double interval = (startNs - m_lastFrameNs) / 1e6;
+        // Длинные паузы без запросов - это простой, а не пропущенные кадры
+        if (interval < statsIntervalMs) {
+            m_intervalSumMs += interval;
+            m_accum.maxIntervalMs = qMax(m_accum.maxIntervalMs, interval);
+            if (interval > 1.5 * refreshIntervalMs())
+                ++m_accum.lateFrames;
+        }
+    } else {
+        m_statsStartNs = startNs;
+    }
+    m_lastFrameNs = startNs;
+    m_workSumMs += (endNs - startNs) / 1e6;
+    ++m_accum.frames;
+
+    const double elapsedMs = (endNs - m_statsStartNs) / 1e6;
+    if (elapsedMs >= statsIntervalMs) {
+        Stats stats = m_accum;
+        stats.fps = stats.frames * 1000.0 / elapsedMs;
+        stats.meanIntervalMs = stats.frames > 1 ? m_intervalSumMs / (stats.frames - 1) : 0.0;
+        stats.meanWorkMs = m_workSumMs / stats.frames;
+        emit statsUpdated(stats);
+
+        m_accum = Stats();
+        m_intervalSumMs = 0.0;
+        m_workSumMs = 0.0;
+        m_lastFrameNs = -1;
+    }
+
+    if (!m_animations.isEmpty())
+        requestFrame();
+}
+
+// Период обновления экрана, на котором находится окно
+double FrameScheduler::refreshIntervalMs() const
+{
+    const QScreen *screen = m_widget ? m_widget->screen() : nullptr;
+    const double rate = screen ? screen->refreshRate() : 60.0;
+    return 1000.0 / (rate > 1.0 ? rate : 60.0);
+}
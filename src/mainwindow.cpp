@@ -1,18 +1,32 @@
 #include "mainwindow.h"
+#include "audiocapturesource.h"
+#include "generatorsource.h"
+#include "resultexport.h"
+#include "spectrogramexporter.h"
 #include <QAction>
+#include <QActionGroup>
+#include <QDir>
 #include <QFileDialog>
 #include <QMenu>
 #include <QMessageBox>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QThread>
+#include <QThreadPool>
 #include <QToolBar>
-#include <QUrl>
 #include <QVBoxLayout>
 #include <QWidgetAction>
+#include <cmath>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_model(new AudioModel(this)) // Объект для работы с аудиофайлом
-    , m_player(new QMediaPlayer(this))
-    , m_audioOutput(new QAudioOutput(this))
+    , m_engine(new PlaybackEngine(this))
+    , m_analyzer(new SpectrumAnalyzer(this))
+    , m_track(new SpectrumTrack(this))
+    , m_live(new LiveAnalyzer(this))
+    , m_frames(new FrameScheduler(this, this))
+    , m_viewport(new TimeViewport(this))       // Общая временная ось видов
     , m_waveform(new WaveformView(this))       // Осциллограмма
     , m_spectrogram(new SpectrogramView(this)) // Спектрограмма
     , m_spectrum(new SpectrumView(this))       // Спектр
@@ -29,12 +43,97 @@ MainWindow::MainWindow(QWidget *parent)
                         "   background-color: #999999;"
                         "}");
 
-    m_player->setAudioOutput(m_audioOutput);
-
     // Инициализация панели инструментов
     auto *tb = addToolBar("Controls");
     QAction *openAct = tb->addAction(style()->standardIcon(QStyle::SP_DirOpenIcon),
                                      "Open"); // Иконка папки для открытия файлов
+    QAction *exportAct = tb->addAction(style()->standardIcon(QStyle::SP_DialogSaveButton),
+                                       "Export spectrogram"); // Экспорт в полном разрешении
+    QAction *exportResultsAct = tb->addAction("Export results");
+    exportResultsAct->setToolTip("Save metadata, spectrum, spectrogram matrix and feature series "
+                                 "(CSV / NPY) to a folder");
+
+    // Спектр при воспроизведении и перемотке из заранее рассчитанной дорожки
+    m_trackAct = tb->addAction("Precomputed spectrum");
+    m_trackAct->setCheckable(true);
+    m_trackAct->setChecked(true);
+    m_trackAct->setToolTip("Compute the spectrum of the whole file at load time "
+                           "and look it up during playback instead of running FFT live");
+
+    // Живой вход: микрофон или генератор, те же виды спектра и спектрограммы
+    QToolButton *liveButton = new QToolButton(this);
+    liveButton->setText("Live input");
+    liveButton->setPopupMode(QToolButton::InstantPopup);
+    QMenu *liveMenu = new QMenu(liveButton);
+    QAction *captureAct = liveMenu->addAction("Default input device");
+    QAction *toneAct = liveMenu->addAction("Test tone (1 kHz + noise)");
+    QAction *loopAct = liveMenu->addAction("Loop opened file");
+    liveMenu->addSeparator();
+    QAction *stopLiveAct = liveMenu->addAction("Stop live input");
+    liveButton->setMenu(liveMenu);
+    tb->addWidget(liveButton);
+
+    connect(captureAct, &QAction::triggered, this, [this]() {
+        startLiveInput(new AudioCaptureSource(QAudioDevice(), this));
+    });
+    connect(toneAct, &QAction::triggered, this, [this]() {
+        auto *generator = new GeneratorSource(this);
+        generator->setTone(1000.0, 48000);
+        startLiveInput(generator);
+    });
+    connect(loopAct, &QAction::triggered, this, [this]() {
+        if (m_samples.isEmpty())
+            return;
+        auto *generator = new GeneratorSource(this);
+        generator->setSamples(m_samples, m_sampleRate);
+        startLiveInput(generator);
+    });
+    connect(stopLiveAct, &QAction::triggered, this, &MainWindow::stopLiveInput);
+
+    // Усреднение спектра и удержание пиков
+    QToolButton *averagingButton = new QToolButton(this);
+    averagingButton->setText("Averaging");
+    averagingButton->setPopupMode(QToolButton::InstantPopup);
+    QMenu *averagingMenu = new QMenu(averagingButton);
+    QActionGroup *averagingGroup = new QActionGroup(averagingMenu);
+    auto addAveraging = [this, averagingMenu, averagingGroup](const QString &text,
+                                                             SpectrumAverager::Mode mode,
+                                                             double timeConstant,
+                                                             int count) {
+        QAction *act = averagingMenu->addAction(text);
+        act->setCheckable(true);
+        act->setChecked(mode == SpectrumAverager::Mode::Off);
+        averagingGroup->addAction(act);
+        connect(act, &QAction::triggered, this, [this, mode, timeConstant, count]() {
+            m_spectrum->setAveragingTimeConstant(timeConstant);
+            m_spectrum->setAveragingCount(count);
+            m_spectrum->setAveraging(mode);
+        });
+    };
+    addAveraging("Off", SpectrumAverager::Mode::Off, 0.5, 16);
+    addAveraging("Exponential, fast (0.1 s)", SpectrumAverager::Mode::Exponential, 0.1, 16);
+    addAveraging("Exponential, slow (1 s)", SpectrumAverager::Mode::Exponential, 1.0, 16);
+    addAveraging("Linear, 8 frames", SpectrumAverager::Mode::Linear, 0.5, 8);
+    addAveraging("Linear, 32 frames", SpectrumAverager::Mode::Linear, 0.5, 32);
+    averagingMenu->addSeparator();
+
+    QAction *peakAct = averagingMenu->addAction("Peak hold");
+    peakAct->setCheckable(true);
+    connect(peakAct, &QAction::toggled, m_spectrum, &SpectrumView::setPeakHold);
+    QMenu *decayMenu = averagingMenu->addMenu("Peak decay");
+    QActionGroup *decayGroup = new QActionGroup(decayMenu);
+    for (double decay : {0.0, 6.0, 20.0, 60.0}) {
+        QAction *act = decayMenu->addAction(decay > 0 ? QString("%1 dB/s").arg(decay) : "Infinite hold");
+        act->setCheckable(true);
+        act->setChecked(decay == 20.0);
+        decayGroup->addAction(act);
+        connect(act, &QAction::triggered, this, [this, decay]() { m_spectrum->setPeakDecay(decay); });
+    }
+    averagingMenu->addSeparator();
+    QAction *resetAveragingAct = averagingMenu->addAction("Reset average and peaks");
+    connect(resetAveragingAct, &QAction::triggered, m_spectrum, &SpectrumView::resetAveraging);
+    averagingButton->setMenu(averagingMenu);
+    tb->addWidget(averagingButton);
 
     // Разделитель перед элементами громкости
     tb->addSeparator();
@@ -53,7 +152,7 @@ MainWindow::MainWindow(QWidget *parent)
     // Слайдер громкости
     QSlider *volumeSlider = new QSlider(Qt::Horizontal, this);
     volumeSlider->setRange(0, 100);
-    volumeSlider->setValue(static_cast<int>(m_audioOutput->volume() * 100));
+    volumeSlider->setValue(static_cast<int>(m_engine->volume() * 100));
 
     // Лейбл для отображения значения (0-100)
     QLabel *volumeValueLabel = new QLabel(QString::number(volumeSlider->value()), this);
@@ -80,7 +179,7 @@ MainWindow::MainWindow(QWidget *parent)
             [this, volumeButton, volumeValueLabel](int value) {
                 // Установление громкости
                 float volume = value / 100.0f;
-                m_audioOutput->setVolume(volume);
+                m_engine->setVolume(volume);
 
                 // Обновление текста
                 volumeValueLabel->setText(QString::number(value));
@@ -99,6 +198,8 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Подключение к слотам для обработки нажатий на кнопки
     connect(openAct, &QAction::triggered, this, &MainWindow::onOpenFile);
+    connect(exportAct, &QAction::triggered, this, &MainWindow::onExportSpectrogram);
+    connect(exportResultsAct, &QAction::triggered, this, &MainWindow::onExportResults);
 
     // Инициализация ползунка
     m_progressSlider = new QSlider(Qt::Horizontal, this);
@@ -196,6 +297,16 @@ MainWindow::MainWindow(QWidget *parent)
     layout->addWidget(m_waveform, 1);
     layout->addWidget(bottomPanel, 0); // Добавление объединенной нижней панели
 
+    m_spectrogram->setCache(m_model->spectrogramCache());
+    m_model->setLoudnessThreads(QThread::idealThreadCount()); // Загрузка в потоке GUI - все ядра
+    m_waveform->setViewport(m_viewport);
+    m_spectrogram->setViewport(m_viewport);
+    m_waveform->setFrameScheduler(m_frames);
+    m_spectrogram->setFrameScheduler(m_frames);
+    m_spectrum->setFrameScheduler(m_frames);
+
+    m_spectrum->setAnalyzer(m_analyzer);
+    m_spectrum->setTrack(m_track);
     m_spectrum->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     m_spectrum->setFrequencyRange(20, 20000);
     m_spectrum->setDecibelRange(-100, 100);
@@ -217,9 +328,9 @@ MainWindow::MainWindow(QWidget *parent)
     stopBtn->setStyleSheet(btnStyle);
 
     // Подключение сигналов
-    connect(playBtn, &QToolButton::clicked, m_player, &QMediaPlayer::play);
-    connect(pauseBtn, &QToolButton::clicked, m_player, &QMediaPlayer::pause);
-    connect(stopBtn, &QToolButton::clicked, m_player, &QMediaPlayer::stop);
+    connect(playBtn, &QToolButton::clicked, m_engine, &PlaybackEngine::play);
+    connect(pauseBtn, &QToolButton::clicked, m_engine, &PlaybackEngine::pause);
+    connect(stopBtn, &QToolButton::clicked, m_engine, &PlaybackEngine::stop);
 
     // Подключение слотов
     connect(m_model,
@@ -230,49 +341,109 @@ MainWindow::MainWindow(QWidget *parent)
             &AudioModel::waveformReady,
             this,
             &MainWindow::onWaveformReady); // Вывод осциллограммы
+    connect(m_model,
+            &AudioModel::channelsReady,
+            m_waveform,
+            &WaveformView::setChannels); // Дорожки каналов
     connect(m_model,
             &AudioModel::spectrogramReady,
             this,
             &MainWindow::onSpectrogramReady);                                 // Вывод спектрограммы
     connect(m_model, &AudioModel::errorOccurred, this, &MainWindow::onError); // Сообщение об ошибке
-    connect(m_player,
-            &QMediaPlayer::positionChanged,
+    connect(m_engine,
+            &PlaybackEngine::positionChanged,
             this,
             &MainWindow::onPositionChanged); // Перемещение маркера при проигрывании аудиофайла
+    connect(m_model,
+            &AudioModel::channelsReady,
+            m_engine,
+            &PlaybackEngine::setSource); // Воспроизведение из декодированного буфера
+    connect(m_engine, &PlaybackEngine::errorOccurred, this, &MainWindow::onError);
+
+    // Анализатор - единственный читатель отвода движка; работает, пока идёт воспроизведение
+    m_analyzer->setReader(
+        [engine = m_engine](float *dst, qsizetype count) { return engine->readTap(dst, count); });
+    connect(m_engine, &PlaybackEngine::stateChanged, this, [this](PlaybackEngine::State state) {
+        if (state == PlaybackEngine::State::Playing) {
+            stopLiveInput(); // Виды спектра показывают что-то одно
+            followPlayback();
+        }
+        updateLiveAnalysis();
+    });
+
+    connect(m_live, &LiveAnalyzer::latencyUpdated, this, [this](const LiveAnalyzer::Latency &l) {
+        m_metadatalabel->setText(
+            QString("Live: %1 | %2 Hz | latency %3 ms (max %4, bound %5) | skipped %6 | dropped %7")
+                .arg(m_input ? m_input->name() : QString())
+                .arg(m_input ? m_input->sampleRate() : 0)
+                .arg(l.meanMs, 0, 'f', 1)
+                .arg(l.maxMs, 0, 'f', 1)
+                .arg(l.boundMs, 0, 'f', 0)
+                .arg(l.skippedFrames)
+                .arg(l.droppedSlices));
+    });
+
+    // Готовая дорожка заменяет живой анализ; пока она считается, работает анализатор
+    connect(m_track, &SpectrumTrack::completed, this, &MainWindow::updateLiveAnalysis);
+    connect(m_trackAct, &QAction::toggled, this, [this](bool enabled) {
+        if (enabled && m_track->sampleRate() == 0)
+            m_track->setSamples(m_samples, m_sampleRate);
+        else if (!enabled)
+            m_track->clear();
+        m_spectrum->setTrackPosition(enabled ? m_engine->playbackPosition() : -1);
+        updateLiveAnalysis();
+    });
+
+    // Во время воспроизведения позиция опрашивается раз в кадр экрана, а не по таймеру
+    // движка; сигнал positionChanged остаётся для перемотки, паузы и остановки
+    m_engine->setNotifyInterval(0);
+    connect(m_frames, &FrameScheduler::statsUpdated, this, [this](const FrameScheduler::Stats &s) {
+        m_timeLabel->setToolTip(QString("%1 fps, frame %2 ms (max %3 ms), work %4 ms, late %5")
+                                    .arg(s.fps, 0, 'f', 1)
+                                    .arg(s.meanIntervalMs, 0, 'f', 1)
+                                    .arg(s.maxIntervalMs, 0, 'f', 1)
+                                    .arg(s.meanWorkMs, 0, 'f', 2)
+                                    .arg(s.lateFrames));
+    });
     connect(m_model, &AudioModel::spectrumReady, this, &MainWindow::onSpectrumReady);
 
     connect(m_waveform,
             &WaveformView::markerPositionChanged,
             this,
-            [this](double seconds) { // Перемещение ползунка при перемещении маркера
-                qint64 posMs = static_cast<qint64>(seconds * 1000);
-                if (m_player->position() != posMs) {
-                    m_player->setPosition(posMs);
-                }
-                if (m_player->duration() > 0) {
-                    int sliderVal = static_cast<int>((posMs * 100) / m_player->duration());
-                    if (m_progressSlider->value() != sliderVal) {
-                        m_progressSlider->setValue(sliderVal);
-                    }
-                }
+            [this](double seconds) { // Перемотка при перемещении маркера
+                seekTo(seconds);
             });
 
+    // Пока маркер или ползунок тянут, звучит окрестность курсора
+    connect(m_waveform, &WaveformView::markerDragStarted, m_engine, &PlaybackEngine::beginScrub);
+    connect(m_waveform, &WaveformView::markerDragFinished, m_engine, &PlaybackEngine::endScrub);
+    connect(m_progressSlider, &QSlider::sliderPressed, m_engine, &PlaybackEngine::beginScrub);
+    connect(m_progressSlider, &QSlider::sliderReleased, m_engine, &PlaybackEngine::endScrub);
+
     connect(m_progressSlider,
             &QSlider::sliderMoved,
             this,
             [this](int value) { // Перемещение маркера при перемещении ползунка
-                if (m_player->duration() > 0) {
-                    qint64 newPos = (value * m_player->duration()) / 100;
-                    if (m_player->position() != newPos) {
-                        m_player->setPosition(newPos);
-                    }
-                    double seconds = newPos / 1000.0;
-                    m_waveform->setMarkerPosition(seconds);
+                if (m_sampleRate > 0) {
+                    const double duration = double(m_engine->sampleCount()) / m_sampleRate;
+                    seekTo(value * duration / 100);
                 }
             });
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow()
+{
+    stopLiveInput();
+    m_analyzer->stop(); // Поток анализа читает отвод движка, который удаляется раньше
+
+    // Фоновый экспорт прерывается и дожидается; его отложенные ответы окну
+    // удаляются вместе с окном и уже не выполнятся
+    for (const QSharedPointer<SpectrogramExporter> &exporter : std::as_const(m_exporters))
+        exporter->cancel();
+    for (const QSharedPointer<std::atomic_bool> &cancel : std::as_const(m_exportCancels))
+        cancel->store(true);
+    m_exportPool.waitForDone();
+}
 
 void MainWindow::onOpenFile()
 {
@@ -282,13 +453,21 @@ void MainWindow::onOpenFile()
 
     m_metadatalabel->setText("Loading: "
                              + QFileInfo(file).fileName()); // Обновление статуса метаданных
+    stopLiveInput();
+    m_engine->stop();
     m_waveform->setSamples({}, 0);
     m_spectrogram->setSpectrogramData({});
     m_spectrum->setSpectrumData({}, {});
+    m_spectrum->setTrackPosition(-1);
+    m_track->clear();
 
     // Сбросить сохраненные сэмплы
     m_samples.clear();
     m_sampleRate = 0;
+    m_filePath = file;
+    m_metadataText.clear();
+    m_spectrumFrequencies.clear();
+    m_spectrumDb.clear();
 
     AudioModel::Meta meta; // Создание структуры для хранения метаданных
     QString err;
@@ -299,18 +478,172 @@ void MainWindow::onOpenFile()
     m_progressSlider->setRange(0, 100);
     m_progressSlider->setValue(0);
     m_timeLabel->setText("00:00 / 00:00");
-    m_player->setSource(QUrl::fromLocalFile(file)); // Установка медиа-источника для плеера
+}
+
+// Перемотка движка; маркер и ползунок обновятся по positionChanged
+void MainWindow::seekTo(double seconds)
+{
+    if (m_sampleRate == 0)
+        return;
+    const qint64 sample = qint64(seconds * m_sampleRate);
+    if (m_engine->isScrubbing()) {
+        m_engine->scrubTo(sample); // Повтор той же позиции - тоже движение курсора
+    } else if (sample != m_engine->position()) {
+        m_analyzer->reset(); // История анализа после перемотки начинается заново
+        m_engine->seek(sample);
+    }
+}
+
+// Экспорт спектрограммы в фоне: кадры считаются и пишутся в файл полосами
+void MainWindow::onExportSpectrogram()
+{
+    if (m_samples.isEmpty())
+        return;
+
+    const QString file = QFileDialog::getSaveFileName(this,
+                                                      "Export spectrogram",
+                                                      {},
+                                                      "PNG (*.png);;TIFF (*.tif *.tiff);;"
+                                                      "Raw float32 dB (*.f32)");
+    if (file.isEmpty())
+        return;
+
+    // Без родителя: экспортёром владеют окно (для отмены) и задача пула
+    QSharedPointer<SpectrogramExporter> exporter(new SpectrogramExporter, &QObject::deleteLater);
+    m_exporters.append(exporter);
+    exporter->setSamples(m_samples);
+    exporter->setMode(m_model->spectrogramCache()->mode());
+    exporter->setColorMap(m_spectrogram->colorMap()); // Та же палитра и диапазон дБ, что на экране
+
+    // Диалог удаляется при закрытии (Esc, крестик) раньше, чем закончится
+    // экспорт: дальше он доступен только через QPointer
+    QPointer<QProgressDialog> dialog = new QProgressDialog("Exporting spectrogram...",
+                                                           "Cancel",
+                                                           0,
+                                                           100,
+                                                           this);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(exporter.data(), &SpectrogramExporter::progress, dialog, &QProgressDialog::setValue);
+    connect(dialog, &QProgressDialog::canceled, exporter.data(), &SpectrogramExporter::cancel);
+    dialog->show();
+
+    m_exportPool.start([this, exporter, dialog, file]() {
+        QString err;
+        const bool ok = exporter->exportTo(file, SpectrogramExporter::formatForFile(file), err);
+        QMetaObject::invokeMethod(
+            this,
+            [this, exporter, dialog, ok, err]() {
+                if (dialog)
+                    dialog->close();
+                m_exporters.removeOne(exporter);
+                if (!ok && !exporter->isCancelled())
+                    onError(err);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+// Экспорт результатов анализа в каталог: метаданные и спектр (CSV),
+// спектрограмма (NPY) и покадровые признаки (CSV). Всё пишется в фоне
+// потоково, без сборки файлов в памяти; отмена срабатывает между файлами
+// и между полосами спектрограммы, недописанный файл не остаётся.
+void MainWindow::onExportResults()
+{
+    if (m_samples.isEmpty())
+        return;
+
+    const QString dir = QFileDialog::getExistingDirectory(this, "Export results");
+    if (dir.isEmpty())
+        return;
+
+    const QString base = QDir(dir).filePath(QFileInfo(m_filePath).completeBaseName());
+
+    // Флаг отмены общий у окна (закрытие), диалога и задачи пула
+    QSharedPointer<std::atomic_bool> cancel(new std::atomic_bool(false));
+    m_exportCancels.append(cancel);
+
+    QPointer<QProgressDialog> dialog = new QProgressDialog("Exporting results...",
+                                                           "Cancel",
+                                                           0,
+                                                           4,
+                                                           this);
+    dialog->setWindowModality(Qt::WindowModal);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    connect(dialog, &QProgressDialog::canceled, this, [cancel]() { cancel->store(true); });
+    dialog->show();
+
+    m_exportPool.start([this,
+                        dialog,
+                        cancel,
+                        base,
+                        source = m_filePath,
+                        meta = m_meta,
+                        samples = m_samples,
+                        rate = m_sampleRate,
+                        frequencies = m_spectrumFrequencies,
+                        db = m_spectrumDb]() {
+        // Между файлами - прогресс и проверка отмены; спектрограмма
+        // проверяет флаг ещё и между полосами. Диалог могли закрыть и
+        // удалить: он проверяется только в потоке окна.
+        const auto proceed = [this, dialog, &cancel](int done) {
+            QMetaObject::invokeMethod(
+                this,
+                [dialog, done]() {
+                    if (dialog)
+                        dialog->setValue(done);
+                },
+                Qt::QueuedConnection);
+            return !cancel->load();
+        };
+
+        QString err;
+        const bool ok = ResultExport::writeMetadata(base + ".meta.csv", source, meta, err)
+                        && proceed(1)
+                        && ResultExport::writeSpectrum(base + ".spectrum.csv", frequencies, db, err)
+                        && proceed(2)
+                        && ResultExport::writeSpectrogram(base + ".spectrogram.npy",
+                                                          samples,
+                                                          SpectrogramCache::fftSize / 2,
+                                                          err,
+                                                          cancel.data())
+                        && proceed(3)
+                        && ResultExport::writeFeatureSeries(base + ".features.csv", samples, rate, err);
+        QMetaObject::invokeMethod(
+            this,
+            [this, dialog, cancel, ok, err]() {
+                if (dialog)
+                    dialog->close();
+                m_exportCancels.removeOne(cancel);
+                if (!ok && !cancel->load())
+                    onError(err);
+            },
+            Qt::QueuedConnection);
+    });
 }
 
 // Вывод метаданных
 void MainWindow::onMetadataReady(const AudioModel::Meta &m)
 {
-    m_metadatalabel->setText(QString("%1 s | %2 Hz | %3 kbps | %4 ch | %5 bit")
-                                 .arg(m.durationSeconds, 0, 'f', 1)
-                                 .arg(m.sampleRate)
-                                 .arg(m.bitRate / 1000)
-                                 .arg(m.channels)
-                                 .arg(m.bitsPerSample));
+    m_meta = m;
+    m_metadataText =
+        QString("%1 s | %2 Hz | %3 kbps | %4 ch | %5 bit | peak %6 dBFS | RMS %7 dBFS | %8 LUFS | LRA %9 LU")
+            .arg(m.durationSeconds, 0, 'f', 1)
+            .arg(m.sampleRate)
+            .arg(m.bitRate / 1000)
+            .arg(m.channels)
+            .arg(m.bitsPerSample)
+            .arg(m.peakDb, 0, 'f', 1)
+            .arg(m.rmsDb, 0, 'f', 1)
+            .arg(formatLufs(m.integratedLufs))
+            .arg(m.loudnessRangeLu, 0, 'f', 1);
+    m_metadatalabel->setText(m_metadataText);
+}
+
+// Громкость ниже абсолютного порога стробирования не определена
+QString MainWindow::formatLufs(double lufs)
+{
+    return lufs > LoudnessMeter::absoluteGateLufs ? QString::number(lufs, 'f', 1) : QString("-inf");
 }
 
 // Вывод осциллограммы
@@ -318,7 +651,9 @@ void MainWindow::onWaveformReady(const QVector<double> &samples, quint32 sampleR
 {
     m_samples = samples;       // Сохраняем сэмплы
     m_sampleRate = sampleRate; // Сохраняем частоту дискретизации
-    m_waveform->setSamples(samples, sampleRate);
+    m_analyzer->setSampleRate(sampleRate);
+    if (m_trackAct->isChecked())
+        m_track->setSamples(samples, sampleRate);
 }
 // Вывод спектрограммы
 void MainWindow::onSpectrogramReady(const QVector<QVector<double>> &frames)
@@ -332,6 +667,8 @@ void MainWindow::onSpectrumReady(const QVector<double> &frequencies,
     m_spectrum->setFrequencyRange(20, 20000); // 20Hz - 20kHz
     m_spectrum->setDecibelRange(-100, 100);   // -100dB to 100dB
     m_spectrum->setSpectrumData(frequencies, magnitudes);
+    m_spectrumFrequencies = frequencies;
+    m_spectrumDb = magnitudes;
 }
 
 // Вывод сообщения об ошибке
@@ -339,56 +676,139 @@ void MainWindow::onError(const QString &err)
 {
     QMessageBox::critical(this, "Error", err);
 }
+// Переход в живой режим: воспроизведение останавливается, виды спектра и
+// спектрограммы наполняются срезами входа раз в кадр экрана
+void MainWindow::startLiveInput(InputSource *source)
+{
+    stopLiveInput();
+    m_engine->stop();
+
+    QString err;
+    if (!source->start(err)) {
+        source->deleteLater();
+        onError(err);
+        return;
+    }
+    m_input = source;
+    connect(m_input, &InputSource::errorOccurred, this, &MainWindow::onError);
+
+    m_spectrum->setTrackPosition(-1);
+    m_spectrum->setFrequencyRange(20, qMin(20000.0, m_input->sampleRate() / 2.0));
+    m_spectrogram->setSpectrogramData({});
+    m_metadatalabel->setText("Live: " + m_input->name());
+
+    m_live->setSource(m_input);
+    m_liveFrequencies = m_live->frequencies();
+    m_live->start();
+    m_frames->addAnimation(this, [this]() {
+        if (!m_live->isRunning())
+            return false;
+        presentLiveSlices();
+        return true;
+    });
+}
+
+void MainWindow::stopLiveInput()
+{
+    if (!m_input)
+        return;
+    m_live->stop();
+    m_live->setSource(nullptr);
+    m_input->stop();
+    m_input->deleteLater();
+    m_input = nullptr;
+}
+
+// Все срезы с прошлого кадра - в спектрограмму, последний - в спектр
+void MainWindow::presentLiveSlices()
+{
+    const QVector<LiveAnalyzer::Slice> slices = m_live->takeSlices();
+    if (slices.isEmpty())
+        return;
+
+    QVector<QVector<double>> magnitudes;
+    magnitudes.reserve(slices.size());
+    for (const LiveAnalyzer::Slice &slice : slices)
+        magnitudes.append(slice.magnitudes);
+    m_spectrogram->addSpectrumSlices(m_liveFrequencies, magnitudes);
+
+    QVector<double> db(LiveAnalyzer::binCount);
+    const QVector<double> &last = slices.last().magnitudes;
+    for (int k = 0; k < db.size(); ++k)
+        db[k] = 20 * log10(last[k] + 1e-12);
+    m_spectrum->setSpectrumData(m_liveFrequencies, db);
+
+    m_live->markPresented(slices.last().endSample);
+}
+
+// Живой анализ нужен только во время воспроизведения и без готовой дорожки
+void MainWindow::updateLiveAnalysis()
+{
+    const bool playing = m_engine->state() == PlaybackEngine::State::Playing;
+    if (playing && !(m_trackAct->isChecked() && m_track->isComplete()))
+        m_analyzer->start();
+    else
+        m_analyzer->stop();
+}
+
+// Маркер, ползунок и время обновляются на каждом кадре, пока идёт воспроизведение
+void MainWindow::followPlayback()
+{
+    if (m_followingPlayback)
+        return;
+    m_followingPlayback = true;
+    m_frames->addAnimation(this, [this]() {
+        if (m_engine->state() != PlaybackEngine::State::Playing) {
+            m_followingPlayback = false;
+            return false;
+        }
+        onPositionChanged(m_engine->playbackPosition());
+        return true;
+    });
+}
+
 // Перемещение ползунка при проигрывании аудиофайла
-void MainWindow::onPositionChanged(qint64 pos)
+void MainWindow::onPositionChanged(qint64 sample)
 {
-    double seconds = pos / 1000.0;
+    if (m_sampleRate == 0)
+        return;
+
+    double seconds = double(sample) / m_sampleRate;
     m_waveform->setMarkerPosition(seconds);
 
-    if (m_player->duration() > 0) {
-        int sliderVal = static_cast<int>((pos * 100) / m_player->duration());
+    const qint64 total = m_engine->sampleCount();
+    if (total > 0) {
+        int sliderVal = static_cast<int>((sample * 100) / total);
         if (m_progressSlider->value() != sliderVal) {
             m_progressSlider->setValue(sliderVal);
         }
 
+        const qint64 pos = sample * 1000 / m_sampleRate;
+        const qint64 duration = total * 1000 / m_sampleRate;
         QString currentTime1 = QString("%1:%2")
                                    .arg(pos / 60000, 2, 10, QLatin1Char('0'))
                                    .arg((pos % 60000) / 1000, 2, 10, QLatin1Char('0'));
 
         QString totalTime = QString("%1:%2")
-                                .arg(m_player->duration() / 60000, 2, 10, QLatin1Char('0'))
-                                .arg((m_player->duration() % 60000) / 1000, 2, 10, QLatin1Char('0'));
+                                .arg(duration / 60000, 2, 10, QLatin1Char('0'))
+                                .arg((duration % 60000) / 1000, 2, 10, QLatin1Char('0'));
 
         m_timeLabel->setText(currentTime1 + " / " + totalTime);
+    }
 
-        // Обновление спектра в реальном времени
-        qint64 currentTime = QDateTime::currentMSecsSinceEpoch();
-        if (currentTime - m_lastSpectrumUpdate < SPECTRUM_UPDATE_INTERVAL_MS) {
-            return;
-        }
-        m_lastSpectrumUpdate = currentTime;
-
-        if (m_samples.isEmpty() || m_sampleRate == 0) {
-            return;
-        }
-
-        const int fftSize = 2048;
-        double posSeconds = pos / 1000.0;
-        quint64 startSample = static_cast<quint64>(posSeconds * m_sampleRate);
-
-        // Проверка выхода за границы
-        if (startSample >= static_cast<quint64>(m_samples.size())) {
-            return;
-        }
-
-        // Берем сэмплы для текущей позиции
-        QVector<double> frame(fftSize, 0.0);
-        int count = qMin(fftSize, m_samples.size() - static_cast<int>(startSample));
-        for (int i = 0; i < count; ++i) {
-            frame[i] = m_samples[static_cast<int>(startSample) + i];
-        }
-
-        // Рассчитываем спектр для текущего фрагмента
-        m_model->calculateSpectrum(frame, m_sampleRate);
+    // Громкость звучащего (мгновенная, кратковременная, с начала воспроизведения)
+    if (m_engine->state() == PlaybackEngine::State::Playing && m_engine->takeLoudness()
+        && !m_metadataText.isEmpty()) {
+        const LoudnessMeter::Result &l = m_engine->loudness();
+        m_metadatalabel->setText(m_metadataText
+                                 + QString(" | M %1 S %2 I %3 LUFS")
+                                       .arg(formatLufs(l.momentaryLufs),
+                                            formatLufs(l.shortTermLufs),
+                                            formatLufs(l.integratedLufs)));
     }
+
+    // Окно анализа сдвигается на задержку устройства, чтобы совпадать со звучащим
+    m_analyzer->setLatencyFrames(m_engine->latencyFrames());
+    if (m_trackAct->isChecked())
+        m_spectrum->setTrackPosition(sample);
 }
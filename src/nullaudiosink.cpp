@@ -0,0 +1,78 @@
+#include "nullaudiosink.h"
+#include <QIODevice>
+#include <QVector>
+
+NullAudioSink::NullAudioSink(const QAudioFormat &format, QObject *parent)
+    : QObject(parent)
+    , m_format(format)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(tickMs);
+    connect(&m_timer, &QTimer::timeout, this, &NullAudioSink::pull);
+}
+
+void NullAudioSink::start(QIODevice *device)
+{
+    m_device = device;
+    m_framesPulled = 0;
+    m_elapsedBeforeSuspend = 0;
+    m_clock.start();
+    m_timer.start();
+    setState(QAudio::ActiveState);
+}
+
+void NullAudioSink::stop()
+{
+    m_timer.stop();
+    m_device = nullptr;
+    setState(QAudio::StoppedState);
+}
+
+void NullAudioSink::suspend()
+{
+    if (m_state != QAudio::ActiveState && m_state != QAudio::IdleState)
+        return;
+    m_elapsedBeforeSuspend += m_clock.elapsed();
+    m_timer.stop();
+    setState(QAudio::SuspendedState);
+}
+
+void NullAudioSink::resume()
+{
+    if (m_state != QAudio::SuspendedState)
+        return;
+    m_clock.start();
+    m_timer.start();
+    setState(QAudio::ActiveState);
+}
+
+qint64 NullAudioSink::processedUSecs() const
+{
+    return m_format.sampleRate() > 0 ? m_framesPulled * 1000000 / m_format.sampleRate() : 0;
+}
+
+// Чтение из источника столько кадров, сколько "прозвучало" с момента старта
+void NullAudioSink::pull()
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    if (!m_device || frameBytes <= 0)
+        return;
+
+    const qint64 elapsedMs = m_elapsedBeforeSuspend + m_clock.elapsed();
+    const qint64 due = elapsedMs * m_format.sampleRate() / 1000 - m_framesPulled;
+    if (due <= 0)
+        return;
+
+    QVector<char> buffer(due * frameBytes);
+    const qint64 read = m_device->read(buffer.data(), buffer.size());
+    m_framesPulled += due; // Недобор не накапливается, как и у настоящего устройства
+    setState(read < buffer.size() ? QAudio::IdleState : QAudio::ActiveState);
+}
+
+void NullAudioSink::setState(QAudio::State state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    emit stateChanged(state);
+}
@@ -0,0 +1,635 @@
+#include "playbackengine.h"
+#include "nullaudiosink.h"
+#include "spscringbuffer.h"
+#include "triplebuffer.h"
+#include <QAudioDevice>
+#include <QAudioSink>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+// Источник для QAudioSink: отдаёт float-кадры прямо из декодированных каналов.
+// readData() вызывается звуковым потоком, поэтому позиция и отвод атомарные,
+// а каналы меняются только при остановленном воспроизведении.
+class PlaybackSource : public QIODevice
+{
+public:
+    explicit PlaybackSource(QObject *parent)
+        : QIODevice(parent)
+    {}
+
+    void setData(const QVector<QVector<double>> &channels, int outChannels, quint32 sampleRate)
+    {
+        m_channels = channels;
+        m_outChannels = qMax(1, outChannels);
+        m_count = channels.isEmpty() ? 0 : channels.first().size();
+        m_loudness = std::make_unique<LoudnessMeter>(sampleRate, int(channels.size()));
+        m_loudnessOutput.initialize([](LoudnessMeter::Result &r) { r = LoudnessMeter::Result(); });
+        setPosition(0);
+    }
+
+    void setOutChannels(int outChannels) { m_outChannels = qMax(1, outChannels); }
+
+    qint64 sampleCount() const { return m_count; }
+    qint64 position() const { return m_position.load(std::memory_order_acquire); }
+
+    void setPosition(qint64 sample)
+    {
+        m_position.store(qBound<qint64>(0, sample, m_count), std::memory_order_release);
+        m_tapFlush.store(true, std::memory_order_release);
+        m_loudnessReset.store(true, std::memory_order_release);
+    }
+
+    qsizetype readTap(float *dst, qsizetype count)
+    {
+        if (m_tapFlush.exchange(false, std::memory_order_acq_rel))
+            m_tap.clear();
+        return m_tap.read(dst, count);
+    }
+
+    qsizetype tapAvailable() const { return m_tap.readAvailable(); }
+
+    // Для потока GUI: последнее измерение громкости (false - нового нет)
+    bool takeLoudness() { return m_loudnessOutput.update(); }
+    const LoudnessMeter::Result &loudness() const { return m_loudnessOutput.readBuffer(); }
+
+    // Режим прослушивания при перемотке: вместо последовательного чтения
+    // отдаются короткие зёрна вокруг курсора. Вызывается при остановленном
+    // устройстве; grainLength - длина зерна в сэмплах, зёрна идут внахлёст
+    // на половину длины с окном Ханна, сумма окон равна единице.
+    void beginScrub(int grainLength, int holdFrames)
+    {
+        m_grainLength = qMax(2, grainLength & ~1);
+        m_holdFrames = holdFrames;
+        m_grainWindow.resize(m_grainLength);
+        for (int i = 0; i < m_grainLength; ++i)
+            m_grainWindow[i] = float(0.5 - 0.5 * std::cos(2 * M_PI * i / m_grainLength));
+        for (Grain &g : m_grains)
+            g.age = m_grainLength;
+        m_grainClock = 0;
+        m_idleFrames = holdFrames; // До первого движения курсора тишина
+        m_scrubTarget.store(double(position()), std::memory_order_release);
+        m_scrubRate.store(1.0, std::memory_order_release);
+        m_scrubbing.store(true, std::memory_order_release);
+    }
+
+    void endScrub()
+    {
+        m_scrubbing.store(false, std::memory_order_release);
+        m_loudnessReset.store(true, std::memory_order_release); // Дальше - с новой позиции
+    }
+
+    // Новое положение курсора и скорость чтения зёрен (из потока GUI)
+    void scrubTo(qint64 sample, double rate)
+    {
+        const qint64 bounded = qBound<qint64>(0, sample, m_count);
+        m_scrubTarget.store(double(bounded), std::memory_order_release);
+        m_scrubRate.store(rate, std::memory_order_release);
+        m_position.store(bounded, std::memory_order_release);
+        m_scrubSerial.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        const qint64 frames = m_scrubbing.load(std::memory_order_acquire) ? chunkFrames * 64
+                                                                           : m_count - position();
+        return frames * m_outChannels * qint64(sizeof(float)) + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override
+    {
+        if (m_scrubbing.load(std::memory_order_acquire))
+            return readScrub(data, maxlen);
+
+        const qint64 frameBytes = m_outChannels * qint64(sizeof(float));
+        qint64 pos = position();
+        const qint64 frames = qMin(maxlen / frameBytes, m_count - pos);
+        if (frames <= 0)
+            return 0;
+
+        // Кадры собираются порциями во временном буфере: data может быть не выровнен
+        float interleaved[chunkFrames * maxOutChannels];
+        float mono[chunkFrames];
+        const int sourceChannels = m_channels.size();
+        for (qint64 done = 0; done < frames; done += chunkFrames) {
+            const int n = int(qMin<qint64>(chunkFrames, frames - done));
+            for (int i = 0; i < n; ++i) {
+                const qint64 s = pos + done + i;
+                double mix = 0.0;
+                for (int ch = 0; ch < sourceChannels; ++ch)
+                    mix += m_channels[ch][s];
+                mono[i] = float(mix / sourceChannels);
+
+                // Моно размножается по выходам, лишние каналы источника не звучат
+                for (int c = 0; c < m_outChannels; ++c)
+                    interleaved[i * m_outChannels + c] = float(m_channels[c % sourceChannels][s]);
+            }
+            std::memcpy(data + done * frameBytes, interleaved, n * frameBytes);
+            m_tap.write(mono, n); // Если анализ не успевает, лишнее отбрасывается
+        }
+        measureLoudness(pos, frames);
+
+        // Перемотка во время чтения имеет приоритет над продвижением
+        m_position.compare_exchange_strong(pos, pos + frames, std::memory_order_acq_rel);
+        return frames * frameBytes;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+    // Громкость отданного устройству по исходным каналам (без громкости
+    // воспроизведения); с каждым шагом измерителя (100 мс) - публикация
+    void measureLoudness(qint64 pos, qint64 frames)
+    {
+        if (!m_loudness)
+            return;
+        if (m_loudnessReset.exchange(false, std::memory_order_acq_rel))
+            m_loudness->reset();
+
+        const double *channels[LoudnessMeter::maxChannels];
+        const int count = qMin(int(m_channels.size()), int(LoudnessMeter::maxChannels));
+        for (int c = 0; c < count; ++c)
+            channels[c] = m_channels[c].constData() + pos;
+        const qint64 steps = m_loudness->stepCount();
+        m_loudness->process(channels, frames);
+        if (m_loudness->stepCount() != steps) {
+            m_loudnessOutput.writeBuffer() = m_loudness->result();
+            m_loudnessOutput.publish();
+        }
+    }
+
+public:
+    static constexpr int maxOutChannels = 8;
+
+private:
+    static constexpr int chunkFrames = 256;
+    static constexpr qsizetype tapCapacity = 1 << 16;
+
+    struct Grain
+    {
+        double position = 0.0; // Дробная позиция чтения
+        double rate = 1.0;
+        float gain = 0.0f;
+        int age = 0; // Сэмплов от начала зерна; >= m_grainLength - зерно закончено
+    };
+
+    // Линейная интерполяция канала между сэмплами, за краями - тишина
+    float sampleAt(int channel, double position) const
+    {
+        const qint64 i = qint64(std::floor(position));
+        if (i < 0 || i + 1 >= m_count)
+            return 0.0f;
+        const QVector<double> &data = m_channels[channel];
+        const double t = position - double(i);
+        return float(data[i] + t * (data[i + 1] - data[i]));
+    }
+
+    // Новое зерно центрируется на курсоре. Если курсор стоит дольше
+    // m_holdFrames, зерно беззвучно: затихание сглаживается перекрытием окон.
+    void startGrain()
+    {
+        const quint64 serial = m_scrubSerial.load(std::memory_order_acquire);
+        if (serial != m_seenSerial) {
+            m_seenSerial = serial;
+            m_idleFrames = 0;
+        }
+
+        const double target = m_scrubTarget.load(std::memory_order_acquire);
+        const double rate = m_scrubRate.load(std::memory_order_acquire);
+        Grain &grain = m_grains[m_nextGrain];
+        m_nextGrain ^= 1;
+        grain.position = target - rate * m_grainLength / 2;
+        grain.rate = rate;
+        grain.gain = m_idleFrames < m_holdFrames ? 1.0f : 0.0f;
+        grain.age = 0;
+    }
+
+    qint64 readScrub(char *data, qint64 maxlen)
+    {
+        const qint64 frameBytes = m_outChannels * qint64(sizeof(float));
+        const qint64 frames = maxlen / frameBytes;
+        const int sourceChannels = m_channels.size();
+        if (frames <= 0 || sourceChannels == 0)
+            return 0;
+
+        const int hop = m_grainLength / 2;
+        float interleaved[chunkFrames * maxOutChannels];
+        float mono[chunkFrames];
+        for (qint64 done = 0; done < frames; done += chunkFrames) {
+            const int n = int(qMin<qint64>(chunkFrames, frames - done));
+            for (int i = 0; i < n; ++i) {
+                if (m_grainClock <= 0) {
+                    startGrain();
+                    m_grainClock = hop;
+                }
+                --m_grainClock;
+                ++m_idleFrames;
+
+                float *out = interleaved + i * m_outChannels;
+                std::fill(out, out + m_outChannels, 0.0f);
+                for (Grain &g : m_grains) {
+                    if (g.age >= m_grainLength)
+                        continue;
+                    const float w = g.gain * m_grainWindow[g.age];
+                    if (w > 0.0f) {
+                        for (int c = 0; c < m_outChannels; ++c)
+                            out[c] += w * sampleAt(c % sourceChannels, g.position);
+                    }
+                    g.position += g.rate;
+                    ++g.age;
+                }
+
+                float mix = 0.0f;
+                for (int c = 0; c < m_outChannels; ++c)
+                    mix += out[c];
+                mono[i] = mix / m_outChannels;
+            }
+            std::memcpy(data + done * frameBytes, interleaved, n * frameBytes);
+            m_tap.write(mono, n);
+        }
+        return frames * frameBytes;
+    }
+
+    QVector<QVector<double>> m_channels;
+    int m_outChannels = 1;
+    qint64 m_count = 0;
+    std::atomic<qint64> m_position{0};
+    std::atomic_bool m_tapFlush{false};
+    SpscRingBuffer<float> m_tap{tapCapacity};
+
+    // Измеритель - только звуковой поток; сброс после перемотки по флагу
+    std::unique_ptr<LoudnessMeter> m_loudness;
+    std::atomic_bool m_loudnessReset{false};
+    TripleBuffer<LoudnessMeter::Result> m_loudnessOutput;
+
+    // Прослушивание при перемотке: курсор и скорость пишет поток GUI,
+    // зёрна и счётчики - только звуковой поток
+    std::atomic_bool m_scrubbing{false};
+    std::atomic<double> m_scrubTarget{0.0};
+    std::atomic<double> m_scrubRate{1.0};
+    std::atomic<quint64> m_scrubSerial{0};
+    QVector<float> m_grainWindow;
+    int m_grainLength = 2;
+    int m_holdFrames = 0;
+    Grain m_grains[2];
+    int m_nextGrain = 0;
+    int m_grainClock = 0;
+    int m_idleFrames = 0;
+    quint64 m_seenSerial = 0;
+};
+
+PlaybackEngine::PlaybackEngine(QObject *parent)
+    : QObject(parent)
+    , m_source(new PlaybackSource(this))
+{
+    m_notifyTimer.setTimerType(Qt::PreciseTimer);
+    m_notifyTimer.setInterval(defaultNotifyIntervalMs);
+    connect(&m_notifyTimer, &QTimer::timeout, this, [this]() {
+        emit positionChanged(playbackPosition());
+    });
+}
+
+PlaybackEngine::~PlaybackEngine()
+{
+    destroySink(); // Звуковой поток не должен читать источник после разрушения
+}
+
+void PlaybackEngine::setOutput(Output output)
+{
+    if (m_output == output)
+        return;
+    stop();
+    destroySink();
+    m_output = output;
+}
+
+void PlaybackEngine::setSource(const QVector<QVector<double>> &channels, quint32 sampleRate)
+{
+    stop();
+    destroySink(); // Формат устройства зависит от частоты и числа каналов
+    m_sampleRate = sampleRate;
+    m_sourceChannels = channels.size();
+    m_source->setData(channels, 1, sampleRate);
+    emit positionChanged(0);
+}
+
+qint64 PlaybackEngine::sampleCount() const
+{
+    return m_source->sampleCount();
+}
+
+qint64 PlaybackEngine::position() const
+{
+    return m_source->position();
+}
+
+qint64 PlaybackEngine::playbackPosition() const
+{
+    return qMax<qint64>(0, position() - latencyFrames());
+}
+
+qint64 PlaybackEngine::latencyFrames() const
+{
+    const int frameBytes = m_format.bytesPerFrame();
+    if (!m_sink || frameBytes <= 0 || m_state != State::Playing || m_scrubbing)
+        return 0; // У NullAudioSink буфера нет
+    return (m_sink->bufferSize() - m_sink->bytesFree()) / frameBytes;
+}
+
+qsizetype PlaybackEngine::readTap(float *dst, qsizetype count)
+{
+    return m_source->readTap(dst, count);
+}
+
+qsizetype PlaybackEngine::tapAvailable() const
+{
+    return m_source->tapAvailable();
+}
+
+bool PlaybackEngine::takeLoudness()
+{
+    return m_source->takeLoudness();
+}
+
+const LoudnessMeter::Result &PlaybackEngine::loudness() const
+{
+    return m_source->loudness();
+}
+
+void PlaybackEngine::setVolume(float volume)
+{
+    m_volume = qBound(0.0f, volume, 1.0f);
+    if (m_sink)
+        m_sink->setVolume(m_volume);
+    if (m_nullSink)
+        m_nullSink->setVolume(m_volume);
+}
+
+void PlaybackEngine::play()
+{
+    if (m_scrubbing) {
+        m_resumeAfterScrub = true; // Начнётся по endScrub()
+        return;
+    }
+    if (m_state == State::Playing || m_sampleRate == 0 || sampleCount() == 0)
+        return;
+
+    // После перемотки на паузе устройства нет - старт заново с позиции
+    if (m_state == State::Paused && (m_sink || m_nullSink)) {
+        if (m_sink)
+            m_sink->resume();
+        if (m_nullSink)
+            m_nullSink->resume();
+    } else {
+        if (position() >= sampleCount())
+            m_source->setPosition(0);
+        if (!m_sink && !m_nullSink && !createSink(bufferMs))
+            return;
+        if (!startSink())
+            return;
+    }
+
+    if (m_notifyTimer.interval() > 0)
+        m_notifyTimer.start();
+    setState(State::Playing);
+}
+
+void PlaybackEngine::setNotifyInterval(int ms)
+{
+    m_notifyTimer.setInterval(qMax(0, ms));
+    if (ms <= 0)
+        m_notifyTimer.stop();
+    else if (m_state == State::Playing)
+        m_notifyTimer.start();
+}
+
+void PlaybackEngine::pause()
+{
+    if (m_scrubbing) {
+        m_resumeAfterScrub = false;
+        return;
+    }
+    if (m_state != State::Playing)
+        return;
+    const qint64 heard = playbackPosition();
+    if (m_sink)
+        m_sink->suspend();
+    if (m_nullSink)
+        m_nullSink->suspend();
+    m_notifyTimer.stop();
+    setState(State::Paused);
+    emit positionChanged(heard);
+}
+
+void PlaybackEngine::stop()
+{
+    m_resumeAfterScrub = false;
+    endScrub();
+    if (m_state == State::Stopped && position() == 0)
+        return;
+    m_notifyTimer.stop();
+    if (m_sink)
+        m_sink->stop();
+    if (m_nullSink)
+        m_nullSink->stop();
+    m_source->setPosition(0);
+    setState(State::Stopped);
+    emit positionChanged(0);
+}
+
+// Перемотка; во время воспроизведения устройство перезапускается, чтобы
+// старое содержимое буфера не доигрывало после прыжка
+void PlaybackEngine::seek(qint64 sample)
+{
+    if (m_scrubbing) {
+        scrubTo(sample);
+        return;
+    }
+    m_source->setPosition(sample);
+    if (m_state == State::Playing) {
+        if (m_sink)
+            m_sink->stop();
+        if (m_nullSink)
+            m_nullSink->stop();
+        startSink();
+    }
+    emit positionChanged(position());
+}
+
+// Основное устройство закрывается, источник переходит в режим зёрен и
+// читается через устройство с буфером scrubBufferMs
+void PlaybackEngine::beginScrub()
+{
+    if (m_scrubbing || m_sampleRate == 0 || sampleCount() == 0)
+        return;
+
+    m_resumeAfterScrub = m_state == State::Playing;
+    if (m_resumeAfterScrub)
+        m_source->setPosition(playbackPosition()); // Продолжить с того, что звучало
+    m_notifyTimer.stop();
+    destroySink();
+
+    m_scrubbing = true;
+    m_scrubTarget = position();
+    m_scrubVelocity = 0.0;
+    m_scrubRate = 1.0;
+    m_scrubClock.start();
+
+    const int grain = int(qint64(m_sampleRate) * grainMs / 1000);
+    const int hold = int(qint64(m_sampleRate) * scrubHoldMs / 1000);
+    m_source->beginScrub(grain, hold);
+    if (!createSink(scrubBufferMs) || !startSink()) {
+        m_source->endScrub();
+        m_scrubbing = false;
+        destroySink();
+    }
+}
+
+// Скорость чтения зёрен следует за скоростью курсора: медленное движение
+// звучит ниже, быстрое выше, в пределах minScrubRate..maxScrubRate
+void PlaybackEngine::scrubTo(qint64 sample)
+{
+    if (!m_scrubbing) {
+        seek(sample);
+        return;
+    }
+
+    sample = qBound<qint64>(0, sample, sampleCount());
+    const double dtMs = qMax<qint64>(1, m_scrubClock.restart());
+    const double velocity = double(sample - m_scrubTarget) * 1000.0 / dtMs;
+    const double alpha = 1.0 - std::exp(-dtMs / scrubSmoothMs);
+    m_scrubVelocity += alpha * (velocity - m_scrubVelocity);
+    m_scrubTarget = sample;
+
+    const double speed = qBound(minScrubRate, std::abs(m_scrubVelocity) / m_sampleRate, maxScrubRate);
+    m_scrubRate = m_scrubVelocity < 0 ? -speed : speed;
+    m_source->scrubTo(sample, m_scrubRate);
+    emit positionChanged(sample);
+}
+
+void PlaybackEngine::endScrub()
+{
+    if (!m_scrubbing)
+        return;
+
+    destroySink();
+    m_source->endScrub();
+    m_scrubbing = false;
+    m_source->setPosition(m_scrubTarget);
+
+    if (m_resumeAfterScrub) {
+        if (createSink(bufferMs) && startSink()) {
+            if (m_notifyTimer.interval() > 0)
+                m_notifyTimer.start();
+            setState(State::Playing);
+        } else {
+            setState(State::Stopped);
+        }
+    } else if (m_state == State::Playing) {
+        setState(State::Paused); // Пауза во время перемотки
+    }
+    m_resumeAfterScrub = false;
+    emit positionChanged(position());
+}
+
+bool PlaybackEngine::startSink()
+{
+    if (!m_source->isOpen())
+        m_source->open(QIODevice::ReadOnly | QIODevice::Unbuffered); // Без упреждающего чтения
+    if (m_sink) {
+        m_sink->start(m_source);
+        if (m_sink->error() != QAudio::NoError) {
+            emit errorOccurred(tr("Не удалось запустить звуковое устройство"));
+            return false;
+        }
+    }
+    if (m_nullSink)
+        m_nullSink->start(m_source);
+    return true;
+}
+
+// Формат - float с числом каналов источника, если устройство его принимает,
+// иначе стерео или моно
+bool PlaybackEngine::createSink(int bufferSizeMs)
+{
+    m_format = QAudioFormat();
+    m_format.setSampleRate(int(m_sampleRate));
+    m_format.setSampleFormat(QAudioFormat::Float);
+
+    const int wanted = qBound(1, m_sourceChannels, PlaybackSource::maxOutChannels);
+    if (m_output == Output::Null) {
+        m_format.setChannelCount(wanted);
+        m_nullSink = new NullAudioSink(m_format, this);
+        m_nullSink->setVolume(m_volume);
+        connect(m_nullSink, &NullAudioSink::stateChanged, this, &PlaybackEngine::onSinkStateChanged);
+    } else {
+        const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+        bool supported = false;
+        for (int channels : {wanted, 2, 1}) {
+            m_format.setChannelCount(channels);
+            if (device.isFormatSupported(m_format)) {
+                supported = true;
+                break;
+            }
+        }
+        if (device.isNull() || !supported) {
+            emit errorOccurred(tr("Звуковое устройство не поддерживает формат %1 Гц float")
+                                   .arg(m_sampleRate));
+            return false;
+        }
+
+        m_sink = new QAudioSink(device, m_format, this);
+        m_sink->setBufferSize(m_format.bytesForDuration(qint64(bufferSizeMs) * 1000));
+        m_sink->setVolume(m_volume);
+        connect(m_sink, &QAudioSink::stateChanged, this, &PlaybackEngine::onSinkStateChanged);
+    }
+
+    m_source->setOutChannels(m_format.channelCount());
+    return true;
+}
+
+void PlaybackEngine::destroySink()
+{
+    if (m_sink) {
+        m_sink->stop();
+        delete m_sink;
+        m_sink = nullptr;
+    }
+    if (m_nullSink) {
+        m_nullSink->stop();
+        delete m_nullSink;
+        m_nullSink = nullptr;
+    }
+    if (m_source->isOpen())
+        m_source->close();
+}
+
+void PlaybackEngine::setState(State state)
+{
+    if (m_state == state)
+        return;
+    m_state = state;
+    emit stateChanged(state);
+}
+
+// Устройство доиграло источник до конца
+void PlaybackEngine::onSinkStateChanged(QAudio::State state)
+{
+    if (state == QAudio::IdleState && m_state == State::Playing && !m_scrubbing
+        && position() >= sampleCount()) {
+        m_notifyTimer.stop();
+        if (m_sink)
+            m_sink->stop();
+        if (m_nullSink)
+            m_nullSink->stop();
+        setState(State::Stopped);
+        emit positionChanged(sampleCount());
+        emit finished();
+    }
+}
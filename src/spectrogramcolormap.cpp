@@ -0,0 +1,22 @@
+#include "spectrogramcolormap.h"
+#include <algorithm>
+#include <cmath>
+
+void SpectrogramColorMap::setDecibelRange(double minDb, double maxDb)
+{
+    if (maxDb <= minDb)
+        return;
+    m_minDb = minDb;
+    m_maxDb = maxDb;
+}
+
+// Преобразование величины амплитуды в цвет
+QRgb SpectrogramColorMap::color(double magnitude) const
+{
+    const double db = 20 * std::log10(magnitude + 1e-12); // +1e-12 чтобы избежать log(0)
+    const double norm = std::clamp((db - m_minDb) / (m_maxDb - m_minDb), 0.0, 1.0);
+
+    // Градации желтого: от черного (0) до желтого (1)
+    const int intensity = static_cast<int>(norm * 255);
+    return qRgb(intensity, intensity, 0);
+}
@@ -0,0 +1,402 @@
+#include "spectrogramexporter.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QtEndian>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+// Запись изображения/матрицы по полосам строк
+class StripWriter
+{
+public:
+    virtual ~StripWriter() = default;
+    virtual bool begin(QFile &file, int width, qint64 height) = 0;
+    virtual bool writeRows(QFile &file, const float *mags, int rows) = 0;
+    virtual bool finish(QFile &file) = 0;
+};
+
+template<typename T>
+void appendLittleEndian(QByteArray &out, T value)
+{
+    value = qToLittleEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+void appendBigEndian(QByteArray &out, T value)
+{
+    value = qToBigEndian(value);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Перевод строк магнитуд в RGB по общей палитре
+void rowsToRgb(const SpectrogramColorMap &colorMap, const float *mags, int count, uchar *rgb)
+{
+    for (int i = 0; i < count; ++i) {
+        const QRgb c = colorMap.color(mags[i]);
+        rgb[3 * i] = uchar(qRed(c));
+        rgb[3 * i + 1] = uchar(qGreen(c));
+        rgb[3 * i + 2] = uchar(qBlue(c));
+    }
+}
+
+// PNG без сжатия: поток zlib из блоков deflate типа stored, порезанный на чанки IDAT
+class PngStripWriter : public StripWriter
+{
+public:
+    explicit PngStripWriter(const SpectrogramColorMap &colorMap)
+        : m_colorMap(colorMap)
+    {}
+
+    bool begin(QFile &file, int width, qint64 height) override
+    {
+        if (height > 0x7fffffff)
+            return false;
+
+        m_width = width;
+        m_row.resize(1 + 3 * width); // Байт фильтра (0) + RGB
+
+        QByteArray header("\x89PNG\r\n\x1a\n", 8);
+        QByteArray ihdr;
+        appendBigEndian<quint32>(ihdr, quint32(width));
+        appendBigEndian<quint32>(ihdr, quint32(height));
+        ihdr.append(char(8)); // Бит на канал
+        ihdr.append(char(2)); // RGB
+        ihdr.append(char(0)); // Сжатие deflate
+        ihdr.append(char(0)); // Стандартная фильтрация
+        ihdr.append(char(0)); // Без чересстрочности
+        appendChunk(header, "IHDR", ihdr);
+
+        m_idat.append(char(0x78)); // Заголовок zlib (deflate, окно 32K)
+        m_idat.append(char(0x01));
+        return file.write(header) == header.size();
+    }
+
+    bool writeRows(QFile &file, const float *mags, int rows) override
+    {
+        for (int r = 0; r < rows; ++r) {
+            m_row[0] = 0;
+            rowsToRgb(m_colorMap,
+                      mags + qsizetype(r) * m_width,
+                      m_width,
+                      reinterpret_cast<uchar *>(m_row.data()) + 1);
+            updateAdler(m_row);
+            m_block.append(m_row);
+
+            while (m_block.size() >= maxStoredBlock) {
+                appendStoredBlock(m_block.left(maxStoredBlock), false);
+                m_block.remove(0, maxStoredBlock);
+            }
+        }
+        return m_idat.size() < idatChunkSize || flushIdat(file);
+    }
+
+    bool finish(QFile &file) override
+    {
+        appendStoredBlock(m_block, true);
+        m_block.clear();
+        appendBigEndian<quint32>(m_idat, (m_adlerB << 16) | m_adlerA);
+        if (!flushIdat(file))
+            return false;
+
+        QByteArray tail;
+        appendChunk(tail, "IEND", QByteArray());
+        return file.write(tail) == tail.size();
+    }
+
+private:
+    static constexpr int maxStoredBlock = 65535;
+    static constexpr int idatChunkSize = 1 << 20;
+
+    void appendStoredBlock(const QByteArray &data, bool final)
+    {
+        m_idat.append(char(final ? 1 : 0));
+        appendLittleEndian<quint16>(m_idat, quint16(data.size()));
+        appendLittleEndian<quint16>(m_idat, quint16(~data.size()));
+        m_idat.append(data);
+    }
+
+    bool flushIdat(QFile &file)
+    {
+        QByteArray chunk;
+        appendChunk(chunk, "IDAT", m_idat);
+        m_idat.clear();
+        return file.write(chunk) == chunk.size();
+    }
+
+    void updateAdler(const QByteArray &data)
+    {
+        for (char c : data) {
+            m_adlerA = (m_adlerA + uchar(c)) % 65521;
+            m_adlerB = (m_adlerB + m_adlerA) % 65521;
+        }
+    }
+
+    static quint32 crc32(const QByteArray &data)
+    {
+        static const QVector<quint32> table = [] {
+            QVector<quint32> t(256);
+            for (quint32 n = 0; n < 256; ++n) {
+                quint32 c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        quint32 crc = 0xffffffffu;
+        for (char c : data)
+            crc = table[(crc ^ uchar(c)) & 0xff] ^ (crc >> 8);
+        return crc ^ 0xffffffffu;
+    }
+
+    static void appendChunk(QByteArray &out, const char *type, const QByteArray &data)
+    {
+        appendBigEndian<quint32>(out, quint32(data.size()));
+        QByteArray body(type, 4);
+        body.append(data);
+        out.append(body);
+        appendBigEndian<quint32>(out, crc32(body));
+    }
+
+    const SpectrogramColorMap &m_colorMap;
+    int m_width = 0;
+    QByteArray m_row;
+    QByteArray m_block; // Несжатые данные, ещё не упакованные в блок stored
+    QByteArray m_idat;  // Данные очередного чанка IDAT
+    quint32 m_adlerA = 1;
+    quint32 m_adlerB = 0;
+};
+
+// Базовый TIFF без сжатия: полосы пишутся по мере расчёта, IFD - в конце файла
+class TiffStripWriter : public StripWriter
+{
+public:
+    explicit TiffStripWriter(const SpectrogramColorMap &colorMap)
+        : m_colorMap(colorMap)
+    {}
+
+    bool begin(QFile &file, int width, qint64 height) override
+    {
+        // Классический TIFF адресует не более 4 ГБ
+        if (qint64(width) * 3 * height > 0xfff00000LL)
+            return false;
+
+        m_width = width;
+        m_height = height;
+
+        QByteArray header("II", 2);
+        appendLittleEndian<quint16>(header, 42);
+        appendLittleEndian<quint32>(header, 0); // Смещение IFD, заполняется в finish()
+        return file.write(header) == header.size();
+    }
+
+    bool writeRows(QFile &file, const float *mags, int rows) override
+    {
+        if (m_rowsPerStrip == 0)
+            m_rowsPerStrip = rows;
+
+        QByteArray strip(qsizetype(rows) * m_width * 3, Qt::Uninitialized);
+        rowsToRgb(m_colorMap, mags, rows * m_width, reinterpret_cast<uchar *>(strip.data()));
+
+        m_stripOffsets.append(quint32(file.pos()));
+        m_stripByteCounts.append(quint32(strip.size()));
+        return file.write(strip) == strip.size();
+    }
+
+    bool finish(QFile &file) override
+    {
+        if (file.pos() % 2)
+            file.write("\0", 1); // Выравнивание на слово
+
+        const quint32 bitsOffset = quint32(file.pos());
+        QByteArray extra;
+        for (int i = 0; i < 3; ++i)
+            appendLittleEndian<quint16>(extra, 8);
+
+        const int strips = m_stripOffsets.size();
+        const quint32 offsetsOffset = bitsOffset + quint32(extra.size());
+        for (quint32 v : m_stripOffsets)
+            appendLittleEndian<quint32>(extra, v);
+        const quint32 countsOffset = bitsOffset + quint32(extra.size());
+        for (quint32 v : m_stripByteCounts)
+            appendLittleEndian<quint32>(extra, v);
+
+        const quint32 ifdOffset = bitsOffset + quint32(extra.size());
+        QByteArray ifd;
+        auto entry = [&ifd](quint16 tag, quint16 type, quint32 count, quint32 value) {
+            appendLittleEndian<quint16>(ifd, tag);
+            appendLittleEndian<quint16>(ifd, type);
+            appendLittleEndian<quint32>(ifd, count);
+            appendLittleEndian<quint32>(ifd, value);
+        };
+        const quint16 typeShort = 3;
+        const quint16 typeLong = 4;
+
+        appendLittleEndian<quint16>(ifd, 10); // Число записей
+        entry(256, typeLong, 1, quint32(m_width));      // ImageWidth
+        entry(257, typeLong, 1, quint32(m_height));     // ImageLength
+        entry(258, typeShort, 3, bitsOffset);           // BitsPerSample
+        entry(259, typeShort, 1, 1);                    // Compression: нет
+        entry(262, typeShort, 1, 2);                    // Photometric: RGB
+        entry(273, typeLong, strips, strips == 1 ? m_stripOffsets[0] : offsetsOffset);
+        entry(277, typeShort, 1, 3);                    // SamplesPerPixel
+        entry(278, typeLong, 1, quint32(m_rowsPerStrip)); // RowsPerStrip
+        entry(279, typeLong, strips, strips == 1 ? m_stripByteCounts[0] : countsOffset);
+        entry(284, typeShort, 1, 1);                    // PlanarConfiguration
+        appendLittleEndian<quint32>(ifd, 0);            // Следующего IFD нет
+
+        extra.append(ifd);
+        if (file.write(extra) != extra.size())
+            return false;
+
+        QByteArray offset;
+        appendLittleEndian<quint32>(offset, ifdOffset);
+        return file.seek(4) && file.write(offset) == offset.size();
+    }
+
+private:
+    const SpectrogramColorMap &m_colorMap;
+    int m_width = 0;
+    qint64 m_height = 0;
+    int m_rowsPerStrip = 0;
+    QVector<quint32> m_stripOffsets;
+    QVector<quint32> m_stripByteCounts;
+};
+
+// Матрица float32 в дБ: "AFSG", число строк (кадров) и столбцов (бинов), данные построчно
+class RawFloatWriter : public StripWriter
+{
+public:
+    bool begin(QFile &file, int width, qint64 height) override
+    {
+        if (height > 0xffffffffLL)
+            return false;
+
+        QByteArray header("AFSG", 4);
+        appendLittleEndian<quint32>(header, quint32(height));
+        appendLittleEndian<quint32>(header, quint32(width));
+        m_width = width;
+        return file.write(header) == header.size();
+    }
+
+    bool writeRows(QFile &file, const float *mags, int rows) override
+    {
+        const qsizetype count = qsizetype(rows) * m_width;
+        QByteArray data(count * qsizetype(sizeof(float)), Qt::Uninitialized);
+        auto *out = reinterpret_cast<float *>(data.data());
+        for (qsizetype i = 0; i < count; ++i)
+            out[i] = qToLittleEndian(float(20 * std::log10(mags[i] + 1e-12)));
+        return file.write(data) == data.size();
+    }
+
+    bool finish(QFile &) override { return true; }
+
+private:
+    int m_width = 0;
+};
+
+} // namespace
+
+SpectrogramExporter::SpectrogramExporter(QObject *parent)
+    : QObject(parent)
+{}
+
+void SpectrogramExporter::setSamples(const QVector<double> &samples)
+{
+    m_samples = samples;
+}
+
+SpectrogramExporter::Format SpectrogramExporter::formatForFile(const QString &filePath)
+{
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "tif" || suffix == "tiff")
+        return Format::Tiff;
+    if (suffix == "png")
+        return Format::Png;
+    return Format::RawFloat;
+}
+
+bool SpectrogramExporter::exportTo(const QString &filePath, Format format, QString &errorString)
+{
+    m_cancelled = false;
+
+    const int bins = SpectrogramCache::binCount;
+    const qint64 frames = SpectrogramCache::frameCountFor(m_samples.size(), m_hop);
+    if (frames <= 0) {
+        errorString = tr("Недостаточно данных для спектрограммы.");
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorString = tr("Не удалось открыть файл %1").arg(filePath);
+        return false;
+    }
+
+    std::unique_ptr<StripWriter> writer;
+    switch (format) {
+    case Format::Png:
+        writer.reset(new PngStripWriter(m_colorMap));
+        break;
+    case Format::Tiff:
+        writer.reset(new TiffStripWriter(m_colorMap));
+        break;
+    case Format::RawFloat:
+        writer.reset(new RawFloatWriter);
+        break;
+    }
+
+    if (!writer->begin(file, bins, frames)) {
+        errorString = tr("Спектрограмма слишком велика для выбранного формата.");
+        file.remove();
+        return false;
+    }
+
+    // В памяти только одна полоса; её кадры считаются параллельно
+    QVector<float> strip(qsizetype(m_stripFrames) * bins);
+    float *stripData = strip.data();
+    QThreadPool pool;
+    const int chunks = qMax(1, pool.maxThreadCount());
+
+    for (qint64 first = 0; first < frames; first += m_stripFrames) {
+        if (m_cancelled) {
+            errorString = tr("Экспорт отменён.");
+            file.remove();
+            return false;
+        }
+
+        const int count = int(qMin<qint64>(m_stripFrames, frames - first));
+        const int perChunk = (count + chunks - 1) / chunks;
+        for (int offset = 0; offset < count; offset += perChunk) {
+            const int n = qMin(perChunk, count - offset);
+            pool.start([this, first, offset, n, stripData]() {
+                SpectrogramCache::computeFrames(m_samples,
+                                                m_mode,
+                                                m_hop,
+                                                first + offset,
+                                                n,
+                                                stripData + qsizetype(offset) * bins);
+            });
+        }
+        pool.waitForDone();
+
+        if (!writer->writeRows(file, stripData, count)) {
+            errorString = tr("Ошибка записи в файл %1").arg(filePath);
+            file.remove();
+            return false;
+        }
+        emit progress(int((first + count) * 100 / frames));
+    }
+
+    if (!writer->finish(file)) {
+        errorString = tr("Ошибка записи в файл %1").arg(filePath);
+        file.remove();
+        return false;
+    }
+    return true;
+}
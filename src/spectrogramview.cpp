@@ -1,6 +1,14 @@
 #include "spectrogramview.h"
+#include "framescheduler.h"
+#include "spectrogramcache.h"
+#include "timeviewport.h"
+#include <QContextMenuEvent>
+#include <QHash>
+#include <QMenu>
 #include <QPainter>
 #include <QResizeEvent>
+#include <QTimer>
+#include <QWheelEvent>
 #include <algorithm>
 #include <cmath>
 
@@ -10,6 +18,77 @@ SpectrogramView::SpectrogramView(QWidget *parent)
     setMinimumHeight(150); // Минимальная высота виджета
 }
 
+// Подключение ленивого источника кадров
+void SpectrogramView::setCache(SpectrogramCache *cache)
+{
+    if (m_cache)
+        disconnect(m_cache, nullptr, this, nullptr);
+
+    m_cache = cache;
+    if (m_cache) {
+        connect(m_cache, &SpectrogramCache::samplesChanged, this, &SpectrogramView::scheduleRefresh);
+        connect(m_cache, &SpectrogramCache::modeChanged, this, &SpectrogramView::scheduleRefresh);
+        connect(m_cache, &SpectrogramCache::tileReady, this, &SpectrogramView::scheduleRefresh);
+    }
+    scheduleRefresh();
+}
+
+// Перерисовка на ближайшем кадре экрана, если задан общий такт
+void SpectrogramView::setFrameScheduler(FrameScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+}
+
+void SpectrogramView::scheduleUpdate()
+{
+    if (m_scheduler)
+        m_scheduler->schedule(this);
+    else
+        update();
+}
+
+void SpectrogramView::scheduleUpdate(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+    if (m_scheduler)
+        m_scheduler->schedule(this, rect);
+    else
+        update(rect);
+}
+
+// Подключение общей временной оси
+void SpectrogramView::setViewport(TimeViewport *viewport)
+{
+    if (m_viewport)
+        disconnect(m_viewport, nullptr, this, nullptr);
+
+    m_viewport = viewport;
+    if (m_viewport) {
+        connect(m_viewport, &TimeViewport::rangeChanged, this, [this]() {
+            QMutexLocker locker(&m_mutex);
+            updateImage();
+            scheduleUpdate();
+        });
+        connect(m_viewport, &TimeViewport::markerChanged, this, [this]() { scheduleUpdate(); });
+    }
+    scheduleRefresh();
+}
+
+// Объединение частых обновлений (плитки приходят пачками) в одну перерисовку
+void SpectrogramView::scheduleRefresh()
+{
+    if (m_refreshPending)
+        return;
+    m_refreshPending = true;
+    QTimer::singleShot(30, this, [this]() {
+        m_refreshPending = false;
+        QMutexLocker locker(&m_mutex);
+        updateImage();
+        scheduleUpdate();
+    });
+}
+
 // Добавление нового среза спектра
 void SpectrogramView::addSpectrumSlice(const QVector<double> &freqBins,
                                        const QVector<double> &magnitudes)
@@ -33,7 +112,28 @@ void SpectrogramView::addSpectrumSlice(const QVector<double> &freqBins,
         m_spectrogramData.pop_front(); // Удаление устаревших данных
 
     updateImage();
-    update(); // Запрос перерисовки
+    scheduleUpdate(); // Запрос перерисовки
+}
+
+void SpectrogramView::addSpectrumSlices(const QVector<double> &freqBins,
+                                        const QVector<QVector<double>> &slices)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_freqBinCount == 0)
+        m_freqBinCount = freqBins.size();
+    if (freqBins.size() != m_freqBinCount)
+        return;
+
+    for (const QVector<double> &magnitudes : slices) {
+        if (magnitudes.size() == m_freqBinCount)
+            m_spectrogramData.append(magnitudes);
+    }
+    while (m_spectrogramData.size() > m_maxTimeSlices)
+        m_spectrogramData.pop_front();
+
+    updateImage();
+    scheduleUpdate();
 }
 
 // Установка новых данных спектрограммы
@@ -45,7 +145,7 @@ void SpectrogramView::setSpectrogramData(const QVector<QVector<double>> &data)
     m_freqBinCount = data.isEmpty() ? 0 : data[0].size();
 
     updateImage();
-    update();
+    scheduleUpdate();
 }
 
 void SpectrogramView::clear() // Очистка данных спектрограммы
@@ -54,7 +154,7 @@ void SpectrogramView::clear() // Очистка данных спектрогр
 
     m_spectrogramData.clear();
     m_image = QImage(); // Сброс изображения
-    update();
+    scheduleUpdate();
 }
 
 // Отрисовка виджета
@@ -74,6 +174,17 @@ void SpectrogramView::paintEvent(QPaintEvent *)
 
     // Отрисовка спектрограммы
     painter.drawImage(rect(), m_image);
+
+    // Маркер воспроизведения поверх ленивой спектрограммы
+    if (m_spectrogramData.isEmpty() && m_viewport && !m_viewport->isEmpty()) {
+        const double markerSample = m_viewport->markerSeconds() * m_viewport->sampleRate();
+        const double markerX = m_viewport->xForSample(markerSample, width());
+        if (markerX >= 0.0 && markerX <= width()) {
+            const int mx = int(markerX);
+            painter.setPen(QPen(Qt::red, 2));
+            painter.drawLine(mx, 0, mx, height());
+        }
+    }
 }
 
 // Обработка изменения размера виджета
@@ -83,11 +194,59 @@ void SpectrogramView::resizeEvent(QResizeEvent *event)
     updateImage(); // Обновление изображения под новый размер
 }
 
+// Переключение способа расчёта ленивой спектрограммы
+void SpectrogramView::setMode(SpectrogramCache::Mode mode)
+{
+    if (m_cache)
+        m_cache->setMode(mode);
+}
+
+// Контекстное меню выбора режима
+void SpectrogramView::contextMenuEvent(QContextMenuEvent *event)
+{
+    if (!m_cache)
+        return;
+
+    QMenu menu(this);
+    QAction *standardAct = menu.addAction("STFT");
+    QAction *reassignedAct = menu.addAction("Reassigned");
+    standardAct->setCheckable(true);
+    reassignedAct->setCheckable(true);
+    standardAct->setChecked(m_cache->mode() == SpectrogramCache::Mode::Standard);
+    reassignedAct->setChecked(m_cache->mode() == SpectrogramCache::Mode::Reassigned);
+
+    QAction *chosen = menu.exec(event->globalPos());
+    if (chosen == standardAct)
+        setMode(SpectrogramCache::Mode::Standard);
+    else if (chosen == reassignedAct)
+        setMode(SpectrogramCache::Mode::Reassigned);
+}
+
+// Масштабирование общей временной оси колесом мыши (как в осциллограмме)
+void SpectrogramView::wheelEvent(QWheelEvent *event)
+{
+    if ((event->modifiers() & Qt::ControlModifier) && m_viewport && !m_viewport->isEmpty()
+        && width() > 0) {
+        double anchor = m_viewport->sampleAt(event->position().x(), width());
+        m_viewport->zoomAt(anchor, event->angleDelta().y() > 0 ? 1.25 : 0.8);
+        event->accept();
+    } else {
+        QWidget::wheelEvent(event);
+    }
+}
+
 // Генерация изображения спектрограммы
 void SpectrogramView::updateImage()
 {
-    if (m_spectrogramData.isEmpty() || m_freqBinCount == 0)
+    if (m_spectrogramData.isEmpty() && m_cache && m_cache->levelCount() > 0) {
+        updateLazyImage();
+        return;
+    }
+
+    if (m_spectrogramData.isEmpty() || m_freqBinCount == 0) {
+        m_image = QImage();
         return;
+    }
 
     const int width = m_spectrogramData.size(); // Временные отсчеты (ось X)
     const int height = m_freqBinCount;          // Частотные бины (ось Y)
@@ -108,13 +267,85 @@ void SpectrogramView::updateImage()
     m_image = img.scaled(size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 }
 
+// Генерация изображения из плиток кэша: по одному кадру на столбец пикселей
+// видимого диапазона, шаг кадров подбирается под масштаб
+void SpectrogramView::updateLazyImage()
+{
+    const int w = width();
+    const int bins = SpectrogramCache::binCount;
+    const qint64 total = m_cache->sampleCount();
+    if (w <= 0 || height() <= 0 || total <= 0)
+        return;
+
+    double start = 0.0;
+    double span = double(total);
+    if (m_viewport && m_viewport->totalSamples() == total) {
+        start = m_viewport->startSample();
+        span = m_viewport->visibleSamples();
+    }
+
+    const double spp = span / w;
+    const int level = m_cache->levelForResolution(spp);
+    const int levels = m_cache->levelCount();
+
+    QImage img(w, bins, QImage::Format_RGB32);
+    img.fill(Qt::black);
+
+    QHash<quint64, SpectrogramCache::Tile> tiles; // Локальная копия, чтобы не блокировать кэш
+    qint64 firstFrame = -1;
+    qint64 lastFrame = -1;
+
+    for (int x = 0; x < w; ++x) {
+        const double center = start + (x + 0.5) * spp - SpectrogramCache::fftSize / 2.0;
+
+        // Поиск кадра на нужном уровне, при отсутствии - на более грубых
+        const float *mags = nullptr;
+        for (int l = level; l < levels && !mags; ++l) {
+            const qint64 frames = m_cache->frameCount(l);
+            const qint64 frame = qBound<qint64>(0,
+                                                qRound64(center / SpectrogramCache::hopForLevel(l)),
+                                                frames - 1);
+            if (l == level) {
+                if (firstFrame < 0)
+                    firstFrame = frame;
+                lastFrame = frame;
+            }
+
+            const qint64 tileIndex = frame / SpectrogramCache::tileFrames;
+            const quint64 key = SpectrogramCache::tileKey(m_cache->mode(), l, tileIndex);
+            auto it = tiles.find(key);
+            if (it == tiles.end())
+                it = tiles.insert(key, m_cache->tile(l, tileIndex));
+            if (*it)
+                mags = (*it)->constData() + (frame % SpectrogramCache::tileFrames) * bins;
+        }
+
+        if (!mags)
+            continue;
+
+        for (int y = 0; y < bins; ++y) {
+            auto *line = reinterpret_cast<QRgb *>(img.scanLine(bins - 1 - y)); // Низкие частоты внизу
+            line[x] = m_colorMap.color(mags[y]);
+        }
+    }
+
+    if (firstFrame >= 0)
+        m_cache->requestFrames(level, firstFrame, lastFrame);
+
+    m_image = img.scaled(size(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
 // Преобразование величины амплитуды в цвет
 QColor SpectrogramView::magnitudeToColor(double magnitude) const
 {
-    constexpr double maxMagnitude = 1.0;
-    double norm = std::clamp(magnitude / maxMagnitude, 0.0, 1.0);
+    return QColor::fromRgb(m_colorMap.color(magnitude));
+}
 
-    // Градации желтого: от черного (0) до желтого (1)
-    int intensity = static_cast<int>(norm * 255);
-    return QColor(intensity, intensity, 0);
+// Диапазон дБ палитры (тот же используется при экспорте)
+void SpectrogramView::setDecibelRange(double minDb, double maxDb)
+{
+    QMutexLocker locker(&m_mutex);
+    m_colorMap.setDecibelRange(minDb, maxDb);
+    updateImage();
+    scheduleUpdate();
 }
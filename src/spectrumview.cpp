@@ -1,4 +1,7 @@
 #include "spectrumview.h"
+#include "framescheduler.h"
+#include "spectrumanalyzer.h"
+#include "spectrumtrack.h"
 #include <QDebug>
 #include <QMouseEvent>
 #include <QPainter>
@@ -47,14 +50,14 @@ void SpectrumView::setFrequencyRange(double minFreq, double maxFreq)
 {
     m_minFrequency = minFreq;
     m_maxFrequency = maxFreq;
-    update();
+    invalidateStaticLayer();
 }
 
 void SpectrumView::setDecibelRange(double minDB, double maxDB)
 {
     m_minDB = minDB;
     m_maxDB = maxDB;
-    update();
+    invalidateStaticLayer();
 }
 
 void SpectrumView::setSpectrumData(const QVector<double> &frequencies,
@@ -64,36 +67,212 @@ void SpectrumView::setSpectrumData(const QVector<double> &frequencies,
         return;
 
     QMutexLocker locker(&m_mutex);
-    m_spectrumData.clear();
-    m_spectrumData.reserve(frequencies.size());
+    if (frequencies != m_frequencies) {
+        m_frequencies = frequencies;
+        m_averager.reset();
+    }
+
+    m_frameDb.resize(magnitudes.size());
+    for (int i = 0; i < magnitudes.size(); ++i)
+        m_frameDb[i] = float(magnitudes[i]);
+    pushFrame(m_frameDb.constData(), m_frameDb.size(), 0.0);
+
+    invalidateStaticLayer();
+}
+
+// Перерисовка на ближайшем кадре экрана, если задан общий такт
+void SpectrumView::setFrameScheduler(FrameScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+}
+
+void SpectrumView::scheduleUpdate()
+{
+    if (m_scheduler)
+        m_scheduler->schedule(this);
+    else
+        update();
+}
+
+void SpectrumView::scheduleUpdate(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+    if (m_scheduler)
+        m_scheduler->schedule(this, rect);
+    else
+        update(rect);
+}
+
+void SpectrumView::setAnalyzer(SpectrumAnalyzer *analyzer)
+{
+    if (m_analyzer)
+        disconnect(m_analyzer, nullptr, this, nullptr);
+    m_analyzer = analyzer;
+    if (m_analyzer)
+        connect(m_analyzer, &SpectrumAnalyzer::frameReady, this, &SpectrumView::invalidateStaticLayer);
+}
+
+void SpectrumView::setTrack(const SpectrumTrack *track)
+{
+    m_track = track;
+    invalidateStaticLayer();
+}
+
+void SpectrumView::setTrackPosition(qint64 sample)
+{
+    if (sample == m_trackPosition)
+        return;
+    m_trackPosition = sample;
+    if (sample < 0)
+        m_trackFedPosition = -1;
+    invalidateStaticLayer();
+}
+
+// Кадр дорожки для текущей позиции: поиск по индексу и интерполяция соседних кадров
+bool SpectrumView::takeTrackFrame()
+{
+    if (!m_track || m_trackPosition < 0 || m_track->sampleRate() == 0)
+        return false;
+
+    // Повторная отрисовка той же позиции (масштаб, размер) не добавляет кадр в среднее
+    if (m_trackPosition == m_trackFedPosition)
+        return true;
+
+    QMutexLocker locker(&m_mutex);
+    m_frameDb.resize(SpectrumTrack::binCount);
+    if (!m_track->lookup(m_trackPosition, m_frameDb.data()))
+        return false;
 
-    for (int i = 0; i < frequencies.size(); ++i) {
-        // Ограничиваем значения амплитуд
-        double mag = qBound(m_minDB, magnitudes[i], m_maxDB);
-        m_spectrumData.append({frequencies[i], mag});
+    pushFrame(m_frameDb.constData(), m_frameDb.size(), double(m_track->sampleRate()) / SpectrumTrack::fftSize);
+    m_trackFedPosition = m_trackPosition;
+    return true;
+}
+
+// Перенос последнего кадра анализатора в точки спектра (без вычислений FFT)
+void SpectrumView::takeAnalyzerFrame()
+{
+    if (!m_analyzer || !m_analyzer->takeFrame())
+        return;
+
+    const SpectrumAnalyzer::Frame &frame = m_analyzer->frame();
+    if (frame.sampleRate == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    pushFrame(frame.magnitudesDb.constData(),
+              frame.magnitudesDb.size(),
+              double(frame.sampleRate) / SpectrumAnalyzer::fftSize);
+}
+
+// Кадр в усреднение (под m_mutex). binWidth > 0 - полосы равномерные, частоты
+// пересчитываются при смене шага; 0 - частоты уже заданы вызывающим.
+void SpectrumView::pushFrame(const float *db, int count, double binWidth)
+{
+    if (binWidth > 0.0
+        && (m_frequencies.size() != count || (count > 1 && m_frequencies[1] != binWidth))) {
+        m_frequencies.resize(count);
+        for (int i = 0; i < count; ++i)
+            m_frequencies[i] = i * binWidth;
+        m_averager.reset();
     }
 
-    update();
+    // Пауза длиннее четверти секунды не должна разом обнулять пики
+    const double dt = m_frameClock.isValid() ? qMin(0.25, m_frameClock.nsecsElapsed() / 1e9) : 0.0;
+    m_frameClock.start();
+    m_averager.add(db, count, dt);
 }
 
 void SpectrumView::clear()
 {
     QMutexLocker locker(&m_mutex);
-    m_spectrumData.clear();
-    update();
+    m_frequencies.clear();
+    m_averager.reset();
+    m_trackFedPosition = -1;
+    invalidateStaticLayer();
+}
+
+void SpectrumView::setAveraging(SpectrumAverager::Mode mode)
+{
+    QMutexLocker locker(&m_mutex);
+    m_averager.setMode(mode);
+    invalidateStaticLayer();
+}
+
+void SpectrumView::setAveragingTimeConstant(double seconds)
+{
+    QMutexLocker locker(&m_mutex);
+    m_averager.setTimeConstant(seconds);
+}
+
+void SpectrumView::setAveragingCount(int frames)
+{
+    QMutexLocker locker(&m_mutex);
+    m_averager.setLinearCount(frames);
+    invalidateStaticLayer();
+}
+
+void SpectrumView::setPeakHold(bool enabled)
+{
+    QMutexLocker locker(&m_mutex);
+    m_averager.setPeakHold(enabled);
+    invalidateStaticLayer();
+}
+
+void SpectrumView::setPeakDecay(double dbPerSecond)
+{
+    QMutexLocker locker(&m_mutex);
+    m_averager.setPeakDecay(dbPerSecond);
+}
+
+// Среднее и пик начинаются заново с текущего кадра
+void SpectrumView::resetAveraging()
+{
+    QMutexLocker locker(&m_mutex);
+    const QVector<float> current = m_averager.current();
+    m_averager.reset();
+    if (!current.isEmpty())
+        m_averager.add(current.constData(), current.size(), 0.0);
+    invalidateStaticLayer();
 }
 
 void SpectrumView::zoomReset()
 {
     m_zoomFactor = 1.0;
     m_panOffset = 0.0;
-    update();
+    invalidateStaticLayer();
 }
 
 void SpectrumView::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event);
+    if (m_staticDirty || m_staticLayer.size() != size() * devicePixelRatioF())
+        renderStaticLayer();
+
     QPainter painter(this);
+    painter.drawPixmap(0, 0, m_staticLayer);
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    drawReadout(painter);
+}
+
+void SpectrumView::invalidateStaticLayer()
+{
+    m_staticDirty = true;
+    scheduleUpdate();
+}
+
+void SpectrumView::renderStaticLayer()
+{
+    const qreal dpr = devicePixelRatioF();
+    m_staticLayer = QPixmap(size() * dpr);
+    m_staticLayer.setDevicePixelRatio(dpr);
+    m_staticDirty = false;
+
+    if (!takeTrackFrame())
+        takeAnalyzerFrame();
+
+    QPainter painter(&m_staticLayer);
     painter.setRenderHint(QPainter::Antialiasing, true);
     painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
@@ -110,7 +289,7 @@ void SpectrumView::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
     updateGradient(); // Обновляем градиент при изменении размера
-    update();
+    invalidateStaticLayer();
 }
 
 void SpectrumView::mousePressEvent(QMouseEvent *event)
@@ -128,6 +307,8 @@ void SpectrumView::mousePressEvent(QMouseEvent *event)
 
 void SpectrumView::mouseMoveEvent(QMouseEvent *event)
 {
+    setCursorPos(event->pos(), true);
+
     if (m_rubberBand->isVisible()) {
         m_zoomEnd = event->pos();
         m_rubberBand->setGeometry(QRect(m_zoomStart, m_zoomEnd).normalized());
@@ -142,7 +323,7 @@ void SpectrumView::mouseMoveEvent(QMouseEvent *event)
         // Улучшенное ограничение панорамирования
         double maxPan = freqRange * (m_zoomFactor - 1.0) / 2.0;
         m_panOffset = qBound(-maxPan, m_panOffset, maxPan);
-        update();
+        invalidateStaticLayer();
     }
 }
 
@@ -161,6 +342,12 @@ void SpectrumView::mouseReleaseEvent(QMouseEvent *event)
     }
 }
 
+void SpectrumView::leaveEvent(QEvent *event)
+{
+    QWidget::leaveEvent(event);
+    setCursorPos(m_cursorPos, false);
+}
+
 void SpectrumView::wheelEvent(QWheelEvent *event)
 {
     double zoomFactor = 1.0 + (event->angleDelta().y() > 0 ? 0.1 : -0.1); // Более плавное масштабирование
@@ -170,7 +357,7 @@ void SpectrumView::wheelEvent(QWheelEvent *event)
     double maxPan = (m_maxFrequency - m_minFrequency) * (m_zoomFactor - 1.0) / 2.0;
     m_panOffset = qBound(-maxPan, m_panOffset, maxPan);
 
-    update();
+    invalidateStaticLayer();
 }
 
 void SpectrumView::drawGrid(QPainter &painter)
@@ -237,13 +424,9 @@ void SpectrumView::drawGrid(QPainter &painter)
     painter.restore();
 }
 
-void SpectrumView::drawSpectrum(QPainter &painter)
+// Ломаная по значениям полос в видимом диапазоне частот (под m_mutex)
+QPainterPath SpectrumView::tracePath(const QVector<float> &values) const
 {
-    if (m_spectrumData.isEmpty())
-        return;
-
-    QMutexLocker locker(&m_mutex);
-
     // Получаем видимый диапазон частот
     double visibleMinFreq = getVisibleMinFreq();
     double visibleMaxFreq = getVisibleMaxFreq();
@@ -257,25 +440,10 @@ void SpectrumView::drawSpectrum(QPainter &painter)
     QPainterPath path;
     bool firstPoint = true;
 
-    // Находим минимальное и максимальное значение для нормализации
-    double minMag = m_maxDB;
-    double maxMag = m_minDB;
-    const int count = m_spectrumData.size();
-    for (int i = 0; i < count; ++i) {
-        const SpectrumPoint& point = m_spectrumData[i];
-        if (point.frequency >= visibleMinFreq && point.frequency <= visibleMaxFreq) {
-            if (point.magnitude < minMag)
-                minMag = point.magnitude;
-            if (point.magnitude > maxMag)
-                maxMag = point.magnitude;
-        }
-    }
-
-    const int dataCount = m_spectrumData.size();
+    const int dataCount = qMin(values.size(), m_frequencies.size());
     for (int i = 0; i < dataCount; ++i) {
-        const SpectrumPoint& point = m_spectrumData[i];
-        double freq = point.frequency;
-        double mag = point.magnitude;
+        double freq = m_frequencies[i];
+        double mag = values[i];
 
         // Пропускаем точки вне видимого диапазона
         if (freq < visibleMinFreq || freq > visibleMaxFreq)
@@ -298,6 +466,16 @@ void SpectrumView::drawSpectrum(QPainter &painter)
             path.lineTo(x, y);
         }
     }
+    return path;
+}
+
+void SpectrumView::drawSpectrum(QPainter &painter)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_frequencies.isEmpty() || m_averager.binCount() == 0)
+        return;
+
+    const QPainterPath path = tracePath(m_averager.current());
 
     QPainterPath filledPath = path;
     filledPath.lineTo(width(), height());
@@ -308,6 +486,16 @@ void SpectrumView::drawSpectrum(QPainter &painter)
 
     painter.setPen(QPen(m_lineColor, 2));
     painter.drawPath(path);
+
+    // Среднее и пик - отдельные линии поверх текущего спектра
+    if (m_averager.hasAverage()) {
+        painter.setPen(QPen(m_averageColor, 1.5));
+        painter.drawPath(tracePath(m_averager.average()));
+    }
+    if (m_averager.hasPeak()) {
+        painter.setPen(QPen(m_peakColor, 1, Qt::DashLine));
+        painter.drawPath(tracePath(m_averager.peak()));
+    }
 }
 
 void SpectrumView::drawLabels(QPainter &painter)
@@ -327,20 +515,64 @@ void SpectrumView::drawLabels(QPainter &painter)
 
     painter.drawText(width() - 200, 20, freqRangeStr);
 
-    if (underMouse()) {
-        QPoint pos = mapFromGlobal(QCursor::pos());
-        QPointF dataPoint = pointToData(pos);
+    // Легенда линий усреднения и пиков
+    int legendY = 40;
+    if (averaging() != SpectrumAverager::Mode::Off) {
+        painter.setPen(m_averageColor);
+        painter.drawText(width() - 200, legendY, averaging() == SpectrumAverager::Mode::Exponential
+                                                     ? QString("Average: exponential")
+                                                     : QString("Average: linear"));
+        legendY += 16;
+    }
+    if (peakHold()) {
+        painter.setPen(m_peakColor);
+        painter.drawText(width() - 200, legendY, "Peak hold");
+    }
 
-        QString info
-            = QString("%1 Hz, %2 dB").arg(dataPoint.x(), 0, 'f', 1).arg(dataPoint.y(), 0, 'f', 1);
+    painter.restore();
+}
 
-        painter.drawText(pos + QPoint(15, -10), info);
-        painter.drawEllipse(pos, 3, 3);
-    }
+// Отсчёт частоты и уровня под курсором
+void SpectrumView::drawReadout(QPainter &painter)
+{
+    if (!m_cursorInside)
+        return;
 
+    painter.save();
+    painter.setPen(Qt::white);
+    painter.drawText(m_cursorPos + QPoint(15, -10), readoutText());
+    painter.drawEllipse(m_cursorPos, 3, 3);
     painter.restore();
 }
 
+QString SpectrumView::readoutText() const
+{
+    QPointF dataPoint = pointToData(m_cursorPos);
+    return QString("%1 Hz, %2 dB").arg(dataPoint.x(), 0, 'f', 1).arg(dataPoint.y(), 0, 'f', 1);
+}
+
+// Область, занятая отсчётом: подпись и точка
+QRect SpectrumView::readoutRect() const
+{
+    if (!m_cursorInside)
+        return {};
+    const QRect text = fontMetrics().boundingRect(readoutText()).translated(m_cursorPos
+                                                                             + QPoint(15, -10));
+    const QRect dot(m_cursorPos - QPoint(5, 5), QSize(11, 11));
+    return text.united(dot).adjusted(-2, -2, 2, 2);
+}
+
+// Перерисовка только старого и нового положения отсчёта
+void SpectrumView::setCursorPos(const QPoint &pos, bool inside)
+{
+    if (pos == m_cursorPos && inside == m_cursorInside)
+        return;
+    scheduleUpdate(readoutRect());
+    m_cursorPos = pos;
+    m_cursorInside = inside;
+    scheduleUpdate(readoutRect());
+}
+
 void SpectrumView::applyZoom(const QRect &zoomRect)
 {
     // Получаем текущий видимый диапазон
@@ -361,7 +593,7 @@ void SpectrumView::applyZoom(const QRect &zoomRect)
     m_zoomFactor = (m_maxFrequency - m_minFrequency) / newWidth;
     m_panOffset = newCenter - (m_minFrequency + m_maxFrequency) / 2;
 
-    update();
+    invalidateStaticLayer();
 }
 
 QPointF SpectrumView::dataToPoint(double freq, double mag) const
@@ -0,0 +1,79 @@
+#include "timeviewport.h"
+#include <QtMath>
+
+TimeViewport::TimeViewport(QObject *parent)
+    : QObject(parent)
+{}
+
+void TimeViewport::setSource(qint64 totalSamples, quint32 sampleRate)
+{
+    m_totalSamples = qMax<qint64>(0, totalSamples);
+    m_sampleRate = sampleRate;
+    m_minSpan = qMin(minimumSpan, double(m_totalSamples));
+    m_start = 0.0;
+    m_span = double(m_totalSamples);
+    m_markerSec = 0.0;
+
+    emit rangeChanged();
+    emit markerChanged(m_markerSec);
+}
+
+double TimeViewport::sampleAt(double x, int width) const
+{
+    if (width <= 0)
+        return m_start;
+    return m_start + x * m_span / width;
+}
+
+double TimeViewport::xForSample(double sample, int width) const
+{
+    if (m_span <= 0.0)
+        return 0.0;
+    return (sample - m_start) * width / m_span;
+}
+
+// Установка видимого диапазона с ограничением по границам файла
+void TimeViewport::setRange(double startSample, double visibleSamples)
+{
+    if (isEmpty())
+        return;
+
+    const double total = double(m_totalSamples);
+    const double span = qBound(m_minSpan, visibleSamples, total);
+    const double start = qBound(0.0, startSample, total - span);
+
+    if (qFuzzyCompare(start + 1.0, m_start + 1.0) && qFuzzyCompare(span, m_span))
+        return;
+
+    m_start = start;
+    m_span = span;
+    emit rangeChanged();
+}
+
+void TimeViewport::scrollTo(double startSample)
+{
+    setRange(startSample, m_span);
+}
+
+void TimeViewport::zoomAt(double anchorSample, double factor)
+{
+    if (isEmpty() || factor <= 0.0)
+        return;
+
+    const double total = double(m_totalSamples);
+    const double newSpan = qBound(m_minSpan, m_span / factor, total);
+    const double ratio = (anchorSample - m_start) / m_span; // Доля ширины слева от курсора
+    setRange(anchorSample - ratio * newSpan, newSpan);
+}
+
+// Установка позиции маркера в секундах
+void TimeViewport::setMarkerSeconds(double seconds)
+{
+    const double duration = m_sampleRate ? double(m_totalSamples) / m_sampleRate : 0.0;
+    const double marker = qBound(0.0, seconds, duration);
+
+    if (!qFuzzyCompare(marker + 1.0, m_markerSec + 1.0)) {
+        m_markerSec = marker;
+        emit markerChanged(m_markerSec);
+    }
+}
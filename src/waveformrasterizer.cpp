@@ -0,0 +1,188 @@
+#include "waveformrasterizer.h"
+#include <algorithm>
+#include <cmath>
+#include <QtMath>
+
+namespace {
+
+QRgb blend(QRgb dst, QRgb src, float alpha)
+{
+    auto mix = [alpha](int d, int s) { return int(d + (s - d) * alpha + 0.5f); };
+    return qRgb(mix(qRed(dst), qRed(src)),
+                mix(qGreen(dst), qGreen(src)),
+                mix(qBlue(dst), qBlue(src)));
+}
+
+// Вертикальный отрезок [y0, y1) столбца x; краевые пиксели - по доле покрытия
+void fillSpan(QImage &image, const QRect &area, int x, float y0, float y1, QRgb color, bool aa)
+{
+    if (y1 <= y0)
+        return;
+
+    const int top = qMax(area.top(), int(std::floor(y0)));
+    const int bottom = qMin(area.bottom(), int(std::ceil(y1)) - 1);
+    for (int y = top; y <= bottom; ++y) {
+        QRgb *px = reinterpret_cast<QRgb *>(image.scanLine(y)) + x;
+        const float coverage = qMin(float(y + 1), y1) - qMax(float(y), y0);
+        if (!aa || coverage >= 0.999f)
+            *px = color;
+        else if (coverage > 0.0f)
+            *px = blend(*px, color, coverage);
+    }
+}
+
+double lanczos(double d, int a)
+{
+    if (std::abs(d) < 1e-9)
+        return 1.0;
+    if (std::abs(d) >= a)
+        return 0.0;
+    const double x = M_PI * d;
+    return a * std::sin(x) * std::sin(x / a) / (x * x);
+}
+
+// Линия, восстановленная по сэмплам, и точки самих сэмплов (меньше сэмпла на пиксель)
+void renderSamples(QImage &image,
+                   const QRect &area,
+                   const QVector<double> &samples,
+                   double startSample,
+                   double samplesPerPixel,
+                   int x0,
+                   int x1,
+                   const WaveformRasterizer::Style &style)
+{
+    const float mid = area.top() + area.height() / 2.0f;
+    const float half = area.height() / 2.0f * style.gain;
+    auto yAt = [&](int x) {
+        const double t = startSample + (x + 0.5) * samplesPerPixel;
+        return mid - float(WaveformRasterizer::interpolate(samples, t)) * half;
+    };
+
+    // Соседние столбцы соединяются вертикальными отрезками
+    float prevY = yAt(x0 - 1);
+    for (int x = x0; x < x1; ++x) {
+        const float y = yAt(x);
+        float yTop = qMin(prevY, y);
+        float yBottom = qMax(prevY, y);
+        if (yBottom - yTop < 1.0f) {
+            const float c = (yTop + yBottom) / 2.0f;
+            yTop = c - 0.5f;
+            yBottom = c + 0.5f;
+        }
+        fillSpan(image, area, area.left() + x, yTop, yBottom, style.line, style.antialiasing);
+        prevY = y;
+    }
+
+    // Точки сэмплов - только когда между ними достаточно места
+    const int r = style.sampleDotRadius;
+    if (r <= 0 || 1.0 / samplesPerPixel < 3.0 * r)
+        return;
+
+    const qint64 first = qMax<qint64>(0, qint64(std::floor(startSample + (x0 - r) * samplesPerPixel)));
+    const qint64 last = qMin<qint64>(samples.size() - 1,
+                                     qint64(std::ceil(startSample + (x1 + r) * samplesPerPixel)));
+    for (qint64 k = first; k <= last; ++k) {
+        const int cx = int(std::floor((k - startSample) / samplesPerPixel));
+        const float cy = mid - float(samples[k]) * half;
+        for (int x = qMax(x0, cx - r); x <= qMin(x1 - 1, cx + r); ++x)
+            fillSpan(image, area, area.left() + x, cy - r, cy + r + 1, style.sample, false);
+    }
+}
+
+} // namespace
+
+double WaveformRasterizer::interpolate(const QVector<double> &samples, double t)
+{
+    const qint64 n = samples.size();
+    const qint64 base = qint64(std::floor(t));
+    double acc = 0.0;
+    for (qint64 k = base - interpolationTaps + 1; k <= base + interpolationTaps; ++k) {
+        if (k < 0 || k >= n)
+            continue;
+        acc += samples[k] * lanczos(t - k, interpolationTaps);
+    }
+    return acc;
+}
+
+void WaveformRasterizer::render(QImage &image,
+                                const QRect &area,
+                                const WaveformSummary &summary,
+                                double startSample,
+                                double samplesPerPixel,
+                                int x0,
+                                int x1,
+                                const Style &style)
+{
+    const qint64 total = summary.sampleCount();
+    const float mid = area.top() + area.height() / 2.0f;
+    const float half = area.height() / 2.0f * style.gain;
+
+    x0 = qMax(0, x0);
+    x1 = qMin(area.width(), x1);
+
+    // Фон области
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y)) + area.left();
+        std::fill(line + x0, line + x1, style.background);
+    }
+
+    if (total <= 0 || samplesPerPixel <= 0.0)
+        return;
+
+    if (samplesPerPixel < 1.0) {
+        renderSamples(image, area, summary.samples(), startSample, samplesPerPixel, x0, x1, style);
+        return;
+    }
+
+    auto bucketAt = [&](int x) {
+        const qint64 begin = qint64(std::floor(startSample + x * samplesPerPixel));
+        qint64 end = qint64(std::floor(startSample + (x + 1) * samplesPerPixel));
+        end = qMax(end, begin + 1);
+        return summary.range(begin, end);
+    };
+
+    // Столбец слева нужен, чтобы соседние отрезки смыкались без разрывов
+    WaveformSummary::Bucket prev = x0 > 0 ? bucketAt(x0 - 1) : WaveformSummary::Bucket();
+
+    for (int x = x0; x < x1; ++x) {
+        const double first = startSample + x * samplesPerPixel;
+        if (first >= total || first + samplesPerPixel <= 0)
+            continue;
+
+        const WaveformSummary::Bucket bucket = bucketAt(x);
+        if (bucket.count == 0)
+            continue;
+
+        float lo = bucket.min;
+        float hi = bucket.max;
+        if (prev.count > 0) {
+            lo = qMin(lo, prev.max);
+            hi = qMax(hi, prev.min);
+        }
+        prev = bucket;
+
+        float yTop = mid - hi * half;
+        float yBottom = mid - lo * half;
+        if (yBottom - yTop < 1.0f) { // Минимальная толщина линии - 1 пиксель
+            const float c = (yTop + yBottom) / 2.0f;
+            yTop = c - 0.5f;
+            yBottom = c + 0.5f;
+        }
+
+        const int px = area.left() + x;
+        fillSpan(image, area, px, yTop, yBottom, style.fill, style.antialiasing);
+
+        const float rms = float(bucket.rms());
+        fillSpan(image,
+                 area,
+                 px,
+                 qMax(yTop, mid - rms * half),
+                 qMin(yBottom, mid + rms * half),
+                 style.rms,
+                 style.antialiasing);
+
+        // Контур: по пикселю у верхней и нижней границы
+        fillSpan(image, area, px, yTop, qMin(yTop + 1.0f, yBottom), style.line, style.antialiasing);
+        fillSpan(image, area, px, qMax(yBottom - 1.0f, yTop), yBottom, style.line, style.antialiasing);
+    }
+}
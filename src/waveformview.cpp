@@ -1,55 +1,249 @@
 // waveformview.cpp
 #include "waveformview.h"
+#include "framescheduler.h"
+#include "timeviewport.h"
+#include <QContextMenuEvent>
+#include <QMenu>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QWheelEvent>
 #include <QtMath>
+#include <cmath>
+#include <cstring>
 
 WaveformView::WaveformView(QWidget *parent)
     : QWidget(parent)
     , m_hScroll(new QScrollBar(Qt::Horizontal, this))
 {
-    // Обновление отображения при прокрутке
-    connect(m_hScroll, &QScrollBar::valueChanged, this, [this]() {
-        updateCachedPath();
-        update();
+    setMouseTracking(true); // Курсор с отсчётом времени
+    setViewport(new TimeViewport(this));
+
+    // Прокрутка сдвигает общую временную ось
+    connect(m_hScroll, &QScrollBar::valueChanged, this, [this](int value) {
+        if (m_viewport->isEmpty() || m_scrollUnit <= 0.0)
+            return;
+        m_viewport->scrollTo(value * m_scrollUnit);
     });
 }
 
+WaveformView::~WaveformView()
+{
+    // Фоновые задачи обращаются к виджету, дожидаемся их до разрушения членов
+    ++m_generation;
+    m_lanePool.clear();
+    m_lanePool.waitForDone();
+}
+
+// Перерисовка на ближайшем кадре экрана, если задан общий такт
+void WaveformView::setFrameScheduler(FrameScheduler *scheduler)
+{
+    m_scheduler = scheduler;
+}
+
+void WaveformView::scheduleUpdate()
+{
+    if (m_scheduler)
+        m_scheduler->schedule(this);
+    else
+        update();
+}
+
+void WaveformView::scheduleUpdate(const QRect &rect)
+{
+    if (rect.isEmpty())
+        return;
+    if (m_scheduler)
+        m_scheduler->schedule(this, rect);
+    else
+        update(rect);
+}
+
+// Подключение общей временной оси
+void WaveformView::setViewport(TimeViewport *viewport)
+{
+    if (!viewport || viewport == m_viewport)
+        return;
+
+    if (m_viewport) {
+        disconnect(m_viewport, nullptr, this, nullptr);
+        if (m_viewport->parent() == this)
+            m_viewport->deleteLater();
+    }
+
+    m_viewport = viewport;
+    connect(m_viewport, &TimeViewport::rangeChanged, this, &WaveformView::onRangeChanged);
+    connect(m_viewport, &TimeViewport::markerChanged, this, &WaveformView::onMarkerChanged);
+    onRangeChanged();
+}
+
 // Установка новых сэмплов для отображения
 void WaveformView::setSamples(const QVector<double> &samples, quint32 sampleRate)
 {
-    m_samples = samples;
+    if (samples.isEmpty())
+        setChannels({}, sampleRate);
+    else
+        setChannels({samples}, sampleRate);
+}
+
+// Установка каналов: пирамиды дорожек строятся параллельно
+void WaveformView::setChannels(const QVector<QVector<double>> &channels, quint32 sampleRate)
+{
+    // Отмена растеризации старых дорожек
+    ++m_generation;
+    m_lanePool.clear();
+
+    QVector<QSharedPointer<WaveformSummary>> summaries;
+    for (const QVector<double> &data : channels) {
+        auto summary = QSharedPointer<WaveformSummary>::create();
+        m_lanePool.start([summary, data]() { summary->build(data); });
+        summaries.append(summary);
+    }
+    m_lanePool.waitForDone();
+
+    m_lanes = QVector<Lane>(channels.size());
+    for (int i = 0; i < channels.size(); ++i)
+        m_lanes[i].summary = summaries[i];
+    m_sampleCount = channels.isEmpty() ? 0 : channels.first().size();
     m_sampleRate = sampleRate;
-    m_markerSec = 0.0;      // Сброс позиции маркера
-    m_zoom = 10.0;          // Сброс масштаба
-    m_hScroll->setValue(0); // Сброс прокрутки
+    m_backFrames.clear();
 
-    updateScroll();
-    updateCachedPath();
-    update(); // Запрос перерисовки
+    m_viewport->setSource(m_sampleCount, sampleRate); // Сброс масштаба, прокрутки и маркера
 }
 
 // Установка позиции маркера в секундах
 void WaveformView::setMarkerPosition(double seconds)
 {
-    double duration = m_sampleRate ? double(m_samples.size()) / m_sampleRate : 0.0;
-    double newMarker = qBound(0.0, seconds, duration);
+    m_viewport->setMarkerSeconds(seconds);
+}
 
-    if (!qFuzzyCompare(newMarker, m_markerSec)) {
-        m_markerSec = newMarker;
-        update(); // Перерисовка только при изменении позиции
+void WaveformView::setAntialiasing(bool enabled)
+{
+    m_style.antialiasing = enabled;
+    invalidateLanes();
+}
+
+void WaveformView::setLaneVisible(int lane, bool visible)
+{
+    if (lane < 0 || lane >= m_lanes.size() || m_lanes[lane].visible == visible)
+        return;
+    m_lanes[lane].visible = visible;
+    invalidateLanes();
+}
+
+bool WaveformView::isLaneVisible(int lane) const
+{
+    return lane >= 0 && lane < m_lanes.size() && m_lanes[lane].visible;
+}
+
+void WaveformView::setLaneSolo(int lane, bool solo)
+{
+    if (lane < 0 || lane >= m_lanes.size() || m_lanes[lane].solo == solo)
+        return;
+    m_lanes[lane].solo = solo;
+    invalidateLanes();
+}
+
+bool WaveformView::isLaneSolo(int lane) const
+{
+    return lane >= 0 && lane < m_lanes.size() && m_lanes[lane].solo;
+}
+
+void WaveformView::setLaneGain(int lane, double gain)
+{
+    if (lane < 0 || lane >= m_lanes.size())
+        return;
+    gain = qBound(minLaneGain, gain, maxLaneGain);
+    if (qFuzzyCompare(m_lanes[lane].gain, gain))
+        return;
+    m_lanes[lane].gain = gain;
+    invalidateLanes();
+}
+
+double WaveformView::laneGain(int lane) const
+{
+    return lane >= 0 && lane < m_lanes.size() ? m_lanes[lane].gain : 1.0;
+}
+
+// Отображаемые дорожки: только соло, если такие есть, иначе все видимые
+QVector<int> WaveformView::shownLanes() const
+{
+    bool anySolo = false;
+    for (const Lane &lane : m_lanes)
+        anySolo = anySolo || lane.solo;
+
+    QVector<int> result;
+    for (int i = 0; i < m_lanes.size(); ++i) {
+        if (anySolo ? m_lanes[i].solo : m_lanes[i].visible)
+            result.append(i);
+    }
+    return result;
+}
+
+// Дорожки делят высоту поровну, между ними - линия в один пиксель
+QRect WaveformView::laneRect(int position, int shownCount) const
+{
+    const int h = height() - m_hScroll->height();
+    if (shownCount <= 0 || h <= 0)
+        return {};
+    const int top = h * position / shownCount;
+    const int bottom = h * (position + 1) / shownCount;
+    const int gap = position + 1 < shownCount ? 1 : 0;
+    return QRect(0, top, width(), qMax(0, bottom - top - gap));
+}
+
+// Номер канала дорожки под координатой Y, -1 - вне дорожек
+int WaveformView::laneAt(int y) const
+{
+    const QVector<int> shown = shownLanes();
+    for (int i = 0; i < shown.size(); ++i) {
+        const QRect r = laneRect(i, shown.size());
+        if (y >= r.top() && y <= r.bottom() + 1)
+            return shown[i];
     }
+    return -1;
+}
+
+// Перерисовка дорожек после смены раскладки или стиля; до готовности
+// нового кадра показывается прежний
+void WaveformView::invalidateLanes()
+{
+    requestRender();
+    invalidateStaticLayer();
 }
 
-// Отрисовка осциллограммы
+// Реакция на изменение видимого диапазона
+void WaveformView::onRangeChanged()
+{
+    updateScroll();
+    requestRender();
+    m_markerRect = markerRect();
+    invalidateStaticLayer();
+}
+
+// Отрисовка осциллограммы: статический слой и поверх него маркер и курсор
 void WaveformView::paintEvent(QPaintEvent *)
 {
+    if (m_staticDirty || m_staticLayer.size() != size() * devicePixelRatioF())
+        renderStaticLayer();
+
     QPainter p(this);
+    p.drawPixmap(0, 0, m_staticLayer); // Отсечение по области обновления делает QPainter
+    drawOverlay(p);
+}
+
+// Всё, что меняется только при смене диапазона, раскладки или готовности кадра
+void WaveformView::renderStaticLayer()
+{
+    const qreal dpr = devicePixelRatioF();
+    m_staticLayer = QPixmap(size() * dpr);
+    m_staticLayer.setDevicePixelRatio(dpr);
+    m_staticDirty = false;
+
+    QPainter p(&m_staticLayer);
     p.fillRect(rect(), Qt::black); // Черный фон
 
     // Отображение заглушки при отсутствии данных
-    if (m_samples.isEmpty() || m_sampleRate == 0) {
+    if (m_sampleCount == 0 || m_sampleRate == 0) {
         p.setPen(Qt::white);
         p.drawText(rect(), Qt::AlignCenter, "No audio loaded");
         return;
@@ -57,31 +251,126 @@ void WaveformView::paintEvent(QPaintEvent *)
 
     const int w = width();
     const int h = height() - m_hScroll->height(); // Высота области отрисовки
-    const int offset = m_hScroll->value();
 
-    // Обновление кэшированного пути при изменении параметров
-    if (offset != m_cachedOffset || QSize(w, h) != m_cachedSize) {
-        updateCachedPath();
-        m_cachedOffset = offset;
-        m_cachedSize = QSize(w, h);
+    // Отрисовка дорожек: готовые растры просто копируются. Пока новый кадр
+    // не готов, прежний растягивается на своё место на текущей оси.
+    const QVector<int> shown = shownLanes();
+    const double start = m_viewport->startSample();
+    const double span = m_viewport->visibleSamples();
+    for (int i = 0; i < shown.size(); ++i) {
+        const QRect r = laneRect(i, shown.size());
+        const Lane &lane = m_lanes[shown[i]];
+        const LaneFrame &frame = lane.frame;
+        if (!frame.image.isNull() && frame.span > 0.0 && span > 0.0) {
+            const QSizeF logicalSize = frame.image.deviceIndependentSize();
+            if (qFuzzyCompare(frame.span, span) && qFuzzyCompare(frame.start + 1.0, start + 1.0)
+                && logicalSize == QSizeF(r.size())) {
+                p.drawImage(r.topLeft(), frame.image);
+            } else if (frame.span < span * maxPlaceholderStretch) {
+                // При сильном приближении растянутый кадр бесполезен - только фон
+                const double x = (frame.start - start) / span * w;
+                const double fw = frame.span / span * w;
+                p.drawImage(QRectF(x, r.top(), fw, r.height()), frame.image);
+            }
+        }
+
+        if (m_lanes.size() > 1) {
+            p.setPen(Qt::gray);
+            p.drawText(r.adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop,
+                       QString("Ch %1%2").arg(shown[i] + 1).arg(lane.solo ? " (solo)" : ""));
+            if (r.bottom() + 1 < h)
+                p.drawLine(0, r.bottom() + 1, w, r.bottom() + 1); // Разделитель дорожек
+        }
     }
+}
+
+void WaveformView::invalidateStaticLayer()
+{
+    m_staticDirty = true;
+    scheduleUpdate();
+}
 
-    // Отрисовка осциллограммы
-    p.setPen(QPen(Qt::green, 1));
-    p.setBrush(QColor(0, 255, 0, 100)); // Полупрозрачная заливка
-    p.drawPath(m_cachedPath);
+// Маркер позиции и курсор мыши с отсчётом времени
+void WaveformView::drawOverlay(QPainter &p)
+{
+    if (m_sampleCount == 0 || m_sampleRate == 0)
+        return;
 
-    // Отрисовка маркера позиции
-    double spp = double(m_samples.size()) / (m_zoom * w);
-    double markerPx = (m_markerSec * m_sampleRate) / spp - offset;
-    int mx = int(markerPx);
+    const int h = height() - m_hScroll->height();
 
-    if (mx >= 0 && mx <= w) {
+    const int mx = markerX();
+    if (mx >= 0) {
         p.setPen(QPen(Qt::red, 2));
         p.drawLine(mx, 0, mx, h); // Вертикальная линия маркера
         p.setPen(Qt::white);
-        p.drawText(mx + 4, h - 4, QString::number(m_markerSec, 'f', 2) + " s");
+        p.drawText(mx + 4, h - 4, markerText());
     }
+
+    if (m_cursorX >= 0) {
+        p.setPen(QColor(255, 255, 255, 120));
+        p.drawLine(m_cursorX, 0, m_cursorX, h);
+        p.setPen(Qt::white);
+        p.drawText(m_cursorX + 4, fontMetrics().ascent() + 2, cursorText());
+    }
+}
+
+// Координата маркера на экране, -1 - за пределами видимой области
+int WaveformView::markerX() const
+{
+    const double x = m_viewport->xForSample(m_viewport->markerSeconds() * m_sampleRate, width());
+    // Вне экрана координата может не помещаться в int
+    return x >= 0.0 && x <= width() ? int(x) : -1;
+}
+
+QString WaveformView::markerText() const
+{
+    return QString::number(m_viewport->markerSeconds(), 'f', 2) + " s";
+}
+
+QString WaveformView::cursorText() const
+{
+    const double seconds = m_viewport->sampleAt(m_cursorX, width()) / m_sampleRate;
+    return QString::number(seconds, 'f', 3) + " s";
+}
+
+// Область, занятая маркером и его подписью
+QRect WaveformView::markerRect() const
+{
+    const int mx = m_sampleRate ? markerX() : -1;
+    if (mx < 0)
+        return {};
+    const int h = height() - m_hScroll->height();
+    const QRect text = fontMetrics().boundingRect(markerText()).translated(mx + 4, h - 4);
+    return QRect(mx - 2, 0, 5, h).united(text).adjusted(-1, -1, 1, 1);
+}
+
+QRect WaveformView::cursorRect() const
+{
+    if (m_cursorX < 0 || m_sampleRate == 0)
+        return {};
+    const int h = height() - m_hScroll->height();
+    const QRect text = fontMetrics()
+                           .boundingRect(cursorText())
+                           .translated(m_cursorX + 4, fontMetrics().ascent() + 2);
+    return QRect(m_cursorX - 1, 0, 3, h).united(text).adjusted(-1, -1, 1, 1);
+}
+
+// Перерисовка только старого и нового положения маркера
+void WaveformView::onMarkerChanged()
+{
+    const QRect current = markerRect();
+    scheduleUpdate(m_markerRect);
+    scheduleUpdate(current);
+    m_markerRect = current;
+}
+
+void WaveformView::setCursorX(int x)
+{
+    if (x == m_cursorX)
+        return;
+    scheduleUpdate(cursorRect());
+    m_cursorX = x;
+    scheduleUpdate(cursorRect());
 }
 
 // Обработка изменения размера виджета
@@ -90,7 +379,9 @@ void WaveformView::resizeEvent(QResizeEvent *)
     // Обновление геометрии скроллбара
     m_hScroll->setGeometry(0, height() - m_hScroll->height(), width(), m_hScroll->height());
     updateScroll();
-    updateCachedPath();
+    requestRender();
+    m_markerRect = markerRect();
+    m_staticDirty = true;
 }
 
 // Обработчики событий мыши
@@ -98,82 +389,119 @@ void WaveformView::mousePressEvent(QMouseEvent *ev)
 {
     if (ev->button() == Qt::LeftButton) {
         m_draggingMarker = true;
+        emit markerDragStarted();
         updateMarkerFromPos(int(ev->position().x()));
     }
 }
 
 void WaveformView::mouseMoveEvent(QMouseEvent *ev)
 {
+    const int x = int(ev->position().x());
+    setCursorX(ev->position().y() < height() - m_hScroll->height() ? x : -1);
     if (m_draggingMarker)
-        updateMarkerFromPos(int(ev->position().x()));
+        updateMarkerFromPos(x);
+}
+
+void WaveformView::leaveEvent(QEvent *)
+{
+    setCursorX(-1);
 }
 
 void WaveformView::mouseReleaseEvent(QMouseEvent *)
 {
+    if (!m_draggingMarker)
+        return;
     m_draggingMarker = false;
+    emit markerDragFinished();
 }
 
 // Обработка масштабирования колесом мыши
 void WaveformView::wheelEvent(QWheelEvent *ev)
 {
     if (ev->modifiers() & Qt::ControlModifier) {
-        double cursorX = ev->position().x();
         int w = width();
-        if (w <= 0 || m_samples.isEmpty()) {
+        if (w <= 0 || m_sampleCount == 0) {
             ev->ignore();
             return;
         }
 
-        // Сохранение позиции курсора относительно данных
-        double sampleCount = double(m_samples.size());
-        double sppOld = sampleCount / (m_zoom * w);
-        int oldOffset = m_hScroll->value();
-        double sampleIndex = (oldOffset + cursorX) * sppOld;
-
-        // Изменение масштаба
+        // Масштабирование с сохранением позиции под курсором
+        double anchor = m_viewport->sampleAt(ev->position().x(), w);
         double delta = ev->angleDelta().y() > 0 ? 1.25 : 0.8;
-        m_zoom = qBound(m_minZoom, m_zoom * delta, m_maxZoom);
-
-        // Корректировка прокрутки для сохранения позиции курсора
-        double sppNew = sampleCount / (m_zoom * w);
-        double newOffset = sampleIndex / sppNew - cursorX;
-
-        updateScroll();
-        int clampedOffset = qBound(m_hScroll->minimum(), int(newOffset), m_hScroll->maximum());
-        m_hScroll->setValue(clampedOffset);
-
-        updateCachedPath();
-        update();
+        m_viewport->zoomAt(anchor, delta);
+        ev->accept();
+    } else if (ev->modifiers() & Qt::ShiftModifier) {
+        // Вертикальный масштаб дорожки под курсором
+        const int lane = laneAt(int(ev->position().y()));
+        if (lane < 0) {
+            ev->ignore();
+            return;
+        }
+        const int delta = ev->angleDelta().y() != 0 ? ev->angleDelta().y() : ev->angleDelta().x();
+        setLaneGain(lane, laneGain(lane) * (delta > 0 ? 1.25 : 0.8));
         ev->accept();
     } else {
         QWidget::wheelEvent(ev);
     }
 }
 
-// Обновление параметров скроллбара
-void WaveformView::updateScroll()
+// Контекстное меню дорожки: скрытие, соло и сброс вертикального масштаба
+void WaveformView::contextMenuEvent(QContextMenuEvent *ev)
 {
-    if (m_samples.isEmpty() || m_sampleRate == 0) {
-        m_hScroll->setRange(0, 0);
+    const int lane = laneAt(ev->pos().y());
+    if (lane < 0)
         return;
+
+    QMenu menu(this);
+    QAction *solo = menu.addAction(tr("Solo"));
+    solo->setCheckable(true);
+    solo->setChecked(m_lanes[lane].solo);
+    QAction *hide = menu.addAction(tr("Hide"));
+    hide->setEnabled(m_lanes.size() > 1);
+    QAction *showAll = menu.addAction(tr("Show all channels"));
+    menu.addSeparator();
+    QAction *resetGain = menu.addAction(tr("Reset vertical zoom"));
+
+    QAction *chosen = menu.exec(ev->globalPos());
+    if (chosen == solo) {
+        setLaneSolo(lane, solo->isChecked());
+    } else if (chosen == hide) {
+        m_lanes[lane].solo = false;
+        setLaneVisible(lane, false);
+    } else if (chosen == showAll) {
+        for (Lane &l : m_lanes) {
+            l.visible = true;
+            l.solo = false;
+        }
+        invalidateLanes();
+    } else if (chosen == resetGain) {
+        setLaneGain(lane, 1.0);
     }
+}
 
+// Обновление параметров скроллбара
+void WaveformView::updateScroll()
+{
     int w = width();
-    if (w <= 0)
+    if (m_viewport->isEmpty() || w <= 0) {
+        m_hScroll->setRange(0, 0);
         return;
+    }
 
-    // Расчет параметров прокрутки
-    double samplesPerPixel = double(m_samples.size()) / (m_zoom * w);
-    int totalVisiblePx = int(double(m_samples.size()) / samplesPerPixel);
-    int maxOffset = qMax(0, totalVisiblePx - w);
+    // Шаг прокрутки - один пиксель при текущем масштабе. При глубоком
+    // приближении длинного файла число пикселей не помещается в int,
+    // тогда шаг укрупняется до scrollSteps делений на весь диапазон.
+    const double samplesPerPixel = m_viewport->visibleSamples() / w;
+    const double range = double(m_viewport->totalSamples()) - m_viewport->visibleSamples();
+    m_scrollUnit = qMax(samplesPerPixel, range / scrollSteps);
 
-    // Обновление диапазона скроллбара
-    int value = m_hScroll->value();
-    value = qBound(0, value, maxOffset);
+    const int maxOffset = qMax(0, int(std::ceil(range / m_scrollUnit)));
+    const int value = qBound(0, qRound(m_viewport->startSample() / m_scrollUnit), maxOffset);
+    const int pageStep = int(qBound(1.0, m_viewport->visibleSamples() / m_scrollUnit, double(w)));
 
     m_hScroll->blockSignals(true);
     m_hScroll->setRange(0, maxOffset);
-    m_hScroll->setPageStep(w); // Размер "страницы" = видимая область
+    m_hScroll->setPageStep(pageStep); // Размер "страницы" = видимая область
     m_hScroll->setValue(value);
     m_hScroll->blockSignals(false);
 }
@@ -185,59 +513,134 @@ void WaveformView::updateMarkerFromPos(int x)
     if (w <= 0 || m_sampleRate == 0)
         return;
 
-    int offset = m_hScroll->value();
-    double spp = double(m_samples.size()) / (m_zoom * w);
-    double posSec = ((offset + x) * spp) / m_sampleRate;
+    double posSec = m_viewport->sampleAt(x, w) / m_sampleRate;
 
     setMarkerPosition(posSec);
-    emit markerPositionChanged(m_markerSec); // Уведомление о изменении
+    emit markerPositionChanged(m_viewport->markerSeconds()); // Уведомление о изменении
 }
 
-// Генерация пути для отрисовки осциллограммы
-void WaveformView::updateCachedPath()
+// Запуск фоновой растеризации видимых дорожек для текущего диапазона.
+// Работа пропорциональна ширине и числу видимых дорожек.
+void WaveformView::requestRender()
 {
-    m_cachedPath = QPainterPath();
-
-    const int viewWidth = width();
-    const int h = height() - m_hScroll->height();
-    const int offset = m_hScroll->value();
-
-    if (viewWidth <= 0 || h <= 0 || m_samples.isEmpty())
-        return;
+    const quint64 generation = ++m_generation;
+    m_lanePool.clear(); // Ещё не начатые задачи устарели
+    m_backFrames.clear();
+    m_backRemaining = 0;
+
+    const qreal dpr = devicePixelRatioF();
+    const int w = qRound(width() * dpr);
+    const QVector<int> shown = shownLanes();
+
+    // Скрытые дорожки не держат растр, при показе он строится заново
+    for (int i = 0; i < m_lanes.size(); ++i) {
+        if (!shown.contains(i))
+            m_lanes[i].frame = LaneFrame();
+    }
 
-    // Расчет параметров визуализации
-    double spp = double(m_samples.size()) / (m_zoom * viewWidth);
-    int totalPx = int(double(m_samples.size()) / spp);
-    int endX = qMin(viewWidth, totalPx - offset);
-    if (endX <= 0)
+    if (w <= 0 || m_sampleCount == 0 || shown.isEmpty())
         return;
 
-    // Поиск мин/макс значений для каждого пикселя по X
-    QVector<double> maxVals(endX, -1.0);
-    QVector<double> minVals(endX, 1.0);
+    const double start = m_viewport->startSample();
+    const double span = m_viewport->visibleSamples();
 
-    for (int x = 0; x < endX; ++x) {
-        int startIdx = int((x + offset) * spp);
-        int endIdx = int((x + offset + 1) * spp);
-        startIdx = qBound(0, startIdx, m_samples.size() - 1);
-        endIdx = qBound(startIdx + 1, endIdx, m_samples.size());
+    QVector<int> pending;
+    for (int i = 0; i < shown.size(); ++i) {
+        const QSize size(w, qRound(laneRect(i, shown.size()).height() * dpr));
+        if (size.height() > 0)
+            pending.append(i);
+    }
+    m_backRemaining = pending.size();
+
+    for (int i : pending) {
+        const int index = shown[i];
+        const QSize size(w, qRound(laneRect(i, shown.size()).height() * dpr));
+        const Lane &lane = m_lanes[index];
+
+        WaveformRasterizer::Style style = m_style;
+        style.gain = float(lane.gain);
+
+        const QSharedPointer<const WaveformSummary> summary = lane.summary;
+        const LaneFrame prev = lane.frame;
+        m_lanePool.start([this, generation, index, summary, size, dpr, start, span, style, prev]() {
+            LaneFrame frame;
+            if (!renderLane(generation, *summary, size, dpr, start, span, style, prev, frame))
+                return;
+            QMetaObject::invokeMethod(
+                this,
+                [this, generation, index, frame]() { onLaneRendered(generation, index, frame); },
+                Qt::QueuedConnection);
+        });
+    }
+}
 
-        // Поиск экстремумов в текущем сегменте
-        for (int i = startIdx; i < endIdx; ++i) {
-            double v = m_samples[i];
-            maxVals[x] = qMax(maxVals[x], v);
-            minVals[x] = qMin(minVals[x], v);
+bool WaveformView::renderLane(quint64 generation,
+                              const WaveformSummary &summary,
+                              const QSize &size,
+                              qreal dpr,
+                              double start,
+                              double span,
+                              const WaveformRasterizer::Style &style,
+                              const LaneFrame &prev,
+                              LaneFrame &out) const
+{
+    const QRect area(QPoint(0, 0), size);
+    const double spp = span / size.width();
+
+    out.start = start;
+    out.span = span;
+    out.gain = style.gain;
+    out.antialiasing = style.antialiasing;
+
+    // При прокрутке без смены масштаба старый растр сдвигается,
+    // а заново рисуются только открывшиеся столбцы
+    if (prev.image.size() == size && qFuzzyCompare(prev.span, span) && prev.gain == style.gain
+        && prev.antialiasing == style.antialiasing) {
+        const double shift = (start - prev.start) / spp;
+        const int columns = qRound(shift);
+        if (qAbs(shift - columns) < 1e-3 && qAbs(columns) < size.width()) {
+            out.image = prev.image;
+            if (columns == 0)
+                return true;
+
+            const int keep = size.width() - qAbs(columns);
+            for (int y = 0; y < size.height(); ++y) {
+                QRgb *line = reinterpret_cast<QRgb *>(out.image.scanLine(y)); // Копия при записи
+                if (columns > 0)
+                    std::memmove(line, line + columns, keep * sizeof(QRgb));
+                else
+                    std::memmove(line - columns, line, keep * sizeof(QRgb));
+            }
+            const int x0 = columns > 0 ? keep : 0;
+            const int x1 = columns > 0 ? size.width() : -columns;
+            WaveformRasterizer::render(out.image, area, summary, start, spp, x0, x1, style);
+            return true;
         }
     }
 
-    // Построение пути: верхняя граница
-    m_cachedPath.moveTo(0, h / 2.0 - maxVals[0] * (h / 2.0));
-    for (int x = 1; x < endX; ++x)
-        m_cachedPath.lineTo(x, h / 2.0 - maxVals[x] * (h / 2.0));
+    out.image = QImage(size, QImage::Format_RGB32);
+    out.image.setDevicePixelRatio(dpr);
+    for (int x = 0; x < size.width(); x += renderChunk) {
+        if (m_generation.load() != generation)
+            return false;
+        const int x1 = qMin(size.width(), x + renderChunk);
+        WaveformRasterizer::render(out.image, area, summary, start, spp, x, x1, style);
+    }
+    return m_generation.load() == generation;
+}
 
-    // Нижняя граница (в обратном направлении)
-    for (int x = endX - 1; x >= 0; --x)
-        m_cachedPath.lineTo(x, h / 2.0 - minVals[x] * (h / 2.0));
+// Готовый кадр дорожки; когда готовы все, задний буфер становится передним
+void WaveformView::onLaneRendered(quint64 generation, int lane, const LaneFrame &frame)
+{
+    if (generation != m_generation.load() || lane >= m_lanes.size())
+        return;
+
+    m_backFrames.insert(lane, frame);
+    if (--m_backRemaining > 0)
+        return;
 
-    m_cachedPath.closeSubpath(); // Замыкание контура
+    for (auto it = m_backFrames.cbegin(); it != m_backFrames.cend(); ++it)
+        m_lanes[it.key()].frame = it.value();
+    m_backFrames.clear();
+    invalidateStaticLayer();
 }
@@ -0,0 +1,119 @@
+#include "loudnessmeter.h"
+#include <QTest>
+#include <QVector>
+#include <cmath>
+#include <initializer_list>
+
+// Эталонные сигналы EBU Tech 3341 (громкость) и 3342 (диапазон LRA) и
+// сравнение разбиения файла на участки по потокам с одним проходом
+class TestLoudnessMeter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void toneAtMinus23Dbfs();
+    void toneAtMinus33Dbfs();
+    void loudnessRangeOfTwoLevels();
+    void threadedMeasureMatchesSinglePass();
+};
+
+namespace {
+
+struct Part
+{
+    double seconds;
+    double dbfs; // Амплитуда синуса
+};
+
+// Синус в каждом канале, участки разного уровня подряд
+QVector<QVector<double>> tone(quint32 sampleRate,
+                              int channels,
+                              std::initializer_list<Part> parts,
+                              double frequency = 1000.0)
+{
+    qint64 frames = 0;
+    for (const Part &part : parts)
+        frames += qint64(part.seconds * sampleRate);
+
+    QVector<QVector<double>> out(channels, QVector<double>(frames));
+    qint64 i = 0;
+    for (const Part &part : parts) {
+        const double amplitude = std::pow(10.0, part.dbfs / 20.0);
+        const qint64 end = i + qint64(part.seconds * sampleRate);
+        for (; i < end; ++i) {
+            const double s = amplitude * std::sin(2.0 * M_PI * frequency * i / sampleRate);
+            for (QVector<double> &channel : out)
+                channel[i] = s;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+// Tech 3341, тест 1: стерео 1 кГц -23 dBFS - -23.0 ± 0.1 LUFS
+void TestLoudnessMeter::toneAtMinus23Dbfs()
+{
+    const LoudnessMeter::Result r = LoudnessMeter::measure(tone(48000, 2, {{20.0, -23.0}}), 48000, 1);
+    QVERIFY(std::abs(r.integratedLufs - -23.0) <= 0.1);
+    QVERIFY(std::abs(r.momentaryLufs - -23.0) <= 0.1);
+    QVERIFY(std::abs(r.shortTermLufs - -23.0) <= 0.1);
+    QVERIFY(std::abs(r.maxMomentaryLufs - -23.0) <= 0.1);
+    QVERIFY(r.loudnessRangeLu <= 0.1);
+}
+
+// Tech 3341, тест 2: тот же тон -33 dBFS - -33.0 ± 0.1 LUFS
+void TestLoudnessMeter::toneAtMinus33Dbfs()
+{
+    const LoudnessMeter::Result r = LoudnessMeter::measure(tone(48000, 2, {{20.0, -33.0}}), 48000, 1);
+    QVERIFY(std::abs(r.integratedLufs - -33.0) <= 0.1);
+}
+
+// Tech 3342, тест 1: 20 с -20 dBFS, затем 20 с -30 dBFS - LRA 10 ± 1 LU
+void TestLoudnessMeter::loudnessRangeOfTwoLevels()
+{
+    const LoudnessMeter::Result r =
+        LoudnessMeter::measure(tone(48000, 2, {{20.0, -20.0}, {20.0, -30.0}}), 48000, 1);
+    QVERIFY(std::abs(r.loudnessRangeLu - 10.0) <= 1.0);
+}
+
+// Участок не короче минуты: 250 с дают четыре участка на четыре потока.
+// Уровень меняется каждые 7 с, чтобы границы участков резали разные блоки.
+void TestLoudnessMeter::threadedMeasureMatchesSinglePass()
+{
+    constexpr quint32 sampleRate = 8000;
+    const qint64 frames = qint64(250) * sampleRate;
+    QVector<QVector<double>> channels(2, QVector<double>(frames));
+    quint32 seed = 1;
+    for (qint64 i = 0; i < frames; ++i) {
+        const double dbfs = -35.0 + 5.0 * ((i / (7 * sampleRate)) % 5);
+        const double amplitude = std::pow(10.0, dbfs / 20.0);
+        seed = seed * 1664525u + 1013904223u;
+        const double noise = (seed >> 8) / double(1 << 24) - 0.5;
+        channels[0][i] = amplitude * (std::sin(2.0 * M_PI * 440.0 * i / sampleRate) + 0.1 * noise);
+        channels[1][i] = amplitude * std::sin(2.0 * M_PI * 700.0 * i / sampleRate + 1.0);
+    }
+
+    const LoudnessMeter::Result single = LoudnessMeter::measure(channels, sampleRate, 1);
+    const LoudnessMeter::Result threaded = LoudnessMeter::measure(channels, sampleRate, 4);
+
+    // Потоковый проход через process() - то же, что measure()
+    LoudnessMeter meter(sampleRate, 2);
+    const double *data[] = {channels[0].constData(), channels[1].constData()};
+    meter.process(data, frames);
+    const LoudnessMeter::Result streamed = meter.result();
+
+    // Разгон фильтров участка на предыдущих шагах даёт расхождения много
+    // меньше шага гистограммы (0.1 LU)
+    for (const LoudnessMeter::Result &r : {threaded, streamed}) {
+        QVERIFY(std::abs(r.integratedLufs - single.integratedLufs) < 1e-3);
+        QVERIFY(std::abs(r.loudnessRangeLu - single.loudnessRangeLu) < 1e-3);
+        QVERIFY(std::abs(r.maxMomentaryLufs - single.maxMomentaryLufs) < 1e-3);
+        QVERIFY(std::abs(r.maxShortTermLufs - single.maxShortTermLufs) < 1e-3);
+    }
+    QVERIFY(single.integratedLufs > -40.0 && single.integratedLufs < -15.0);
+    QVERIFY(single.loudnessRangeLu > 5.0);
+}
+
+QTEST_APPLESS_MAIN(TestLoudnessMeter)
+#include "tst_loudnessmeter.moc"
@@ -0,0 +1,400 @@
+#include "playbackengine.h"
+#include <QElapsedTimer>
+#include <QSignalSpy>
+#include <QTest>
+#include <QVector>
+#include <cmath>
+
+// Движок с Output::Null: NullAudioSink забирает сэмплы по таймеру в потоке
+// теста и в реальном темпе, поэтому всё, что отдано «устройству», видно
+// через отвод. Источник - линейный рост 0..1: значение сэмпла в отводе
+// показывает, с какой позиции он прочитан.
+class TestPlaybackEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void playAdvancesInRealTime();
+    void pauseFreezesPosition();
+    void seekWhilePausedResumesFromTarget();
+    void stopRewinds();
+    void endOfStreamStopsAtLastSample();
+    void tapDeliversPlayedSamples();
+
+    void scrubGrainsFollowCursor();
+    void scrubRateFollowsDragDirection();
+    void scrubSilentAfterHold();
+    void endScrubKeepsStopped();
+    void endScrubKeepsPaused();
+    void endScrubResumesPlaying();
+    void seekWhilePlayingFlushesSink();
+};
+
+namespace {
+
+constexpr quint32 sampleRate = 48000;
+
+QVector<QVector<double>> ramp(qint64 frames)
+{
+    QVector<double> samples(frames);
+    for (qint64 i = 0; i < frames; ++i)
+        samples[i] = double(i) / frames;
+    return {samples};
+}
+
+double valueAt(qint64 sample, qint64 frames)
+{
+    return double(sample) / frames;
+}
+
+// Всё накопленное в отводе; заодно снимает сброс после перемотки
+QVector<float> drainTap(PlaybackEngine &engine)
+{
+    QVector<float> out;
+    float block[4096];
+    qsizetype n;
+    while ((n = engine.readTap(block, 4096)) > 0) {
+        for (qsizetype i = 0; i < n; ++i)
+            out.append(block[i]);
+    }
+    return out;
+}
+
+void setupEngine(PlaybackEngine &engine, qint64 frames)
+{
+    engine.setOutput(PlaybackEngine::Output::Null);
+    engine.setSource(ramp(frames), sampleRate);
+    drainTap(engine); // Снимает сброс после setSource(), иначе отданное пропадёт
+}
+
+// Курсор держат на месте: scrubTo() каждые 5 мс, как при движении мыши
+void holdCursor(PlaybackEngine &engine, qint64 sample, int ms)
+{
+    for (int elapsed = 0; elapsed < ms; elapsed += 5) {
+        engine.scrubTo(sample);
+        QTest::qWait(5);
+    }
+}
+
+double mean(const QVector<float> &values, qsizetype from, qsizetype to)
+{
+    double sum = 0.0;
+    for (qsizetype i = from; i < to; ++i)
+        sum += values[i];
+    return sum / qMax<qsizetype>(1, to - from);
+}
+
+} // namespace
+
+void TestPlaybackEngine::playAdvancesInRealTime()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+    QSignalSpy states(&engine, &PlaybackEngine::stateChanged);
+
+    engine.play();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Playing);
+    QCOMPARE(states.count(), 1);
+
+    QElapsedTimer clock;
+    clock.start();
+    QTest::qWait(200);
+    const qint64 expected = clock.elapsed() * sampleRate / 1000;
+    // Null-устройство отдаёт данные по таймеру 5 мс: допуск на его шаг и нагрузку
+    QVERIFY(engine.position() > expected / 2);
+    QVERIFY(engine.position() <= expected + sampleRate / 20);
+}
+
+void TestPlaybackEngine::pauseFreezesPosition()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(100);
+    engine.pause();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Paused);
+    const qint64 paused = engine.position();
+    QVERIFY(paused > 0);
+
+    QTest::qWait(100);
+    QCOMPARE(engine.position(), paused);
+
+    engine.play();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Playing);
+    QTest::qWait(100);
+    QVERIFY(engine.position() > paused);
+}
+
+void TestPlaybackEngine::seekWhilePausedResumesFromTarget()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(50);
+    engine.pause();
+
+    const qint64 target = frames / 2;
+    engine.seek(target);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Paused);
+    QCOMPARE(engine.position(), target);
+
+    drainTap(engine);
+    engine.play();
+    QTest::qWait(100);
+    const QVector<float> out = drainTap(engine);
+    QVERIFY(!out.isEmpty());
+    QVERIFY(std::abs(out.first() - valueAt(target, frames)) < 1e-4);
+    QVERIFY(engine.position() > target);
+}
+
+void TestPlaybackEngine::stopRewinds()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(50);
+    engine.stop();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Stopped);
+    QCOMPARE(engine.position(), qint64(0));
+
+    // Остановленное устройство больше не забирает данные
+    QTest::qWait(50);
+    QCOMPARE(engine.position(), qint64(0));
+}
+
+void TestPlaybackEngine::endOfStreamStopsAtLastSample()
+{
+    PlaybackEngine engine;
+    const qint64 frames = sampleRate / 5;
+    setupEngine(engine, frames);
+    QSignalSpy finished(&engine, &PlaybackEngine::finished);
+    QSignalSpy positions(&engine, &PlaybackEngine::positionChanged);
+
+    engine.play();
+    QTRY_COMPARE_WITH_TIMEOUT(finished.count(), 1, 2000);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Stopped);
+    QCOMPARE(engine.position(), frames);
+    QVERIFY(!positions.isEmpty());
+    QCOMPARE(positions.last().first().toLongLong(), frames);
+
+    // Отдано ровно всё содержимое источника
+    const QVector<float> out = drainTap(engine);
+    QCOMPARE(out.size(), qsizetype(frames));
+}
+
+void TestPlaybackEngine::tapDeliversPlayedSamples()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(150);
+    engine.pause();
+
+    // В отводе все отданные сэмплы подряд, с начала и без пропусков
+    const QVector<float> out = drainTap(engine);
+    QCOMPARE(out.size(), qsizetype(engine.position()));
+    QVERIFY(out.size() > qsizetype(sampleRate / 20));
+    QCOMPARE(out.first(), 0.0f);
+    for (qsizetype i = 1; i < out.size(); ++i)
+        QVERIFY(std::abs(out[i] - out[i - 1] - 1.0 / frames) < 1e-6);
+    QCOMPARE(engine.tapAvailable(), qsizetype(0));
+}
+
+void TestPlaybackEngine::scrubGrainsFollowCursor()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.beginScrub();
+    QVERIFY(engine.isScrubbing());
+    for (const qint64 target : {frames / 4, frames * 3 / 4, frames / 2}) {
+        // Переходные зёрна со старой позиции отбрасываются
+        holdCursor(engine, target, 60);
+        drainTap(engine);
+        holdCursor(engine, target, 40);
+
+        const QVector<float> out = drainTap(engine);
+        QVERIFY(out.size() > qsizetype(sampleRate / 100));
+        // Зерно при скорости до 4x захватывает ±32 мс вокруг курсора
+        const double expected = valueAt(target, frames);
+        for (const float value : out)
+            QVERIFY2(std::abs(value - expected) < 0.02,
+                     qPrintable(QStringLiteral("%1 vs %2").arg(value).arg(expected)));
+    }
+    engine.endScrub();
+    QVERIFY(!engine.isScrubbing());
+}
+
+void TestPlaybackEngine::scrubRateFollowsDragDirection()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    // Шаг 240 сэмплов за 5 мс - тянут в темпе воспроизведения
+    const qint64 step = sampleRate / 200;
+    qint64 cursor = frames / 2;
+    engine.beginScrub();
+    holdCursor(engine, cursor, 20);
+
+    for (int i = 0; i < 30; ++i) {
+        cursor += step;
+        engine.scrubTo(cursor);
+        QTest::qWait(5);
+    }
+    QVERIFY(engine.scrubRate() > 0.0);
+
+    drainTap(engine);
+    for (int i = 0; i < 30; ++i) {
+        cursor -= step;
+        engine.scrubTo(cursor);
+        QTest::qWait(5);
+    }
+    QVERIFY(engine.scrubRate() < 0.0);
+
+    // Зёрна идут за курсором назад: звучащее значение убывает
+    const QVector<float> back = drainTap(engine);
+    QVERIFY(back.size() > 100);
+    const qsizetype quarter = back.size() / 4;
+    QVERIFY(mean(back, back.size() - quarter, back.size()) < mean(back, 0, quarter));
+
+    for (int i = 0; i < 30; ++i) {
+        cursor += step;
+        engine.scrubTo(cursor);
+        QTest::qWait(5);
+    }
+    QVERIFY(engine.scrubRate() > 0.0);
+
+    engine.endScrub();
+    QCOMPARE(engine.scrubRate(), 0.0);
+}
+
+void TestPlaybackEngine::scrubSilentAfterHold()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.beginScrub();
+    holdCursor(engine, frames / 2, 60);
+    const QVector<float> sounding = drainTap(engine);
+    QVERIFY(!sounding.isEmpty());
+    QVERIFY(std::abs(sounding.last()) > 0.4f);
+
+    // Курсор стоит: после scrubHoldMs и затухания последних зёрен - тишина
+    QTest::qWait(PlaybackEngine::scrubHoldMs * 3);
+    drainTap(engine);
+    QTest::qWait(50);
+
+    const QVector<float> held = drainTap(engine);
+    QVERIFY(!held.isEmpty());
+    for (const float value : held)
+        QCOMPARE(value, 0.0f);
+
+    // Сдвинули курсор - снова звучит
+    holdCursor(engine, frames / 4, 60);
+    const QVector<float> moved = drainTap(engine);
+    QVERIFY(!moved.isEmpty());
+    QVERIFY(std::abs(moved.last() - valueAt(frames / 4, frames)) < 0.02);
+    engine.endScrub();
+}
+
+void TestPlaybackEngine::endScrubKeepsStopped()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.beginScrub();
+    holdCursor(engine, frames / 3, 30);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Stopped);
+    engine.endScrub();
+
+    QCOMPARE(engine.state(), PlaybackEngine::State::Stopped);
+    QCOMPARE(engine.position(), frames / 3);
+}
+
+void TestPlaybackEngine::endScrubKeepsPaused()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(50);
+    engine.pause();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Paused);
+
+    engine.beginScrub();
+    holdCursor(engine, frames / 3, 30);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Paused);
+    engine.endScrub();
+
+    QCOMPARE(engine.state(), PlaybackEngine::State::Paused);
+    QCOMPARE(engine.position(), frames / 3);
+    QTest::qWait(50);
+    QCOMPARE(engine.position(), frames / 3);
+}
+
+void TestPlaybackEngine::endScrubResumesPlaying()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(50);
+    engine.beginScrub();
+    holdCursor(engine, frames / 2, 30);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Playing);
+    engine.endScrub();
+    QCOMPARE(engine.state(), PlaybackEngine::State::Playing);
+
+    // Продолжается с последней позиции курсора
+    drainTap(engine);
+    QTest::qWait(100);
+    const QVector<float> out = drainTap(engine);
+    QVERIFY(!out.isEmpty());
+    QVERIFY(std::abs(out.first() - valueAt(frames / 2, frames)) < 1e-4);
+    QVERIFY(engine.position() > frames / 2);
+}
+
+void TestPlaybackEngine::seekWhilePlayingFlushesSink()
+{
+    PlaybackEngine engine;
+    const qint64 frames = 4 * sampleRate;
+    setupEngine(engine, frames);
+
+    engine.play();
+    QTest::qWait(100);
+    QVERIFY(engine.position() > 0);
+
+    const qint64 target = frames * 3 / 4;
+    engine.seek(target);
+    QCOMPARE(engine.state(), PlaybackEngine::State::Playing);
+    QCOMPARE(engine.position(), target);
+
+    // Отданное до перемотки отброшено; дальше - только сэмплы от target
+    drainTap(engine);
+    QTest::qWait(100);
+    const QVector<float> out = drainTap(engine);
+    QVERIFY(!out.isEmpty());
+    QVERIFY(std::abs(out.first() - valueAt(target, frames)) < 1e-4);
+    for (const float value : out)
+        QVERIFY(value >= valueAt(target, frames) - 1e-6);
+    QVERIFY(engine.position() > target);
+    QVERIFY(engine.position() < target + sampleRate / 2);
+}
+
+QTEST_GUILESS_MAIN(TestPlaybackEngine)
+#include "tst_playbackengine.moc"